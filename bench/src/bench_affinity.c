@@ -0,0 +1,131 @@
+#include <haunt.h>
+#include "platform/platform.h"
+#include "platform/platform_cpu.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Measures frame time variance of a job heavy frame, to compare pinned and unpinned threads. Each frame does some
+ * serial work on the main thread and then a parallel_for sized to keep every worker busy. Runs headless.
+ *
+ * Usage: HAUNT_PIN_THREADS=0|1 haunt-bench-affinity [--frames N]
+ */
+
+#define BENCH_DEFAULT_FRAMES 2000
+#define BENCH_SERIAL_ITEMS 20000
+#define BENCH_PARALLEL_ITEMS 400000
+#define BENCH_ITEM_WORK 32
+
+typedef struct Bench_Affinity {
+	u32 frame;
+	u32 frame_count;
+	u64* frame_times;
+	f32* values;
+} Bench_Affinity;
+
+App_Config app_config(void) {
+	App_Config config;
+	config.name = "Haunt Affinity Benchmark";
+	config.window.x = 0;
+	config.window.y = 0;
+	config.window.width = 0;
+	config.window.height = 0;
+	config.target_frame_rate = 0.0f;
+	config.headless = true;
+	config.offscreen = false;
+	return config;
+}
+
+static void work_range(u32 begin, u32 end, void* data) {
+	f32* values = (f32*)data;
+	for (u32 i = begin; i < end; i++) {
+		f32 value = (f32)i;
+		for (u32 j = 0; j < BENCH_ITEM_WORK; j++) {
+			value = value * 0.999f + 1.0f;
+		}
+		values[i] = value;
+	}
+}
+
+static int compare_u64(const void* a, const void* b) {
+	u64 x = *(const u64*)a;
+	u64 y = *(const u64*)b;
+	return x < y ? -1 : x > y;
+}
+
+static void report(Bench_Affinity* bench) {
+	u32 count = bench->frame_count;
+	f64 mean = 0.0;
+	for (u32 i = 0; i < count; i++) {
+		mean += (f64)bench->frame_times[i];
+	}
+	mean /= (f64)count;
+	f64 variance = 0.0;
+	for (u32 i = 0; i < count; i++) {
+		f64 delta = (f64)bench->frame_times[i] - mean;
+		variance += delta * delta;
+	}
+	variance /= (f64)count;
+
+	qsort(bench->frame_times, count, sizeof(u64), compare_u64);
+	const char* pin_threads = getenv("HAUNT_PIN_THREADS");
+	b8 pinned = pin_threads ? strcmp(pin_threads, "0") != 0 : PLATFORM_THREAD_AFFINITY_ENABLED;
+	log_info("%u frames on %u workers, %s", count, job_get_worker_count(), pinned ? "pinned" : "unpinned");
+	log_info("%12s %10.3f ms", "mean", mean / 1000000.0);
+	log_info("%12s %10.3f ms", "stddev", sqrt(variance) / 1000000.0);
+	log_info("%12s %10.3f ms", "p50", (f64)bench->frame_times[count / 2] / 1000000.0);
+	log_info("%12s %10.3f ms", "p99", (f64)bench->frame_times[count * 99 / 100] / 1000000.0);
+	log_info("%12s %10.3f ms", "max", (f64)bench->frame_times[count - 1] / 1000000.0);
+}
+
+App_Result app_start(void** state, int argc, char** argv) {
+	*state = memory_alloc(sizeof(Bench_Affinity), MEMORY_TAG_APP);
+	Bench_Affinity* bench = (Bench_Affinity*)*state;
+	memory_zero(bench, sizeof(Bench_Affinity));
+	bench->frame_count = BENCH_DEFAULT_FRAMES;
+
+	for (int i = 1; i + 1 < argc; i++) {
+		if (strcmp(argv[i], "--frames") == 0) {
+			bench->frame_count = (u32)atoi(argv[++i]);
+		}
+	}
+	if (bench->frame_count == 0) {
+		bench->frame_count = 1;
+	}
+
+	bench->frame_times = memory_alloc(sizeof(u64) * bench->frame_count, MEMORY_TAG_APP);
+	bench->values = memory_alloc(sizeof(f32) * BENCH_PARALLEL_ITEMS, MEMORY_TAG_APP);
+	return APP_RESULT_CONTINUE;
+}
+
+App_Result app_update(void* state) {
+	Bench_Affinity* bench = (Bench_Affinity*)state;
+	if (bench->frame == bench->frame_count) {
+		report(bench);
+		return APP_RESULT_SUCCESS;
+	}
+
+	u64 start = platform_get_time_ns();
+	work_range(0, BENCH_SERIAL_ITEMS, bench->values);
+	job_parallel_for(BENCH_PARALLEL_ITEMS, 0, work_range, bench->values);
+	bench->frame_times[bench->frame++] = platform_get_time_ns() - start;
+	return APP_RESULT_CONTINUE;
+}
+
+App_Result app_render(void* state) {
+	return APP_RESULT_CONTINUE;
+}
+
+App_Result app_on_resize(void* state) {
+	return APP_RESULT_CONTINUE;
+}
+
+App_Result app_shutdown(void* state) {
+	Bench_Affinity* bench = (Bench_Affinity*)state;
+	memory_free(bench->frame_times, sizeof(u64) * bench->frame_count, MEMORY_TAG_APP);
+	memory_free(bench->values, sizeof(f32) * BENCH_PARALLEL_ITEMS, MEMORY_TAG_APP);
+	memory_free(bench, sizeof(Bench_Affinity), MEMORY_TAG_APP);
+	return APP_RESULT_SUCCESS;
+}
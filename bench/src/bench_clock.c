@@ -0,0 +1,56 @@
+#include "core/log.h"
+#include "platform/platform.h"
+
+/**
+ * Measures the cost of reading each clock, and checks the calibrated cycle counter against the monotonic clock.
+ */
+
+#define BENCH_CLOCK_READS 10000000
+#define BENCH_DRIFT_NS 100000000ull
+
+static volatile u64 sink;
+
+static f64 bench_time_ns(void) {
+	u64 start = platform_get_time_ns();
+	for (u32 i = 0; i < BENCH_CLOCK_READS; i++) {
+		sink += platform_get_time_ns();
+	}
+	return (f64)(platform_get_time_ns() - start) / (f64)BENCH_CLOCK_READS;
+}
+
+static f64 bench_cycles(void) {
+	u64 start = platform_get_time_ns();
+	for (u32 i = 0; i < BENCH_CLOCK_READS; i++) {
+		sink += platform_get_cycles();
+	}
+	return (f64)(platform_get_time_ns() - start) / (f64)BENCH_CLOCK_READS;
+}
+
+// Returns how far the cycle counter drifts from the monotonic clock over BENCH_DRIFT_NS, in parts per million
+static f64 bench_drift(void) {
+	u64 start_ns = platform_get_time_ns();
+	u64 start_cycles = platform_get_cycles();
+	u64 end_ns;
+	do {
+		end_ns = platform_get_time_ns();
+	} while (end_ns - start_ns < BENCH_DRIFT_NS);
+	u64 end_cycles = platform_get_cycles();
+
+	f64 clock = (f64)(end_ns - start_ns);
+	f64 cycles = (f64)platform_cycles_to_ns(end_cycles - start_cycles);
+	return (cycles - clock) / clock * 1e6;
+}
+
+int main(int argc, char** argv) {
+	u64 frequency = platform_get_cycle_frequency();
+	log_info("Clock benchmark");
+	log_info("Cycle counter frequency: %.3f MHz", (f64)frequency / 1e6);
+
+	f64 time_ns = bench_time_ns();
+	f64 cycles = bench_cycles();
+	log_info("%24s %10.2f ns/read", "platform_get_time_ns", time_ns);
+	log_info("%24s %10.2f ns/read", "platform_get_cycles", cycles);
+	log_info("%24s %10.2f ppm", "cycle counter drift", bench_drift());
+
+	return 0;
+}
@@ -0,0 +1,100 @@
+#include "core/event.h"
+#include "core/log.h"
+#include "platform/platform.h"
+
+/**
+ * Measures event_register, event_fire and event_unregister throughput for a range of listener counts.
+ */
+
+#define BENCH_EVENT_CODE (EVENT_TYPE_CUSTOM + 1)
+// An event code holds at most 512 listeners
+#define BENCH_LISTENER_MAX 500
+#define BENCH_FIRE_CALLS 1000000
+#define BENCH_REPEATS 100
+
+static const u32 listener_counts[] = { 1, 10, 100, 500 };
+
+static Event_Handle handles[BENCH_LISTENER_MAX];
+
+static volatile u64 sink;
+
+static b8 on_bench_event(Event_Code code, Event_Context* context, void* sender, void* listener) {
+	sink += (u64)context->vals[0];
+	return false;
+}
+
+// Returns nanoseconds per call
+static f64 bench_register(u32 listener_count) {
+	u64 elapsed = 0;
+	for (u32 repeat = 0; repeat < BENCH_REPEATS; repeat++) {
+		u64 start = platform_get_time_ns();
+		for (u32 i = 0; i < listener_count; i++) {
+			handles[i] = event_register(BENCH_EVENT_CODE, (void*)(u64)i, on_bench_event);
+		}
+		elapsed += platform_get_time_ns() - start;
+
+		for (u32 i = 0; i < listener_count; i++) {
+			event_unregister(handles[i]);
+		}
+	}
+	return (f64)elapsed / (f64)(listener_count * BENCH_REPEATS);
+}
+
+static f64 bench_unregister(u32 listener_count, b8 reverse) {
+	u64 elapsed = 0;
+	for (u32 repeat = 0; repeat < BENCH_REPEATS; repeat++) {
+		for (u32 i = 0; i < listener_count; i++) {
+			handles[i] = event_register(BENCH_EVENT_CODE, (void*)(u64)i, on_bench_event);
+		}
+
+		u64 start = platform_get_time_ns();
+		for (u32 i = 0; i < listener_count; i++) {
+			event_unregister(handles[reverse ? listener_count - 1 - i : i]);
+		}
+		elapsed += platform_get_time_ns() - start;
+	}
+	return (f64)elapsed / (f64)(listener_count * BENCH_REPEATS);
+}
+
+static f64 bench_fire(u32 listener_count) {
+	for (u32 i = 0; i < listener_count; i++) {
+		handles[i] = event_register(BENCH_EVENT_CODE, (void*)(u64)i, on_bench_event);
+	}
+
+	// Keep the total number of handler calls roughly constant across listener counts
+	u32 fire_calls = BENCH_FIRE_CALLS / listener_count;
+	Event_Context context = { 1 };
+	u64 start = platform_get_time_ns();
+	for (u32 i = 0; i < fire_calls; i++) {
+		event_fire(BENCH_EVENT_CODE, context, null);
+	}
+	u64 elapsed = platform_get_time_ns() - start;
+
+	for (u32 i = 0; i < listener_count; i++) {
+		event_unregister(handles[i]);
+	}
+	return (f64)elapsed / (f64)fire_calls;
+}
+
+int main(int argc, char** argv) {
+	log_info("Event system benchmark");
+	log_info("%10s %14s %14s %14s %16s %16s", "listeners", "fire ns", "ns/listener", "register ns", "unregister ns", "unreg rev ns");
+
+	for (u32 i = 0; i < sizeof(listener_counts) / sizeof(listener_counts[0]); i++) {
+		u32 listener_count = listener_counts[i];
+		f64 fire = bench_fire(listener_count);
+		f64 reg = bench_register(listener_count);
+		f64 unreg = bench_unregister(listener_count, false);
+		f64 unreg_reverse = bench_unregister(listener_count, true);
+		log_info(
+			"%10u %14.2f %14.2f %14.2f %16.2f %16.2f",
+			listener_count,
+			fire,
+			fire / (f64)listener_count,
+			reg,
+			unreg,
+			unreg_reverse);
+	}
+
+	return 0;
+}
@@ -0,0 +1,87 @@
+#include "bench_files.h"
+#include "platform/platform_file.h"
+
+/**
+ * Compares loading an asset set with fopen and fread against mapping it, with a cold and a warm page cache. Every
+ * load sums the file contents so both paths touch every byte, like a loader parsing them would.
+ *
+ * Usage: haunt-bench-file [--dir path] [--size MiB] [--files N]
+ */
+
+#define BENCH_DEFAULT_SIZE_MIB 1024
+#define BENCH_DEFAULT_FILES 256
+
+static Bench_Files bench;
+
+static u64 load_read(void* data) {
+	u64 sum = 0;
+	for (u32 i = 0; i < bench.file_count; i++) {
+		FILE* file = fopen(bench_files_path(&bench, i), "rb");
+		if (!file) {
+			continue;
+		}
+		fseek(file, 0, SEEK_END);
+		u64 size = (u64)ftell(file);
+		fseek(file, 0, SEEK_SET);
+		u8* buffer = memory_alloc(size, MEMORY_TAG_APP);
+		if (fread(buffer, 1, size, file) == size) {
+			sum += bench_checksum(buffer, size);
+		}
+		fclose(file);
+		memory_free(buffer, size, MEMORY_TAG_APP);
+	}
+	return sum;
+}
+
+static u64 load_map(void* data) {
+	u64 sum = 0;
+	for (u32 i = 0; i < bench.file_count; i++) {
+		File_Map map;
+		if (!platform_file_map(bench_files_path(&bench, i), FILE_MAP_READ_ONLY, &map)) {
+			continue;
+		}
+		platform_file_advise(&map, 0, map.size, FILE_MAP_ADVICE_SEQUENTIAL);
+		sum += bench_checksum(map.data, map.size);
+		platform_file_unmap(&map);
+	}
+	return sum;
+}
+
+int main(int argc, char** argv) {
+	const char* dir = bench_scratch_dir();
+	u64 size_mib = BENCH_DEFAULT_SIZE_MIB;
+	u32 file_count = BENCH_DEFAULT_FILES;
+	for (int i = 1; i + 1 < argc; i++) {
+		if (strcmp(argv[i], "--dir") == 0) {
+			dir = argv[++i];
+		} else if (strcmp(argv[i], "--size") == 0) {
+			size_mib = (u64)atoll(argv[++i]);
+		} else if (strcmp(argv[i], "--files") == 0) {
+			file_count = (u32)atoi(argv[++i]);
+		}
+	}
+	if (file_count == 0 || size_mib == 0) {
+		log_error("Need at least one file and one MiB");
+		return 1;
+	}
+	bench_files_init(&bench, dir, "haunt-bench-asset", file_count, mib(size_mib) / file_count);
+
+	log_info("Creating %u files of %llu KiB in %s", bench.file_count, bench.file_size / 1024, dir);
+	if (!bench_files_create(&bench)) {
+		bench_files_delete(&bench);
+		bench_files_free(&bench);
+		return 1;
+	}
+
+	// Warms the cache and gives the checksum both paths have to match
+	u64 expected = load_read(0);
+
+	bench_files_measure(&bench, "fread cold", true, load_read, 0, expected);
+	bench_files_measure(&bench, "map cold", true, load_map, 0, expected);
+	bench_files_measure(&bench, "fread warm", false, load_read, 0, expected);
+	bench_files_measure(&bench, "map warm", false, load_map, 0, expected);
+
+	bench_files_delete(&bench);
+	bench_files_free(&bench);
+	return 0;
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "core/context.h"
+#include "core/log.h"
+#include "core/memory.h"
+#include "platform/platform.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if PLATFORM_LINUX
+#	include <fcntl.h>
+#	include <unistd.h>
+#endif
+
+/**
+ * File fixtures shared by the benchmarks that load from disk. A fixture is a set of files of random data in a scratch
+ * directory, created before measuring and deleted after.
+ *
+ * Cold loads drop the files from the page cache with posix_fadvise first, which only works on Linux. Elsewhere the
+ * cache can't be dropped and cold measurements are skipped.
+ */
+
+#define BENCH_PATH_MAX 512
+
+typedef struct Bench_Files {
+	u32 file_count;
+	u64 file_size;
+	// file_count paths of BENCH_PATH_MAX bytes each
+	char* paths;
+} Bench_Files;
+
+// Loads every file and returns the checksum of their contents, touching every byte like a loader parsing them would
+typedef u64 (*Bench_Load)(void* data);
+
+// TMPDIR, then TEMP, then /tmp
+static const char* bench_scratch_dir(void) {
+	if (getenv("TMPDIR")) {
+		return getenv("TMPDIR");
+	}
+	return getenv("TEMP") ? getenv("TEMP") : "/tmp";
+}
+
+static b8 bench_write_file(const char* path, const void* data, u64 size) {
+	FILE* file = fopen(path, "wb");
+	if (!file) {
+		log_error("Failed to create %s", path);
+		return false;
+	}
+	b8 written = fwrite(data, 1, size, file) == size;
+	fclose(file);
+	if (!written) {
+		log_error("Failed to write %s", path);
+	}
+	return written;
+}
+
+static u64 bench_checksum(const u8* data, u64 size) {
+	u64 sum = 0;
+	u64 words = size / sizeof(u64);
+	for (u64 i = 0; i < words; i++) {
+		u64 word;
+		memcpy(&word, data + i * sizeof(u64), sizeof(u64));
+		sum += word;
+	}
+	for (u64 i = words * sizeof(u64); i < size; i++) {
+		sum += data[i];
+	}
+	return sum;
+}
+
+static const char* bench_files_path(const Bench_Files* files, u32 index) {
+	return files->paths + (u64)index * BENCH_PATH_MAX;
+}
+
+// Names the files <dir>/<prefix>-<index>.bin without creating them yet
+static void bench_files_init(Bench_Files* files, const char* dir, const char* prefix, u32 file_count, u64 file_size) {
+	files->file_count = file_count;
+	files->file_size = file_size;
+	files->paths = memory_alloc((u64)file_count * BENCH_PATH_MAX, MEMORY_TAG_APP);
+	for (u32 i = 0; i < file_count; i++) {
+		snprintf(files->paths + (u64)i * BENCH_PATH_MAX, BENCH_PATH_MAX, "%s/%s-%05u.bin", dir, prefix, i);
+	}
+}
+
+static void bench_files_free(Bench_Files* files) {
+	memory_free(files->paths, (u64)files->file_count * BENCH_PATH_MAX, MEMORY_TAG_APP);
+	files->paths = 0;
+}
+
+// Writes xorshift noise a chunk at a time, so large files don't need a buffer their own size
+static b8 bench_files_create(const Bench_Files* files) {
+	u64 chunk_size = files->file_size < mib(1) ? files->file_size : mib(1);
+	u64 words = (chunk_size + sizeof(u64) - 1) / sizeof(u64);
+	u64* chunk = memory_alloc(words * sizeof(u64), MEMORY_TAG_APP);
+	u64 seed = 0x9E3779B97F4A7C15ull;
+
+	b8 success = true;
+	for (u32 i = 0; i < files->file_count && success; i++) {
+		FILE* file = fopen(bench_files_path(files, i), "wb");
+		if (!file) {
+			log_error("Failed to create %s", bench_files_path(files, i));
+			success = false;
+			break;
+		}
+		for (u64 written = 0; written < files->file_size; written += chunk_size) {
+			for (u64 j = 0; j < words; j++) {
+				seed ^= seed << 13;
+				seed ^= seed >> 7;
+				seed ^= seed << 17;
+				chunk[j] = seed;
+			}
+			u64 size = files->file_size - written < chunk_size ? files->file_size - written : chunk_size;
+			if (fwrite(chunk, 1, size, file) != size) {
+				log_error("Failed to write %s", bench_files_path(files, i));
+				success = false;
+				break;
+			}
+		}
+		fclose(file);
+	}
+
+	memory_free(chunk, words * sizeof(u64), MEMORY_TAG_APP);
+	return success;
+}
+
+static void bench_files_delete(const Bench_Files* files) {
+	for (u32 i = 0; i < files->file_count; i++) {
+		remove(bench_files_path(files, i));
+	}
+}
+
+// Drops the files from the page cache so the next load has to go to the disk
+static b8 bench_files_drop_cache(const Bench_Files* files) {
+#if PLATFORM_LINUX
+	for (u32 i = 0; i < files->file_count; i++) {
+		int fd = open(bench_files_path(files, i), O_RDONLY);
+		if (fd < 0) {
+			return false;
+		}
+		fdatasync(fd);
+		posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+		close(fd);
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+// Times one load of every file and logs the throughput, flagging a sum that doesn't match the expected one
+static void bench_files_measure(
+	const Bench_Files* files, const char* name, b8 cold, Bench_Load load, void* data, u64 expected) {
+	if (cold && !bench_files_drop_cache(files)) {
+		log_info("%24s %10s", name, "skipped");
+		return;
+	}
+
+	u64 start = platform_get_time_ns();
+	u64 sum = load(data);
+	f64 seconds = (f64)(platform_get_time_ns() - start) / 1000000000.0;
+	f64 total_mib = (f64)(files->file_size * files->file_count) / (f64)mib(1);
+	log_info("%24s %10.3f s %10.1f MiB/s %10.0f files/s%s", name, seconds, total_mib / seconds,
+		(f64)files->file_count / seconds, sum == expected ? "" : " (checksum mismatch)");
+}
@@ -0,0 +1,145 @@
+#include <haunt.h>
+#include "bench_files.h"
+
+/**
+ * Compares loading many small files one after another with fopen and fread against queueing them all at once through
+ * platform_io_read and waiting on a counter, with a cold and a warm page cache. Both paths sum the file contents so a
+ * short or failed read shows up as a checksum mismatch. Runs headless.
+ *
+ * Usage: HAUNT_IO_URING=0|1 haunt-bench-io [--dir path] [--files N] [--size KiB]
+ */
+
+#define BENCH_DEFAULT_FILES 4096
+#define BENCH_DEFAULT_SIZE_KIB 16
+
+typedef struct Bench_Io {
+	Bench_Files files;
+	u8* buffers;
+	Io_Request* requests;
+	u64 expected;
+} Bench_Io;
+
+App_Config app_config(void) {
+	App_Config config;
+	config.name = "Haunt I/O Benchmark";
+	config.window.x = 0;
+	config.window.y = 0;
+	config.window.width = 0;
+	config.window.height = 0;
+	config.target_frame_rate = 0.0f;
+	config.headless = true;
+	config.offscreen = false;
+	return config;
+}
+
+static u64 load_sequential(void* data) {
+	Bench_Io* bench = (Bench_Io*)data;
+	u64 sum = 0;
+	for (u32 i = 0; i < bench->files.file_count; i++) {
+		FILE* file = fopen(bench_files_path(&bench->files, i), "rb");
+		if (!file) {
+			continue;
+		}
+		u8* buffer = bench->buffers + (u64)i * bench->files.file_size;
+		if (fread(buffer, 1, bench->files.file_size, file) == bench->files.file_size) {
+			sum += bench_checksum(buffer, bench->files.file_size);
+		}
+		fclose(file);
+	}
+	return sum;
+}
+
+static u64 load_async(void* data) {
+	Bench_Io* bench = (Bench_Io*)data;
+	Job_Counter counter = {0};
+	for (u32 i = 0; i < bench->files.file_count; i++) {
+		Io_Request* request = &bench->requests[i];
+		memory_zero(request, sizeof(Io_Request));
+		request->path = bench_files_path(&bench->files, i);
+		request->buffer = bench->buffers + (u64)i * bench->files.file_size;
+		request->size = bench->files.file_size;
+		request->counter = &counter;
+	}
+	platform_io_read(bench->requests, bench->files.file_count);
+	job_wait(&counter);
+
+	u64 sum = 0;
+	for (u32 i = 0; i < bench->files.file_count; i++) {
+		if (bench->requests[i].result == (i64)bench->files.file_size) {
+			sum += bench_checksum(bench->requests[i].buffer, bench->files.file_size);
+		}
+	}
+	return sum;
+}
+
+// Clears the buffers first so a read that never lands can't pass off the previous one's data
+static void measure(Bench_Io* bench, const char* name, Bench_Load load, b8 cold) {
+	memory_zero(bench->buffers, bench->files.file_size * bench->files.file_count);
+	bench_files_measure(&bench->files, name, cold, load, bench, bench->expected);
+}
+
+App_Result app_start(void** state, int argc, char** argv) {
+	*state = memory_alloc(sizeof(Bench_Io), MEMORY_TAG_APP);
+	Bench_Io* bench = (Bench_Io*)*state;
+	memory_zero(bench, sizeof(Bench_Io));
+
+	const char* dir = bench_scratch_dir();
+	u32 file_count = BENCH_DEFAULT_FILES;
+	u64 size_kib = BENCH_DEFAULT_SIZE_KIB;
+	for (int i = 1; i + 1 < argc; i++) {
+		if (strcmp(argv[i], "--dir") == 0) {
+			dir = argv[++i];
+		} else if (strcmp(argv[i], "--files") == 0) {
+			file_count = (u32)atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--size") == 0) {
+			size_kib = (u64)atoll(argv[++i]);
+		}
+	}
+	if (file_count == 0 || size_kib == 0) {
+		log_error("Need at least one file of at least one KiB");
+		return APP_RESULT_FAILURE;
+	}
+	bench_files_init(&bench->files, dir, "haunt-bench-io", file_count, size_kib * 1024);
+	bench->buffers = memory_alloc(bench->files.file_size * file_count, MEMORY_TAG_APP);
+	bench->requests = memory_alloc(sizeof(Io_Request) * file_count, MEMORY_TAG_APP);
+
+	log_info("Creating %u files of %llu KiB in %s", file_count, size_kib, dir);
+	if (!bench_files_create(&bench->files)) {
+		bench_files_delete(&bench->files);
+		return APP_RESULT_FAILURE;
+	}
+	return APP_RESULT_CONTINUE;
+}
+
+App_Result app_update(void* state) {
+	Bench_Io* bench = (Bench_Io*)state;
+	Io_Backend backend = platform_io_get_backend();
+	log_info("Reading through %s", backend == IO_BACKEND_URING ? "io_uring" : backend == IO_BACKEND_THREADS ? "threads" : "nothing");
+
+	// Warms the cache and gives the checksum both paths have to match
+	bench->expected = load_sequential(bench);
+
+	measure(bench, "sequential cold", load_sequential, true);
+	measure(bench, "async cold", load_async, true);
+	measure(bench, "sequential warm", load_sequential, false);
+	measure(bench, "async warm", load_async, false);
+	return APP_RESULT_SUCCESS;
+}
+
+App_Result app_render(void* state) {
+	return APP_RESULT_CONTINUE;
+}
+
+App_Result app_on_resize(void* state) {
+	return APP_RESULT_CONTINUE;
+}
+
+App_Result app_shutdown(void* state) {
+	Bench_Io* bench = (Bench_Io*)state;
+	bench_files_delete(&bench->files);
+	memory_free(bench->buffers, bench->files.file_size * bench->files.file_count, MEMORY_TAG_APP);
+	memory_free(bench->requests, sizeof(Io_Request) * bench->files.file_count, MEMORY_TAG_APP);
+	bench_files_free(&bench->files);
+	memory_free(bench, sizeof(Bench_Io), MEMORY_TAG_APP);
+	return APP_RESULT_SUCCESS;
+}
@@ -0,0 +1,245 @@
+#include <haunt.h>
+#include "platform/platform.h"
+
+/**
+ * Measures job system overhead, fiber switches, waits and parallel_for scaling. Runs headless, set HAUNT_WORKERS to
+ * compare worker counts. Exits with a failure if any job is lost or run twice.
+ */
+
+#define BENCH_EMPTY_JOBS 1000
+#define BENCH_EMPTY_ROUNDS 1000
+#define BENCH_ITEMS (1u << 22)
+#define BENCH_ITEM_WORK 64
+#define BENCH_REPEATS 10
+#define BENCH_SWITCHES 1000000
+#define BENCH_WAITS 100000
+// Deeper than the fiber pool once the chains are added up, so the fallback for running out of fibers is covered too
+#define BENCH_CHAINS 8
+#define BENCH_CHAIN_DEPTH 100
+
+typedef struct Bench_Job {
+	u32* counts;
+	f32* values;
+	u32 chain_finished;
+	Fiber thread_fiber;
+	Fiber fiber;
+} Bench_Job;
+
+static Bench_Job bench;
+
+App_Config app_config(void) {
+	App_Config config;
+	config.name = "Haunt Job Benchmark";
+	config.window.x = 0;
+	config.window.y = 0;
+	config.window.width = 0;
+	config.window.height = 0;
+	config.target_frame_rate = 0.0f;
+	config.headless = true;
+	config.offscreen = false;
+	return config;
+}
+
+static void empty_job(void* data) {
+}
+
+static void count_range(u32 begin, u32 end, void* data) {
+	for (u32 i = begin; i < end; i++) {
+		bench.counts[i]++;
+	}
+}
+
+static void work_range(u32 begin, u32 end, void* data) {
+	for (u32 i = begin; i < end; i++) {
+		f32 value = (f32)i;
+		for (u32 j = 0; j < BENCH_ITEM_WORK; j++) {
+			value = value * 0.999f + 1.0f;
+		}
+		bench.values[i] = value;
+	}
+}
+
+// Nested jobs: each submits and waits on its own children
+static void spawn_children(void* data) {
+	Job_Desc children[8];
+	for (u32 i = 0; i < 8; i++) {
+		children[i] = (Job_Desc){ empty_job, null };
+	}
+	Job_Counter counter = {0};
+	job_run(children, 8, &counter);
+	job_wait(&counter);
+	atomic_fetch_add_u32((u32*)data, 1, MEMORY_ORDER_RELAXED);
+}
+
+// Stands in for a load waiting on a decode waiting on a read and so on, each level waiting on the next
+static void chain_job(void* data) {
+	u32 depth = (u32)(u64)data;
+	if (depth > 0) {
+		Job_Desc child = { chain_job, (void*)(u64)(depth - 1) };
+		Job_Counter counter = {0};
+		job_run(&child, 1, &counter);
+		job_wait(&counter);
+	}
+	atomic_fetch_add_u32(&bench.chain_finished, 1, MEMORY_ORDER_RELAXED);
+}
+
+static b8 check(void) {
+	memory_zero(bench.counts, BENCH_ITEMS * sizeof(u32));
+	for (u32 repeat = 0; repeat < BENCH_REPEATS; repeat++) {
+		job_parallel_for(BENCH_ITEMS, 0, count_range, null);
+		job_parallel_for(BENCH_ITEMS, 97, count_range, null);
+	}
+	for (u32 i = 0; i < BENCH_ITEMS; i++) {
+		if (bench.counts[i] != BENCH_REPEATS * 2) {
+			log_error("Item %u ran %u times, expected %u", i, bench.counts[i], BENCH_REPEATS * 2);
+			return false;
+		}
+	}
+
+	u32 finished = 0;
+	Job_Desc parents[64];
+	for (u32 i = 0; i < 64; i++) {
+		parents[i] = (Job_Desc){ spawn_children, &finished };
+	}
+	Job_Counter counter = {0};
+	job_run(parents, 64, &counter);
+	job_wait(&counter);
+	if (finished != 64) {
+		log_error("Nested jobs finished %u times, expected 64", finished);
+		return false;
+	}
+
+	bench.chain_finished = 0;
+	Job_Desc chains[BENCH_CHAINS];
+	for (u32 i = 0; i < BENCH_CHAINS; i++) {
+		chains[i] = (Job_Desc){ chain_job, (void*)(u64)BENCH_CHAIN_DEPTH };
+	}
+	counter = (Job_Counter){0};
+	job_run(chains, BENCH_CHAINS, &counter);
+	job_wait(&counter);
+	if (bench.chain_finished != BENCH_CHAINS * (BENCH_CHAIN_DEPTH + 1)) {
+		log_error("Chained jobs finished %u times, expected %u", bench.chain_finished, BENCH_CHAINS * (BENCH_CHAIN_DEPTH + 1));
+		return false;
+	}
+	return true;
+}
+
+// Nanoseconds to submit and finish one empty job
+static f64 bench_empty_jobs(void) {
+	Job_Desc jobs[BENCH_EMPTY_JOBS];
+	for (u32 i = 0; i < BENCH_EMPTY_JOBS; i++) {
+		jobs[i] = (Job_Desc){ empty_job, null };
+	}
+
+	u64 start = platform_get_time_ns();
+	for (u32 round = 0; round < BENCH_EMPTY_ROUNDS; round++) {
+		Job_Counter counter = {0};
+		job_run(jobs, BENCH_EMPTY_JOBS, &counter);
+		job_wait(&counter);
+	}
+	return (f64)(platform_get_time_ns() - start) / (f64)(BENCH_EMPTY_JOBS * BENCH_EMPTY_ROUNDS);
+}
+
+static void switch_back(void* data) {
+	for (;;) {
+		fiber_switch(&bench.fiber, &bench.thread_fiber);
+	}
+}
+
+// Runs on its own thread so the conversion doesn't disturb the job system's fiber on the main thread
+static i32 switch_fibers(void* data) {
+	fiber_convert_thread(&bench.thread_fiber);
+	fiber_create(&bench.fiber, 0, switch_back, null);
+
+	u64 start = platform_get_time_ns();
+	for (u32 i = 0; i < BENCH_SWITCHES; i++) {
+		fiber_switch(&bench.thread_fiber, &bench.fiber);
+	}
+	*(f64*)data = (f64)(platform_get_time_ns() - start) / (f64)(BENCH_SWITCHES * 2);
+
+	fiber_destroy(&bench.fiber);
+	fiber_convert_back(&bench.thread_fiber);
+	return 0;
+}
+
+// Nanoseconds for one switch between two fibers
+static f64 bench_fiber_switch(void) {
+	f64 result = 0.0;
+	Thread thread;
+	thread_create(&thread, "haunt-fiber", 0, switch_fibers, &result);
+	thread_join(&thread);
+	return result;
+}
+
+static void wait_on_child(void* data) {
+	for (u32 i = 0; i < BENCH_WAITS; i++) {
+		Job_Desc child = { empty_job, null };
+		Job_Counter counter = {0};
+		job_run(&child, 1, &counter);
+		job_wait(&counter);
+	}
+}
+
+// Nanoseconds for a job to submit a child, park its fiber on it and be resumed
+static f64 bench_job_wait(void) {
+	Job_Desc parent = { wait_on_child, null };
+	Job_Counter counter = {0};
+	u64 start = platform_get_time_ns();
+	job_run(&parent, 1, &counter);
+	job_wait(&counter);
+	return (f64)(platform_get_time_ns() - start) / (f64)BENCH_WAITS;
+}
+
+// Called through a pointer like the jobs are, so both passes run the same code
+static Job_Range_Function volatile serial_function = work_range;
+
+// Milliseconds per pass over every item
+static f64 bench_work(b8 parallel) {
+	u64 start = platform_get_time_ns();
+	for (u32 repeat = 0; repeat < BENCH_REPEATS; repeat++) {
+		if (parallel) {
+			job_parallel_for(BENCH_ITEMS, 0, work_range, null);
+		} else {
+			serial_function(0, BENCH_ITEMS, null);
+		}
+	}
+	return (f64)(platform_get_time_ns() - start) / (f64)BENCH_REPEATS / 1000000.0;
+}
+
+App_Result app_start(void** state, int argc, char** argv) {
+	bench.counts = memory_alloc(BENCH_ITEMS * sizeof(u32), MEMORY_TAG_APP);
+	bench.values = memory_alloc(BENCH_ITEMS * sizeof(f32), MEMORY_TAG_APP);
+
+	log_info("Job system benchmark with %u workers", job_get_worker_count());
+	b8 passed = check();
+	if (passed) {
+		log_info("Checks passed");
+		log_info("%24s %10.2f ns", "empty job", bench_empty_jobs());
+		log_info("%24s %10.2f ns", "fiber switch", bench_fiber_switch());
+		log_info("%24s %10.2f ns", "job wait and resume", bench_job_wait());
+		f64 serial = bench_work(false);
+		f64 parallel = bench_work(true);
+		log_info("%24s %10.3f ms", "serial pass", serial);
+		log_info("%24s %10.3f ms (%.2fx)", "parallel_for pass", parallel, serial / parallel);
+	}
+
+	memory_free(bench.counts, BENCH_ITEMS * sizeof(u32), MEMORY_TAG_APP);
+	memory_free(bench.values, BENCH_ITEMS * sizeof(f32), MEMORY_TAG_APP);
+	return passed ? APP_RESULT_SUCCESS : APP_RESULT_FAILURE;
+}
+
+App_Result app_update(void* state) {
+	return APP_RESULT_SUCCESS;
+}
+
+App_Result app_render(void* state) {
+	return APP_RESULT_CONTINUE;
+}
+
+App_Result app_on_resize(void* state) {
+	return APP_RESULT_CONTINUE;
+}
+
+App_Result app_shutdown(void* state) {
+	return APP_RESULT_SUCCESS;
+}
@@ -0,0 +1,128 @@
+#include <haunt.h>
+#include "core/context.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if PLATFORM_LINUX
+#	include <X11/Xlib.h>
+#elif PLATFORM_WINDOWS
+#	include <windows.h>
+#endif
+
+/**
+ * Measures input to present latency by moving the pointer across the window every frame, so each frame has real
+ * platform input events to follow through to the GPU.
+ *
+ * Usage: haunt-bench-latency [--frames N] [--wait] [--output latency.csv]
+ */
+
+#define BENCH_WINDOW_X 100
+#define BENCH_WINDOW_Y 100
+#define BENCH_WINDOW_WIDTH 640
+#define BENCH_WINDOW_HEIGHT 480
+#define BENCH_DEFAULT_FRAMES 600
+
+typedef struct Bench_Latency {
+	u32 frame;
+	u32 frame_count;
+#if PLATFORM_LINUX
+	Display* display;
+#endif
+} Bench_Latency;
+
+App_Config app_config(void) {
+	App_Config config;
+	config.name = "Haunt Latency Benchmark";
+	config.window.x = BENCH_WINDOW_X;
+	config.window.y = BENCH_WINDOW_Y;
+	config.window.width = BENCH_WINDOW_WIDTH;
+	config.window.height = BENCH_WINDOW_HEIGHT;
+	config.target_frame_rate = 0.0f;
+	config.headless = false;
+	config.offscreen = false;
+	return config;
+}
+
+// Moves the pointer in a circle over the window, in screen coordinates
+static void move_pointer(Bench_Latency* bench) {
+	f32 angle = (f32)bench->frame * 0.1f;
+	i32 x = BENCH_WINDOW_X + BENCH_WINDOW_WIDTH / 2 + (i32)(cosf(angle) * BENCH_WINDOW_WIDTH / 4);
+	i32 y = BENCH_WINDOW_Y + BENCH_WINDOW_HEIGHT / 2 + (i32)(sinf(angle) * BENCH_WINDOW_HEIGHT / 4);
+
+#if PLATFORM_LINUX
+	XWarpPointer(bench->display, None, DefaultRootWindow(bench->display), 0, 0, 0, 0, x, y);
+	XFlush(bench->display);
+#elif PLATFORM_WINDOWS
+	SetCursorPos(x, y);
+#endif
+}
+
+App_Result app_start(void** state, int argc, char** argv) {
+	*state = memory_alloc(sizeof(Bench_Latency), MEMORY_TAG_APP);
+	Bench_Latency* bench = (Bench_Latency*)*state;
+	bench->frame_count = BENCH_DEFAULT_FRAMES;
+
+	b8 wait_for_gpu = false;
+	const char* output = null;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+			bench->frame_count = (u32)atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--wait") == 0) {
+			wait_for_gpu = true;
+		} else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+			output = argv[++i];
+		}
+	}
+
+#if PLATFORM_LINUX
+	// A separate connection so the warps arrive as ordinary server events on the engine's display
+	bench->display = XOpenDisplay(null);
+	if (!bench->display) {
+		log_error("Failed to open display");
+		return APP_RESULT_FAILURE;
+	}
+#endif
+
+	if (!frame_latency_enable(wait_for_gpu)) {
+		return APP_RESULT_FAILURE;
+	}
+	if (output && !frame_latency_set_output(output)) {
+		return APP_RESULT_FAILURE;
+	}
+
+	log_info("Measuring input latency over %u frames%s", bench->frame_count, wait_for_gpu ? ", waiting for the GPU" : "");
+	return APP_RESULT_CONTINUE;
+}
+
+App_Result app_update(void* state) {
+	Bench_Latency* bench = (Bench_Latency*)state;
+	if (bench->frame++ >= bench->frame_count) {
+		return APP_RESULT_SUCCESS;
+	}
+
+	move_pointer(bench);
+	return APP_RESULT_CONTINUE;
+}
+
+App_Result app_render(void* state) {
+	return APP_RESULT_CONTINUE;
+}
+
+App_Result app_on_resize(void* state) {
+	return APP_RESULT_CONTINUE;
+}
+
+App_Result app_shutdown(void* state) {
+	Bench_Latency* bench = (Bench_Latency*)state;
+
+	frame_latency_report();
+	frame_latency_disable();
+
+#if PLATFORM_LINUX
+	XCloseDisplay(bench->display);
+#endif
+
+	memory_free(bench, sizeof(Bench_Latency), MEMORY_TAG_APP);
+	return APP_RESULT_SUCCESS;
+}
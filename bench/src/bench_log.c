@@ -0,0 +1,155 @@
+#include <haunt.h>
+#include "core/context.h"
+#include "platform/platform.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Measures what a burst of log calls costs the thread that makes them, against formatting and printing each line on
+ * that thread the way logging used to. Each sink is measured on its own: the console, a file and memory. The time to
+ * flush the burst afterwards is what the logger thread spent writing it. Runs headless.
+ *
+ * Redirect stdout to compare without a terminal, since the console numbers are mostly the terminal's.
+ *
+ * Usage: haunt-bench-log [--dir path] [--messages N]
+ */
+
+#define BENCH_DEFAULT_MESSAGES 20000
+#define BENCH_PATH_MAX 512
+// The buffers logging used to format into
+#define BENCH_OLD_BUFFER_SIZE 32768
+
+typedef struct Bench_Log {
+	char path[BENCH_PATH_MAX];
+	u32 message_count;
+} Bench_Log;
+
+App_Config app_config(void) {
+	App_Config config;
+	config.name = "Haunt Log Benchmark";
+	config.window.x = 0;
+	config.window.y = 0;
+	config.window.width = 0;
+	config.window.height = 0;
+	config.target_frame_rate = 0.0f;
+	config.headless = true;
+	config.offscreen = false;
+	return config;
+}
+
+// Formatting and printing on the calling thread, as logging did before it had a logger thread
+static void log_synchronous(const char* message, ...) {
+	char buffer1[BENCH_OLD_BUFFER_SIZE];
+	memset(buffer1, 0, sizeof(buffer1));
+
+	va_list args;
+	va_start(args, message);
+	vsnprintf(buffer1, sizeof(buffer1), message, args);
+	va_end(args);
+
+	char buffer2[BENCH_OLD_BUFFER_SIZE];
+	snprintf(buffer2, sizeof(buffer2), "%s%s\n", "[TRACE] ", buffer1);
+	printf("%s%s\033[0m", "\033[92m", buffer2);
+}
+
+static void report(const char* name, u32 count, u64 call_ns, u64 flush_ns) {
+	log_info("%28s %10.1f ns/call %10.1f ms flush", name, (f64)call_ns / count, (f64)flush_ns / 1000000.0);
+}
+
+static void measure_sink(Bench_Log* bench, const char* name, u32 sinks) {
+	log_flush();
+	u32 previous = log_get_sinks();
+	log_set_sinks(sinks);
+
+	Log_Stats before;
+	log_get_stats(&before);
+
+	u64 start = platform_get_time_ns();
+	for (u32 i = 0; i < bench->message_count; i++) {
+		log_trace("Burst message %u of %u, value %.3f", i, bench->message_count, (f64)i * 0.5);
+	}
+	u64 call_ns = platform_get_time_ns() - start;
+
+	start = platform_get_time_ns();
+	log_flush();
+	u64 flush_ns = platform_get_time_ns() - start;
+
+	Log_Stats after;
+	log_get_stats(&after);
+	log_set_sinks(previous);
+
+	report(name, bench->message_count, call_ns, flush_ns);
+	log_info("%28s %10llu written %10llu dropped", "", after.written_count - before.written_count,
+		after.dropped_count - before.dropped_count);
+}
+
+static void measure_synchronous(Bench_Log* bench) {
+	log_flush();
+
+	u64 start = platform_get_time_ns();
+	for (u32 i = 0; i < bench->message_count; i++) {
+		log_synchronous("Burst message %u of %u, value %.3f", i, bench->message_count, (f64)i * 0.5);
+	}
+	fflush(stdout);
+	report("synchronous console", bench->message_count, platform_get_time_ns() - start, 0);
+}
+
+App_Result app_start(void** state, int argc, char** argv) {
+	*state = memory_alloc(sizeof(Bench_Log), MEMORY_TAG_APP);
+	Bench_Log* bench = (Bench_Log*)*state;
+	memory_zero(bench, sizeof(Bench_Log));
+
+	const char* dir = getenv("TMPDIR") ? getenv("TMPDIR") : getenv("TEMP") ? getenv("TEMP") : "/tmp";
+	bench->message_count = BENCH_DEFAULT_MESSAGES;
+	for (int i = 1; i + 1 < argc; i++) {
+		if (strcmp(argv[i], "--dir") == 0) {
+			dir = argv[++i];
+		} else if (strcmp(argv[i], "--messages") == 0) {
+			bench->message_count = (u32)atoi(argv[++i]);
+		}
+	}
+	if (bench->message_count == 0) {
+		log_error("Need at least one message");
+		return APP_RESULT_FAILURE;
+	}
+	snprintf(bench->path, sizeof(bench->path), "%s/haunt-bench-log.txt", dir);
+	return APP_RESULT_CONTINUE;
+}
+
+App_Result app_update(void* state) {
+	Bench_Log* bench = (Bench_Log*)state;
+
+	measure_synchronous(bench);
+	measure_sink(bench, "console", LOG_SINK_CONSOLE);
+
+	if (!log_open_file(bench->path)) {
+		return APP_RESULT_FAILURE;
+	}
+	measure_sink(bench, "file", LOG_SINK_FILE);
+	log_close_file();
+
+	measure_sink(bench, "memory", LOG_SINK_MEMORY);
+
+	char recent[256];
+	log_read_memory(recent, sizeof(recent));
+	log_info("Memory sink ends with:\n%s", recent);
+	return APP_RESULT_SUCCESS;
+}
+
+App_Result app_render(void* state) {
+	return APP_RESULT_CONTINUE;
+}
+
+App_Result app_on_resize(void* state) {
+	return APP_RESULT_CONTINUE;
+}
+
+App_Result app_shutdown(void* state) {
+	Bench_Log* bench = (Bench_Log*)state;
+	remove(bench->path);
+	memory_free(bench, sizeof(Bench_Log), MEMORY_TAG_APP);
+	return APP_RESULT_SUCCESS;
+}
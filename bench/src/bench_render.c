@@ -0,0 +1,237 @@
+#include <haunt.h>
+#include "graphics/renderer.h"
+#include "graphics/renderer_opengl.h"
+#include "graphics/shader.h"
+#include "platform/platform.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Measures shader compile time and frame time through the offscreen backend, so it runs on machines with no GPU or
+ * display. Each frame draws a grid of overlapping quads, one draw call and uniform update per column, so frame time
+ * covers draw submission, vertex work and blended fill as well as the clear. With Mesa llvmpipe it mostly tracks the
+ * renderer's CPU overhead.
+ *
+ * Usage: haunt-bench-render [--frames N] [--capture frame.ppm]
+ */
+
+#define BENCH_WIDTH 1280
+#define BENCH_HEIGHT 720
+#define BENCH_DEFAULT_FRAMES 1000
+#define BENCH_SHADER_COMPILES 20
+// Quads in the grid drawn every frame. Each quad covers a little more than its cell, so neighbours overlap.
+#define BENCH_GRID_COLUMNS 64
+#define BENCH_GRID_ROWS 36
+
+typedef struct Bench_Render {
+	u32 frame;
+	u32 frame_count;
+	const char* capture_path;
+	Shader shader;
+	GLuint vertex_array;
+	GLuint vertex_buffer;
+	GLint offset_location;
+	GLint color_location;
+} Bench_Render;
+
+App_Config app_config(void) {
+	App_Config config;
+	config.name = "Haunt Render Benchmark";
+	config.window.x = 0;
+	config.window.y = 0;
+	config.window.width = BENCH_WIDTH;
+	config.window.height = BENCH_HEIGHT;
+	config.target_frame_rate = 0.0f;
+	config.headless = false;
+	config.offscreen = true;
+	return config;
+}
+
+// The engine's basic shader, at the GLSL version llvmpipe supports on older Mesa releases
+static const char* vertex_source =
+	"#version 450 core\n"
+	"layout (location = 0) in vec3 a_position;\n"
+	"void main() {\n"
+	"	gl_Position = vec4(a_position, 1.0);\n"
+	"}\n";
+
+static const char* fragment_source =
+	"#version 450 core\n"
+	"out vec4 frag_color;\n"
+	"void main() {\n"
+	"	frag_color = vec4(1.0, 0.0, 0.0, 1.0);\n"
+	"}\n";
+
+// Draws each column of the grid with its own offset and color
+static const char* grid_vertex_source =
+	"#version 450 core\n"
+	"layout (location = 0) in vec2 a_position;\n"
+	"uniform vec2 u_offset;\n"
+	"void main() {\n"
+	"	gl_Position = vec4(a_position + u_offset, 0.0, 1.0);\n"
+	"}\n";
+
+static const char* grid_fragment_source =
+	"#version 450 core\n"
+	"uniform vec4 u_color;\n"
+	"out vec4 frag_color;\n"
+	"void main() {\n"
+	"	frag_color = u_color;\n"
+	"}\n";
+
+static b8 create_grid(Bench_Render* bench) {
+	if (!shader_create(&bench->shader, grid_vertex_source, grid_fragment_source)) {
+		log_error("Failed to compile grid shader");
+		return false;
+	}
+	bench->offset_location = glGetUniformLocation(bench->shader.program_id, "u_offset");
+	bench->color_location = glGetUniformLocation(bench->shader.program_id, "u_color");
+
+	// One column of quads in clip space, two triangles each
+	u64 size = BENCH_GRID_ROWS * 6 * 2 * sizeof(f32);
+	f32* vertices = memory_alloc(size, MEMORY_TAG_APP);
+	f32 width = 2.0f / BENCH_GRID_COLUMNS * 1.5f;
+	f32 height = 2.0f / BENCH_GRID_ROWS * 1.5f;
+	for (u32 row = 0; row < BENCH_GRID_ROWS; row++) {
+		f32 x0 = -1.0f;
+		f32 y0 = -1.0f + 2.0f * row / BENCH_GRID_ROWS;
+		f32 x1 = x0 + width;
+		f32 y1 = y0 + height;
+		f32 quad[12] = { x0, y0, x1, y0, x1, y1, x0, y0, x1, y1, x0, y1 };
+		memory_copy(&vertices[row * 12], quad, sizeof(quad));
+	}
+
+	glGenVertexArrays(1, &bench->vertex_array);
+	glBindVertexArray(bench->vertex_array);
+	glGenBuffers(1, &bench->vertex_buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, bench->vertex_buffer);
+	glBufferData(GL_ARRAY_BUFFER, size, vertices, GL_STATIC_DRAW);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(f32), (void*)0);
+	glEnableVertexAttribArray(0);
+	glBindVertexArray(0);
+
+	memory_free(vertices, size, MEMORY_TAG_APP);
+	return true;
+}
+
+static void destroy_grid(Bench_Render* bench) {
+	glDeleteBuffers(1, &bench->vertex_buffer);
+	glDeleteVertexArrays(1, &bench->vertex_array);
+	shader_destroy(&bench->shader);
+}
+
+static void draw_grid(Bench_Render* bench) {
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	shader_bind(&bench->shader);
+	glBindVertexArray(bench->vertex_array);
+
+	// Columns drift with the frame so no two frames draw the same image
+	f32 drift = (f32)(bench->frame % 120) / 120.0f * (2.0f / BENCH_GRID_COLUMNS);
+	for (u32 column = 0; column < BENCH_GRID_COLUMNS; column++) {
+		f32 t = (f32)column / BENCH_GRID_COLUMNS;
+		glUniform2f(bench->offset_location, 2.0f * t + drift, 0.0f);
+		glUniform4f(bench->color_location, t, 1.0f - t, 0.5f, 0.5f);
+		glDrawArrays(GL_TRIANGLES, 0, BENCH_GRID_ROWS * 6);
+	}
+
+	glBindVertexArray(0);
+	shader_unbind();
+	glDisable(GL_BLEND);
+}
+
+static void bench_shader_compile(void) {
+	u64 elapsed = 0;
+	for (u32 i = 0; i < BENCH_SHADER_COMPILES; i++) {
+		Shader shader;
+		u64 start = platform_get_time_ns();
+		b8 result = shader_create(&shader, vertex_source, fragment_source);
+		elapsed += platform_get_time_ns() - start;
+		if (!result) {
+			log_error("Failed to compile shader");
+			return;
+		}
+		shader_destroy(&shader);
+	}
+	log_info("Shader compile and link: %.3f ms", (f64)elapsed / (f64)BENCH_SHADER_COMPILES / 1000000.0);
+}
+
+// Writes the current frame as a binary PPM, top row first
+static b8 capture_frame(const char* path) {
+	u64 size = BENCH_WIDTH * BENCH_HEIGHT * 4;
+	u8* pixels = memory_alloc(size, MEMORY_TAG_APP);
+	b8 result = renderer_read_pixels(0, 0, BENCH_WIDTH, BENCH_HEIGHT, pixels);
+
+	FILE* file = result ? fopen(path, "wb") : null;
+	if (file) {
+		fprintf(file, "P6\n%d %d\n255\n", BENCH_WIDTH, BENCH_HEIGHT);
+		for (i32 y = BENCH_HEIGHT - 1; y >= 0; y--) {
+			for (i32 x = 0; x < BENCH_WIDTH; x++) {
+				fwrite(&pixels[(y * BENCH_WIDTH + x) * 4], 1, 3, file);
+			}
+		}
+		fclose(file);
+		log_info("Captured frame to %s", path);
+	} else {
+		log_error("Failed to capture frame to %s", path);
+		result = false;
+	}
+
+	memory_free(pixels, size, MEMORY_TAG_APP);
+	return result;
+}
+
+App_Result app_start(void** state, int argc, char** argv) {
+	*state = memory_alloc(sizeof(Bench_Render), MEMORY_TAG_APP);
+	Bench_Render* bench = (Bench_Render*)*state;
+	memory_zero(bench, sizeof(Bench_Render));
+	bench->frame_count = BENCH_DEFAULT_FRAMES;
+
+	for (int i = 1; i + 1 < argc; i++) {
+		if (strcmp(argv[i], "--frames") == 0) {
+			bench->frame_count = (u32)atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--capture") == 0) {
+			bench->capture_path = argv[++i];
+		}
+	}
+
+	bench_shader_compile();
+	if (!create_grid(bench)) {
+		memory_free(bench, sizeof(Bench_Render), MEMORY_TAG_APP);
+		return APP_RESULT_FAILURE;
+	}
+	log_info("Drawing %u quads in %u draw calls per frame", BENCH_GRID_COLUMNS * BENCH_GRID_ROWS, BENCH_GRID_COLUMNS);
+	frame_pacer_reset_stats();
+	return APP_RESULT_CONTINUE;
+}
+
+App_Result app_update(void* state) {
+	Bench_Render* bench = (Bench_Render*)state;
+	if (bench->frame++ < bench->frame_count) {
+		return APP_RESULT_CONTINUE;
+	}
+
+	// The last frame is still in the framebuffer until the next render
+	if (bench->capture_path && !capture_frame(bench->capture_path)) {
+		return APP_RESULT_FAILURE;
+	}
+	return APP_RESULT_SUCCESS;
+}
+
+App_Result app_render(void* state) {
+	draw_grid((Bench_Render*)state);
+	return APP_RESULT_CONTINUE;
+}
+
+App_Result app_on_resize(void* state) {
+	return APP_RESULT_CONTINUE;
+}
+
+App_Result app_shutdown(void* state) {
+	frame_pacer_report_stats();
+	destroy_grid((Bench_Render*)state);
+	memory_free(state, sizeof(Bench_Render), MEMORY_TAG_APP);
+	return APP_RESULT_SUCCESS;
+}
@@ -0,0 +1,301 @@
+#include "core/atomic.h"
+#include "core/log.h"
+#include "platform/platform.h"
+#include "platform/platform_thread.h"
+
+/**
+ * Stress checks and microbenchmarks for the threading primitives. The stress checks run first and the process exits
+ * with a failure if any of them lose an update or a wake.
+ */
+
+#define BENCH_THREAD_MAX 8
+#define BENCH_STRESS_INCREMENTS 200000
+#define BENCH_UNCONTENDED_LOCKS 10000000
+#define BENCH_ATOMIC_OPS 10000000
+#define BENCH_WAKE_ROUNDS 10000
+#define BENCH_CREATE_ROUNDS 1000
+#define BENCH_QUEUE_ITEMS 100000
+
+static u32 thread_counts[] = { 2, 4, 8 };
+
+typedef struct Shared {
+	Mutex mutex;
+	Condvar condvar;
+	Semaphore ping;
+	Semaphore pong;
+	u64 counter;
+	u64 atomic_counter;
+	u32 iterations;
+
+	// Producer and consumer queue, guarded by mutex
+	u64 queue[64];
+	u32 queue_head;
+	u32 queue_count;
+	b8 producers_done;
+	u64 consumed_sum;
+
+	// Wake latency, the poster writes the time it posted
+	u64 post_time;
+	u64 wake_total;
+} Shared;
+
+static Shared shared;
+
+static volatile u64 sink;
+
+//
+// Stress checks
+//
+
+static i32 increment_mutex(void* data) {
+	for (u32 i = 0; i < shared.iterations; i++) {
+		mutex_lock(&shared.mutex);
+		shared.counter++;
+		mutex_unlock(&shared.mutex);
+	}
+	return 0;
+}
+
+static i32 increment_atomic(void* data) {
+	for (u32 i = 0; i < shared.iterations; i++) {
+		atomic_fetch_add_u64(&shared.atomic_counter, 1, MEMORY_ORDER_RELAXED);
+	}
+	return 0;
+}
+
+static i32 produce(void* data) {
+	for (u32 i = 1; i <= BENCH_QUEUE_ITEMS; i++) {
+		mutex_lock(&shared.mutex);
+		while (shared.queue_count == 64) {
+			condvar_wait(&shared.condvar, &shared.mutex);
+		}
+		shared.queue[(shared.queue_head + shared.queue_count++) % 64] = i;
+		condvar_broadcast(&shared.condvar);
+		mutex_unlock(&shared.mutex);
+	}
+	return 0;
+}
+
+static i32 consume(void* data) {
+	u64 sum = 0;
+	for (;;) {
+		mutex_lock(&shared.mutex);
+		while (shared.queue_count == 0 && !shared.producers_done) {
+			condvar_wait(&shared.condvar, &shared.mutex);
+		}
+		if (shared.queue_count == 0) {
+			mutex_unlock(&shared.mutex);
+			break;
+		}
+		sum += shared.queue[shared.queue_head];
+		shared.queue_head = (shared.queue_head + 1) % 64;
+		shared.queue_count--;
+		condvar_broadcast(&shared.condvar);
+		mutex_unlock(&shared.mutex);
+	}
+
+	mutex_lock(&shared.mutex);
+	shared.consumed_sum += sum;
+	mutex_unlock(&shared.mutex);
+	return 0;
+}
+
+static i32 return_thread_id(void* data) {
+	static thread_local u64 id = 0;
+	id = thread_get_current_id();
+	Tls_Key key = *(Tls_Key*)data;
+	if (tls_get(key) != null) {
+		return 1;
+	}
+	tls_set(key, &id);
+	return tls_get(key) == &id ? 0 : 1;
+}
+
+static b8 run_threads(u32 thread_count, Thread_Function function, void* data) {
+	Thread threads[BENCH_THREAD_MAX];
+	u32 started = 0;
+	while (started < thread_count && thread_create(&threads[started], "haunt-bench", 0, function, data)) {
+		started++;
+	}
+	if (started < thread_count) {
+		log_error("Started %u of %u threads", started, thread_count);
+	}
+
+	// Threads already running still use the array, so they are joined before it goes away
+	b8 success = started == thread_count;
+	for (u32 i = 0; i < started; i++) {
+		success &= thread_join(&threads[i]) == 0;
+	}
+	return success;
+}
+
+static b8 stress(void) {
+	b8 success = true;
+
+	for (u32 i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]); i++) {
+		u32 thread_count = thread_counts[i];
+		shared.counter = 0;
+		shared.atomic_counter = 0;
+		shared.iterations = BENCH_STRESS_INCREMENTS;
+		if (!run_threads(thread_count, increment_mutex, null) || !run_threads(thread_count, increment_atomic, null)) {
+			success = false;
+			continue;
+		}
+
+		u64 expected = (u64)thread_count * BENCH_STRESS_INCREMENTS;
+		if (shared.counter != expected || shared.atomic_counter != expected) {
+			log_error("%u threads: mutex counted %llu, atomic counted %llu, expected %llu", thread_count, shared.counter, shared.atomic_counter, expected);
+			success = false;
+		}
+	}
+
+	// Two producers and two consumers through a small bounded queue
+	shared.queue_head = 0;
+	shared.queue_count = 0;
+	shared.producers_done = false;
+	shared.consumed_sum = 0;
+	Thread producers[2];
+	Thread consumers[2];
+	u32 consumer_count = 0;
+	u32 producer_count = 0;
+	while (consumer_count < 2 && thread_create(&consumers[consumer_count], "haunt-consumer", 0, consume, null)) {
+		consumer_count++;
+	}
+	while (consumer_count == 2 && producer_count < 2 &&
+		thread_create(&producers[producer_count], "haunt-producer", 0, produce, null)) {
+		producer_count++;
+	}
+	for (u32 i = 0; i < producer_count; i++) {
+		thread_join(&producers[i]);
+	}
+	mutex_lock(&shared.mutex);
+	shared.producers_done = true;
+	condvar_broadcast(&shared.condvar);
+	mutex_unlock(&shared.mutex);
+	for (u32 i = 0; i < consumer_count; i++) {
+		thread_join(&consumers[i]);
+	}
+	u64 expected_sum = 2ull * BENCH_QUEUE_ITEMS * (BENCH_QUEUE_ITEMS + 1) / 2;
+	if (producer_count < 2) {
+		log_error("Failed to start the condvar queue threads");
+		success = false;
+	} else if (shared.consumed_sum != expected_sum) {
+		log_error("Condvar queue consumed %llu, expected %llu", shared.consumed_sum, expected_sum);
+		success = false;
+	}
+
+	Tls_Key key;
+	if (!tls_create(&key) || !run_threads(4, return_thread_id, &key)) {
+		log_error("Thread local storage was shared between threads");
+		success = false;
+	}
+	tls_destroy(key);
+
+	mutex_lock(&shared.mutex);
+	if (mutex_try_lock(&shared.mutex)) {
+		log_error("Locked mutex was locked again");
+		success = false;
+	}
+	mutex_unlock(&shared.mutex);
+
+	return success;
+}
+
+//
+// Benchmarks
+//
+
+static f64 bench_uncontended_lock(void) {
+	Mutex mutex = {0};
+	u64 start = platform_get_time_ns();
+	for (u32 i = 0; i < BENCH_UNCONTENDED_LOCKS; i++) {
+		mutex_lock(&mutex);
+		sink++;
+		mutex_unlock(&mutex);
+	}
+	return (f64)(platform_get_time_ns() - start) / (f64)BENCH_UNCONTENDED_LOCKS;
+}
+
+static f64 bench_atomic_add(void) {
+	u64 value = 0;
+	u64 start = platform_get_time_ns();
+	for (u32 i = 0; i < BENCH_ATOMIC_OPS; i++) {
+		atomic_fetch_add_u64(&value, 1, MEMORY_ORDER_SEQ_CST);
+	}
+	sink += value;
+	return (f64)(platform_get_time_ns() - start) / (f64)BENCH_ATOMIC_OPS;
+}
+
+// Returns nanoseconds per lock with every thread incrementing one counter
+static f64 bench_contended_lock(u32 thread_count) {
+	shared.counter = 0;
+	shared.iterations = BENCH_STRESS_INCREMENTS;
+	u64 start = platform_get_time_ns();
+	run_threads(thread_count, increment_mutex, null);
+	return (f64)(platform_get_time_ns() - start) / (f64)(thread_count * BENCH_STRESS_INCREMENTS);
+}
+
+static i32 ping_pong(void* data) {
+	for (u32 i = 0; i < BENCH_WAKE_ROUNDS; i++) {
+		semaphore_wait(&shared.ping);
+		shared.wake_total += platform_get_time_ns() - atomic_load_u64(&shared.post_time, MEMORY_ORDER_ACQUIRE);
+		semaphore_post(&shared.pong, 1);
+	}
+	return 0;
+}
+
+// Time from a post to the sleeping waiter running, in nanoseconds
+static f64 bench_wake_latency(void) {
+	shared.wake_total = 0;
+	Thread thread;
+	if (!thread_create(&thread, "haunt-pong", 0, ping_pong, null)) {
+		log_error("Failed to start the wake latency thread");
+		return 0.0;
+	}
+	for (u32 i = 0; i < BENCH_WAKE_ROUNDS; i++) {
+		// Give the waiter time to fall asleep so each round measures a real wake
+		platform_sleep_until_ns(platform_get_time_ns() + 50000, 50000);
+		atomic_store_u64(&shared.post_time, platform_get_time_ns(), MEMORY_ORDER_RELEASE);
+		semaphore_post(&shared.ping, 1);
+		semaphore_wait(&shared.pong);
+	}
+	thread_join(&thread);
+	return (f64)shared.wake_total / (f64)BENCH_WAKE_ROUNDS;
+}
+
+static i32 do_nothing(void* data) {
+	return 0;
+}
+
+static f64 bench_thread_create(void) {
+	u64 start = platform_get_time_ns();
+	for (u32 i = 0; i < BENCH_CREATE_ROUNDS; i++) {
+		Thread thread;
+		if (!thread_create(&thread, "haunt-empty", 0, do_nothing, null)) {
+			log_error("Failed to create a thread after %u rounds", i);
+			return 0.0;
+		}
+		thread_join(&thread);
+	}
+	return (f64)(platform_get_time_ns() - start) / (f64)BENCH_CREATE_ROUNDS;
+}
+
+int main(int argc, char** argv) {
+	log_info("Threading benchmark");
+
+	if (!stress()) {
+		log_error("Stress checks failed");
+		return 1;
+	}
+	log_info("Stress checks passed");
+
+	log_info("%28s %10.2f ns", "uncontended lock+unlock", bench_uncontended_lock());
+	log_info("%28s %10.2f ns", "atomic add", bench_atomic_add());
+	for (u32 i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]); i++) {
+		log_info("%18u threads lock %10.2f ns", thread_counts[i], bench_contended_lock(thread_counts[i]));
+	}
+	log_info("%28s %10.2f ns", "semaphore wake latency", bench_wake_latency());
+	log_info("%28s %10.2f ns", "thread create+join", bench_thread_create());
+
+	return 0;
+}
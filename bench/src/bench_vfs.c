@@ -0,0 +1,244 @@
+#include <haunt.h>
+#include "bench_files.h"
+
+#if PLATFORM_LINUX
+#	include <sys/stat.h>
+#	include <unistd.h>
+#	define make_directory(path) mkdir(path, 0755)
+#	define remove_directory(path) rmdir(path)
+#else
+#	include <direct.h>
+#	define make_directory(path) _mkdir(path)
+#	define remove_directory(path) _rmdir(path)
+#endif
+
+/**
+ * Measures the VFS metadata cache against asking the OS every time, for existence checks of files that exist and
+ * files that don't, and for directory listings. Then packs the files into an archive and checks every file loads the
+ * same from the archive as from the directory. Runs headless.
+ *
+ * Usage: haunt-bench-vfs [--dir path] [--files N] [--checks N]
+ */
+
+#define BENCH_DEFAULT_FILES 512
+#define BENCH_DEFAULT_CHECKS 200000
+#define BENCH_DIRECTORY_COUNT 8
+
+typedef struct Bench_Vfs {
+	const char* dir;
+	char root[BENCH_PATH_MAX];
+	char archive[BENCH_PATH_MAX];
+	u32 file_count;
+	u32 check_count;
+} Bench_Vfs;
+
+App_Config app_config(void) {
+	App_Config config;
+	config.name = "Haunt VFS Benchmark";
+	config.window.x = 0;
+	config.window.y = 0;
+	config.window.width = 0;
+	config.window.height = 0;
+	config.target_frame_rate = 0.0f;
+	config.headless = true;
+	config.offscreen = false;
+	return config;
+}
+
+// Relative to the root, or to the mount point
+static void file_name(char* out, u32 index, b8 exists) {
+	snprintf(out, BENCH_PATH_MAX, "%u/%s-%05u.txt", index % BENCH_DIRECTORY_COUNT, exists ? "file" : "missing", index);
+}
+
+static b8 create_files(Bench_Vfs* bench) {
+	snprintf(bench->root, sizeof(bench->root), "%s/haunt-bench-vfs", bench->dir);
+	snprintf(bench->archive, sizeof(bench->archive), "%s/haunt-bench-vfs.hpak", bench->dir);
+
+	make_directory(bench->root);
+	for (u32 i = 0; i < BENCH_DIRECTORY_COUNT; i++) {
+		char path[BENCH_PATH_MAX * 2];
+		snprintf(path, sizeof(path), "%s/%u", bench->root, i);
+		make_directory(path);
+	}
+
+	for (u32 i = 0; i < bench->file_count; i++) {
+		char name[BENCH_PATH_MAX];
+		char path[BENCH_PATH_MAX * 2];
+		file_name(name, i, true);
+		snprintf(path, sizeof(path), "%s/%s", bench->root, name);
+
+		// Sizes vary so truncation or a wrong offset shows up
+		char text[4096];
+		u64 size = 0;
+		for (u32 j = 0; j <= i % 97; j++) {
+			size += (u64)snprintf(text + size, sizeof(text) - size, "file %u line %u\n", i, j);
+		}
+		if (!bench_write_file(path, text, size)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static void delete_files(Bench_Vfs* bench) {
+	char name[BENCH_PATH_MAX];
+	char path[BENCH_PATH_MAX * 2];
+	for (u32 i = 0; i < bench->file_count; i++) {
+		file_name(name, i, true);
+		snprintf(path, sizeof(path), "%s/%s", bench->root, name);
+		remove(path);
+	}
+	for (u32 i = 0; i < BENCH_DIRECTORY_COUNT; i++) {
+		snprintf(path, sizeof(path), "%s/%u", bench->root, i);
+		remove_directory(path);
+	}
+	remove_directory(bench->root);
+	remove(bench->archive);
+}
+
+static void count_child(const char* name, b8 is_directory, void* data) {
+	(*(u32*)data)++;
+}
+
+static void report(const char* name, u64 start, u32 count, u32 found) {
+	f64 ns = (f64)(platform_get_time_ns() - start) / (f64)count;
+	log_info("%28s %10.1f ns %10u found", name, ns, found);
+}
+
+// Paths are built up front so only the checks are timed
+static void measure_checks(Bench_Vfs* bench, b8 exists) {
+	u64 paths_size = (u64)bench->file_count * BENCH_PATH_MAX * 2;
+	char* os_paths = memory_alloc(paths_size, MEMORY_TAG_APP);
+	char* virtual_paths = memory_alloc(paths_size, MEMORY_TAG_APP);
+	for (u32 i = 0; i < bench->file_count; i++) {
+		char name[BENCH_PATH_MAX];
+		file_name(name, i, exists);
+		snprintf(os_paths + (u64)i * BENCH_PATH_MAX * 2, BENCH_PATH_MAX * 2, "%s/%s", bench->root, name);
+		snprintf(virtual_paths + (u64)i * BENCH_PATH_MAX * 2, BENCH_PATH_MAX * 2, "bench/%s", name);
+	}
+
+	File_Stat stat;
+	u32 found = 0;
+	u64 start = platform_get_time_ns();
+	for (u32 i = 0; i < bench->check_count; i++) {
+		found += platform_file_stat(os_paths + (u64)(i % bench->file_count) * BENCH_PATH_MAX * 2, &stat);
+	}
+	report(exists ? "platform stat hit" : "platform stat miss", start, bench->check_count, found);
+
+	found = 0;
+	start = platform_get_time_ns();
+	for (u32 i = 0; i < bench->check_count; i++) {
+		found += vfs_exists(virtual_paths + (u64)(i % bench->file_count) * BENCH_PATH_MAX * 2);
+	}
+	report(exists ? "vfs exists hit" : "vfs exists miss", start, bench->check_count, found);
+
+	memory_free(os_paths, paths_size, MEMORY_TAG_APP);
+	memory_free(virtual_paths, paths_size, MEMORY_TAG_APP);
+}
+
+static void measure_listings(Bench_Vfs* bench) {
+	u32 count = bench->check_count / 100;
+	char path[BENCH_PATH_MAX];
+
+	u32 found = 0;
+	u64 start = platform_get_time_ns();
+	for (u32 i = 0; i < count; i++) {
+		snprintf(path, sizeof(path), "%s/%u", bench->root, i % BENCH_DIRECTORY_COUNT);
+		platform_file_list(path, count_child, &found);
+	}
+	report("platform list", start, count, found);
+
+	found = 0;
+	start = platform_get_time_ns();
+	for (u32 i = 0; i < count; i++) {
+		snprintf(path, sizeof(path), "bench/%u", i % BENCH_DIRECTORY_COUNT);
+		vfs_list(path, count_child, &found);
+	}
+	report("vfs list", start, count, found);
+}
+
+// Every file has to load the same from the archive as from the directory
+static b8 verify_archive(Bench_Vfs* bench) {
+	if (!vfs_pack_directory(bench->root, bench->archive) || !vfs_mount_archive("packed", bench->archive)) {
+		return false;
+	}
+
+	u32 mismatches = 0;
+	for (u32 i = 0; i < bench->file_count; i++) {
+		char name[BENCH_PATH_MAX];
+		char path[BENCH_PATH_MAX * 2];
+		file_name(name, i, true);
+
+		Vfs_File loose;
+		Vfs_File packed;
+		snprintf(path, sizeof(path), "bench/%s", name);
+		b8 loaded = vfs_read(path, &loose);
+		snprintf(path, sizeof(path), "packed/%s", name);
+		loaded = vfs_map(path, &packed) && loaded;
+		if (!loaded || loose.size != packed.size || memcmp(loose.data, packed.data, loose.size) != 0) {
+			mismatches++;
+		}
+		vfs_release(&loose);
+		vfs_release(&packed);
+	}
+
+	u32 children = 0;
+	vfs_list("packed", count_child, &children);
+	vfs_unmount("packed");
+	log_info("Archive holds %u directories, %u of %u files differ", children, mismatches, bench->file_count);
+	return mismatches == 0 && children == BENCH_DIRECTORY_COUNT;
+}
+
+App_Result app_start(void** state, int argc, char** argv) {
+	*state = memory_alloc(sizeof(Bench_Vfs), MEMORY_TAG_APP);
+	Bench_Vfs* bench = (Bench_Vfs*)*state;
+	memory_zero(bench, sizeof(Bench_Vfs));
+
+	bench->dir = bench_scratch_dir();
+	bench->file_count = BENCH_DEFAULT_FILES;
+	bench->check_count = BENCH_DEFAULT_CHECKS;
+	for (int i = 1; i + 1 < argc; i++) {
+		if (strcmp(argv[i], "--dir") == 0) {
+			bench->dir = argv[++i];
+		} else if (strcmp(argv[i], "--files") == 0) {
+			bench->file_count = (u32)atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--checks") == 0) {
+			bench->check_count = (u32)atoi(argv[++i]);
+		}
+	}
+	if (bench->file_count == 0 || bench->check_count < 100) {
+		log_error("Need at least one file and a hundred checks");
+		return APP_RESULT_FAILURE;
+	}
+
+	log_info("Creating %u files in %s", bench->file_count, bench->dir);
+	if (!create_files(bench) || !vfs_mount_directory("bench", bench->root)) {
+		delete_files(bench);
+		return APP_RESULT_FAILURE;
+	}
+	return APP_RESULT_CONTINUE;
+}
+
+App_Result app_update(void* state) {
+	Bench_Vfs* bench = (Bench_Vfs*)state;
+	measure_checks(bench, true);
+	measure_checks(bench, false);
+	measure_listings(bench);
+	return verify_archive(bench) ? APP_RESULT_SUCCESS : APP_RESULT_FAILURE;
+}
+
+App_Result app_render(void* state) {
+	return APP_RESULT_CONTINUE;
+}
+
+App_Result app_on_resize(void* state) {
+	return APP_RESULT_CONTINUE;
+}
+
+App_Result app_shutdown(void* state) {
+	Bench_Vfs* bench = (Bench_Vfs*)state;
+	vfs_unmount("bench");
+	delete_files(bench);
+	memory_free(bench, sizeof(Bench_Vfs), MEMORY_TAG_APP);
+	return APP_RESULT_SUCCESS;
+}
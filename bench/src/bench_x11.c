@@ -0,0 +1,276 @@
+#include "core/context.h"
+
+// XCB's headers name parameters after the math constants in haunt.h, so they come first
+#if PLATFORM_LINUX
+#	include <X11/Xlib.h>
+#	include <X11/Xatom.h>
+#	include <X11/Xlib-xcb.h>
+#	include <xcb/xcb.h>
+#endif
+
+#include <haunt.h>
+#include "platform/platform.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Compares reading X events through Xlib with reading them through XCB, the way platform_pump_messages does with
+ * PLATFORM_XCB_ENABLED off and on.
+ *
+ * Startup interns a set of atoms one XInternAtom at a time, all at once with XInternAtoms, and through XCB cookies
+ * whose replies are collected afterwards. Each is reported in round trips, measured against XSync. The event loop is
+ * pumped once per frame with an empty queue, then with a burst of client messages sent from another connection before
+ * every frame. Needs an X display, but no window is mapped.
+ *
+ * Usage: haunt-bench-x11 [--frames N] [--events N]
+ */
+
+#define BENCH_DEFAULT_FRAMES 10000
+#define BENCH_DEFAULT_EVENTS 64
+#define BENCH_ROUND_TRIPS 1000
+
+typedef struct Bench_X11 {
+	u32 frame_count;
+	u32 event_count;
+} Bench_X11;
+
+App_Config app_config(void) {
+	App_Config config;
+	config.name = "Haunt X11 Benchmark";
+	config.window.x = 0;
+	config.window.y = 0;
+	config.window.width = 0;
+	config.window.height = 0;
+	config.target_frame_rate = 0.0f;
+	config.headless = true;
+	config.offscreen = false;
+	return config;
+}
+
+#if PLATFORM_LINUX
+
+// Atoms a windowed app interns at startup. They exist on any server with a window manager, so interning them does not
+// leave new atoms behind.
+static const char* atom_names[] = {
+	"WM_PROTOCOLS",
+	"WM_DELETE_WINDOW",
+	"WM_STATE",
+	"_NET_WM_STATE",
+	"_NET_WM_STATE_HIDDEN",
+	"_NET_WM_STATE_FOCUSED",
+	"_NET_WM_NAME",
+	"UTF8_STRING",
+};
+
+#define ATOM_COUNT (sizeof(atom_names) / sizeof(atom_names[0]))
+
+typedef struct Receiver {
+	Display* display;
+	// Set when XCB owns the event queue
+	xcb_connection_t* connection;
+	Window window;
+	u64 received;
+} Receiver;
+
+static b8 open_receiver(Receiver* receiver, b8 xcb) {
+	memory_zero(receiver, sizeof(Receiver));
+	receiver->display = XOpenDisplay(null);
+	if (!receiver->display) {
+		return false;
+	}
+	if (xcb) {
+		XSetEventQueueOwner(receiver->display, XCBOwnsEventQueue);
+		receiver->connection = XGetXCBConnection(receiver->display);
+	}
+
+	// Events sent with an empty mask go to the window's creator, so the window never needs to be mapped
+	receiver->window = XCreateWindow(
+		receiver->display, DefaultRootWindow(receiver->display), 0, 0, 1, 1, 0, 0, InputOnly, CopyFromParent, 0, null);
+	XSync(receiver->display, False);
+	return true;
+}
+
+static void close_receiver(Receiver* receiver) {
+	XDestroyWindow(receiver->display, receiver->window);
+	XCloseDisplay(receiver->display);
+}
+
+// The Xlib loop platform_pump_messages runs without XCB
+static void pump_xlib(Receiver* receiver) {
+	XEvent event;
+	while (XPending(receiver->display)) {
+		XNextEvent(receiver->display, &event);
+		receiver->received += event.type == ClientMessage;
+	}
+}
+
+// The XCB loop platform_pump_messages runs with XCB
+static void pump_xcb(Receiver* receiver) {
+	xcb_flush(receiver->connection);
+	xcb_generic_event_t* event = xcb_poll_for_event(receiver->connection);
+	while (event) {
+		receiver->received += (event->response_type & ~0x80) == XCB_CLIENT_MESSAGE;
+		free(event);
+		event = xcb_poll_for_queued_event(receiver->connection);
+	}
+}
+
+static void pump(Receiver* receiver) {
+	if (receiver->connection) {
+		pump_xcb(receiver);
+	} else {
+		pump_xlib(receiver);
+	}
+}
+
+static f64 measure_round_trip(Display* display) {
+	u64 start = platform_get_time_ns();
+	for (u32 i = 0; i < BENCH_ROUND_TRIPS; i++) {
+		XSync(display, False);
+	}
+	return (f64)(platform_get_time_ns() - start) / BENCH_ROUND_TRIPS;
+}
+
+static void report_atoms(const char* name, u64 start, f64 round_trip_ns) {
+	f64 ns = (f64)(platform_get_time_ns() - start);
+	log_info("%28s %10.1f us %10.2f round trips", name, ns / 1000.0, ns / round_trip_ns);
+}
+
+static void measure_atoms(Display* display, f64 round_trip_ns) {
+	Atom atoms[ATOM_COUNT];
+	u64 start = platform_get_time_ns();
+	for (u32 i = 0; i < ATOM_COUNT; i++) {
+		atoms[i] = XInternAtom(display, atom_names[i], False);
+	}
+	report_atoms("XInternAtom each", start, round_trip_ns);
+
+	start = platform_get_time_ns();
+	XInternAtoms(display, (char**)atom_names, ATOM_COUNT, False, atoms);
+	report_atoms("XInternAtoms", start, round_trip_ns);
+
+	// The gap between sending and collecting is where startup would do its other work
+	xcb_connection_t* connection = XGetXCBConnection(display);
+	xcb_intern_atom_cookie_t cookies[ATOM_COUNT];
+	start = platform_get_time_ns();
+	for (u32 i = 0; i < ATOM_COUNT; i++) {
+		cookies[i] = xcb_intern_atom(connection, 0, (u16)strlen(atom_names[i]), atom_names[i]);
+	}
+	xcb_flush(connection);
+	report_atoms("xcb_intern_atom sent", start, round_trip_ns);
+	for (u32 i = 0; i < ATOM_COUNT; i++) {
+		xcb_intern_atom_reply_t* reply = xcb_intern_atom_reply(connection, cookies[i], null);
+		if (reply) {
+			atoms[i] = reply->atom;
+			free(reply);
+		}
+	}
+	report_atoms("xcb_intern_atom collected", start, round_trip_ns);
+}
+
+static void send_burst(Display* sender, Window window, u32 count) {
+	XEvent event;
+	memory_zero(&event, sizeof(event));
+	event.xclient.type = ClientMessage;
+	event.xclient.window = window;
+	event.xclient.message_type = XA_PRIMARY;
+	event.xclient.format = 32;
+	for (u32 i = 0; i < count; i++) {
+		XSendEvent(sender, window, False, 0, &event);
+	}
+	// Once the server answers, it has written the burst to the receiver
+	XSync(sender, False);
+}
+
+static void measure_pump(Bench_X11* bench, Display* sender, b8 xcb, u32 burst) {
+	Receiver receiver;
+	if (!open_receiver(&receiver, xcb)) {
+		log_error("Failed to open a receiving X connection");
+		return;
+	}
+
+	u64 elapsed = 0;
+	for (u32 i = 0; i < bench->frame_count; i++) {
+		if (burst > 0) {
+			send_burst(sender, receiver.window, burst);
+		}
+		u64 start = platform_get_time_ns();
+		pump(&receiver);
+		elapsed += platform_get_time_ns() - start;
+	}
+
+	// Anything the frames missed arrives late, not never
+	XSync(receiver.display, False);
+	pump(&receiver);
+
+	u64 sent = (u64)burst * bench->frame_count;
+	f64 frame_ns = (f64)elapsed / bench->frame_count;
+	char name[64];
+	snprintf(name, sizeof(name), "%s pump, %u events", xcb ? "xcb" : "xlib", burst);
+	log_info("%28s %10.1f ns/frame %10.1f ns/event %10llu of %llu received", name, frame_ns,
+		burst > 0 ? (f64)elapsed / (f64)sent : 0.0, receiver.received, sent);
+	close_receiver(&receiver);
+}
+
+#endif // PLATFORM_LINUX
+
+App_Result app_start(void** state, int argc, char** argv) {
+	*state = memory_alloc(sizeof(Bench_X11), MEMORY_TAG_APP);
+	Bench_X11* bench = (Bench_X11*)*state;
+	memory_zero(bench, sizeof(Bench_X11));
+
+	bench->frame_count = BENCH_DEFAULT_FRAMES;
+	bench->event_count = BENCH_DEFAULT_EVENTS;
+	for (int i = 1; i + 1 < argc; i++) {
+		if (strcmp(argv[i], "--frames") == 0) {
+			bench->frame_count = (u32)atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--events") == 0) {
+			bench->event_count = (u32)atoi(argv[++i]);
+		}
+	}
+	if (bench->frame_count == 0) {
+		log_error("Need at least one frame");
+		return APP_RESULT_FAILURE;
+	}
+	return APP_RESULT_CONTINUE;
+}
+
+App_Result app_update(void* state) {
+#if PLATFORM_LINUX
+	Bench_X11* bench = (Bench_X11*)state;
+	Display* sender = XOpenDisplay(null);
+	if (!sender) {
+		log_error("Failed to open X display");
+		return APP_RESULT_FAILURE;
+	}
+
+	f64 round_trip_ns = measure_round_trip(sender);
+	log_info("%28s %10.1f us", "round trip", round_trip_ns / 1000.0);
+	measure_atoms(sender, round_trip_ns);
+
+	measure_pump(bench, sender, false, 0);
+	measure_pump(bench, sender, true, 0);
+	measure_pump(bench, sender, false, bench->event_count);
+	measure_pump(bench, sender, true, bench->event_count);
+
+	XCloseDisplay(sender);
+	return APP_RESULT_SUCCESS;
+#else
+	log_info("Only X11 is measured, nothing to do on this platform");
+	return APP_RESULT_SUCCESS;
+#endif
+}
+
+App_Result app_render(void* state) {
+	return APP_RESULT_CONTINUE;
+}
+
+App_Result app_on_resize(void* state) {
+	return APP_RESULT_CONTINUE;
+}
+
+App_Result app_shutdown(void* state) {
+	memory_free(state, sizeof(Bench_X11), MEMORY_TAG_APP);
+	return APP_RESULT_SUCCESS;
+}
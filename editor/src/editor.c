@@ -1,8 +1,14 @@
 #include <haunt.h>
 #include "graphics/shader.h"
 
+#include <string.h>
+
 typedef struct Editor {
 	b8 should_quit;
+	// Registered again after the app module reloads, since it points into the old build
+	Event_Handle key_press_handle;
+	// Kept alive so edits to its sources reload while the editor runs
+	Shader shader;
 } Editor;
 
 static b8 handle_key_press(Event_Code code, Event_Context* context, void* sender, void* listener);
@@ -14,20 +20,21 @@ App_Config app_config(void) {
 	config.window.y = 100;
 	config.window.width = 1280;
 	config.window.height = 720;
+	config.target_frame_rate = 120.0f;
+	config.headless = false;
+	config.offscreen = false;
 	return config;
 }
 
-static void test_shader_loading(void) {
-	Shader shader;
+static void test_shader_loading(Editor* editor) {
 	b8 result = shader_create_from_files(
-		&shader,
+		&editor->shader,
 		"engine/assets/shaders/basic.vert",
 		"engine/assets/shaders/basic.frag"
 	);
 
 	if (result) {
 		log_info("Shader loaded successfully!");
-		shader_destroy(&shader);
 	} else {
 		log_error("Failed to load shader!");
 	}
@@ -39,12 +46,22 @@ App_Result app_start(void** state, int argc, char** argv) {
 	// Allocate editor state
 	*state = memory_alloc(sizeof(Editor), MEMORY_TAG_EDITOR);
 	Editor* editor = (Editor*)*state;
+	memory_zero(editor, sizeof(Editor));
+
+	// Record or replay the session's input for deterministic runs
+	for (int i = 1; i + 1 < argc; i++) {
+		if (strcmp(argv[i], "--record") == 0) {
+			event_record_start(argv[++i]);
+		} else if (strcmp(argv[i], "--replay") == 0) {
+			event_replay_start(argv[++i]);
+		}
+	}
 
 	// Register events
-	event_register(EVENT_TYPE_KEY_PRESS, editor, handle_key_press);
+	editor->key_press_handle = event_register(EVENT_TYPE_KEY_PRESS, editor, handle_key_press);
 
 	// Test shader loading
-	test_shader_loading();
+	test_shader_loading(editor);
 
 	return APP_RESULT_CONTINUE;
 }
@@ -69,11 +86,22 @@ App_Result app_on_resize(void* state) {
 
 App_Result app_shutdown(void* state) {
 	Editor* editor = (Editor*)state;
+	shader_destroy(&editor->shader);
 	memory_free(editor, sizeof(Editor), MEMORY_TAG_EDITOR);
 
 	return APP_RESULT_SUCCESS;
 }
 
+void app_on_unload(void* state) {
+	Editor* editor = (Editor*)state;
+	event_unregister(editor->key_press_handle);
+}
+
+void app_on_reload(void* state) {
+	Editor* editor = (Editor*)state;
+	editor->key_press_handle = event_register(EVENT_TYPE_KEY_PRESS, editor, handle_key_press);
+}
+
 static b8 handle_key_press(Event_Code code, Event_Context* context, void* sender, void* listener) {
 	Editor* editor = (Editor*)listener;
 
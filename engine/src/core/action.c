@@ -0,0 +1,248 @@
+#include "core/action.h"
+
+#include "core/log.h"
+#include "core/memory.h"
+
+// Keys and mouse buttons share one source space, mouse buttons after the keys
+#define SOURCE_COUNT (KEY_COUNT + MOUSE_BUTTON_COUNT)
+#define SOURCE_WORD_COUNT ((SOURCE_COUNT + 63) / 64)
+#define SOURCE_NONE 0xFFFF
+
+typedef struct Action_Binding {
+	u16 target;
+	b8 is_axis;
+	u16 source;
+	u16 held;
+	u32 modifiers;
+	f32 scale;
+} Action_Binding;
+
+// A binding is down when every source in required is down and no source in excluded is.
+typedef struct Compiled_Binding {
+	u64 required[SOURCE_WORD_COUNT];
+	u64 excluded[SOURCE_WORD_COUNT];
+	u32 target;
+	// The source that triggers the binding, the last key of a chord
+	u32 source;
+	f32 scale;
+} Compiled_Binding;
+
+typedef struct Action_System {
+	Action_Binding bindings[ACTION_BINDING_MAX];
+	u32 binding_count;
+	b8 dirty;
+
+	Compiled_Binding compiled_actions[ACTION_BINDING_MAX];
+	u32 compiled_action_count;
+	Compiled_Binding compiled_axes[ACTION_BINDING_MAX];
+	u32 compiled_axis_count;
+
+	Action_State state;
+} Action_System;
+
+static Action_System action_system = {0};
+
+static inline void set_source_bit(u64* bits, u32 source) {
+	bits[source >> 6] |= 1ull << (source & 63);
+}
+
+static void compile_binding(const Action_Binding* binding, Compiled_Binding* out) {
+	memory_zero(out, sizeof(Compiled_Binding));
+	out->target = binding->target;
+	out->source = binding->source;
+	out->scale = binding->scale;
+
+	set_source_bit(out->required, binding->source);
+	if (binding->held != SOURCE_NONE) {
+		set_source_bit(out->required, binding->held);
+	}
+
+	static const struct { u32 modifier; Key key; } modifier_keys[] = {
+		{ ACTION_MODIFIER_SHIFT, KEY_SHIFT },
+		{ ACTION_MODIFIER_CONTROL, KEY_CONTROL },
+		{ ACTION_MODIFIER_ALT, KEY_ALT },
+	};
+	for (u32 i = 0; i < sizeof(modifier_keys) / sizeof(modifier_keys[0]); i++) {
+		if (binding->modifiers & modifier_keys[i].modifier) {
+			set_source_bit(out->required, modifier_keys[i].key);
+		} else if (binding->modifiers & ACTION_MODIFIER_EXACT) {
+			set_source_bit(out->excluded, modifier_keys[i].key);
+		}
+	}
+}
+
+static void compile_bindings(void) {
+	action_system.compiled_action_count = 0;
+	action_system.compiled_axis_count = 0;
+	for (u32 i = 0; i < action_system.binding_count; i++) {
+		Action_Binding* binding = &action_system.bindings[i];
+		if (binding->is_axis) {
+			compile_binding(binding, &action_system.compiled_axes[action_system.compiled_axis_count++]);
+		} else {
+			compile_binding(binding, &action_system.compiled_actions[action_system.compiled_action_count++]);
+		}
+	}
+	action_system.dirty = false;
+}
+
+static inline b8 binding_is_down(const Compiled_Binding* binding, const u64* sources) {
+	u64 missing = 0;
+	u64 blocked = 0;
+	for (u32 word = 0; word < SOURCE_WORD_COUNT; word++) {
+		missing |= binding->required[word] & ~sources[word];
+		blocked |= binding->excluded[word] & sources[word];
+	}
+	return !(missing | blocked);
+}
+
+// A binding whose source went down this frame, with everything else it needs down at some point in the frame. Catches
+// taps that were already released by the time the frame is sampled.
+static inline b8 binding_was_pressed(const Compiled_Binding* binding, const u64* down, const u64* pressed) {
+	if (!((pressed[binding->source >> 6] >> (binding->source & 63)) & 1)) {
+		return false;
+	}
+	u64 missing = 0;
+	u64 blocked = 0;
+	for (u32 word = 0; word < SOURCE_WORD_COUNT; word++) {
+		missing |= binding->required[word] & ~(down[word] | pressed[word]);
+		blocked |= binding->excluded[word] & down[word];
+	}
+	return !(missing | blocked);
+}
+
+static void gather_sources(u64* sources, const u64* keys, u32 buttons) {
+	for (u32 word = 0; word < KEY_WORD_COUNT; word++) {
+		sources[word] = keys[word];
+	}
+	for (u32 button = 0; button < MOUSE_BUTTON_COUNT; button++) {
+		if ((buttons >> button) & 1) {
+			set_source_bit(sources, KEY_COUNT + button);
+		}
+	}
+}
+
+void action_update(void) {
+	if (action_system.dirty) {
+		compile_bindings();
+	}
+
+	// Gather every source into one bitset, once for what is down now and once for what went down this frame
+	u64 sources[SOURCE_WORD_COUNT] = {0};
+	u64 pressed_sources[SOURCE_WORD_COUNT] = {0};
+	gather_sources(sources, input_get_key_down_bits(), input_get_mouse_button_down_bits());
+	gather_sources(pressed_sources, input_get_key_pressed_bits(), input_get_mouse_button_pressed_bits());
+
+	Action_State* state = &action_system.state;
+	u64 down[ACTION_WORD_COUNT] = {0};
+	u64 triggered[ACTION_WORD_COUNT] = {0};
+	for (u32 i = 0; i < action_system.compiled_action_count; i++) {
+		const Compiled_Binding* binding = &action_system.compiled_actions[i];
+		u64 bit = 1ull << (binding->target & 63);
+		if (binding_is_down(binding, sources)) {
+			down[binding->target >> 6] |= bit;
+		}
+		if (binding_was_pressed(binding, sources, pressed_sources)) {
+			triggered[binding->target >> 6] |= bit;
+		}
+	}
+
+	// A trigger that is no longer down was tapped within the frame, and one that was already down was released and
+	// pressed again, so both report a press and a release
+	for (u32 word = 0; word < ACTION_WORD_COUNT; word++) {
+		u64 was_down = state->down[word];
+		state->pressed[word] = (down[word] & ~was_down) | triggered[word];
+		state->released[word] = (~down[word] & was_down) | (triggered[word] & (~down[word] | was_down));
+		state->down[word] = down[word];
+	}
+
+	memory_zero(state->axes, sizeof(state->axes));
+	for (u32 i = 0; i < action_system.compiled_axis_count; i++) {
+		const Compiled_Binding* binding = &action_system.compiled_axes[i];
+		if (binding_is_down(binding, sources)) {
+			state->axes[binding->target] += binding->scale;
+		}
+	}
+	for (u32 axis = 0; axis < AXIS_MAX; axis++) {
+		f32 value = state->axes[axis];
+		state->axes[axis] = value > 1.0f ? 1.0f : value < -1.0f ? -1.0f : value;
+	}
+}
+
+static b8 add_binding(u32 target, b8 is_axis, u32 source, u32 held, u32 modifiers, f32 scale) {
+	if (action_system.binding_count >= ACTION_BINDING_MAX) {
+		log_error("Action bindings are full");
+		return false;
+	}
+
+	Action_Binding* binding = &action_system.bindings[action_system.binding_count++];
+	binding->target = (u16)target;
+	binding->is_axis = is_axis;
+	binding->source = (u16)source;
+	binding->held = (u16)held;
+	binding->modifiers = modifiers;
+	binding->scale = scale;
+	action_system.dirty = true;
+	return true;
+}
+
+b8 action_bind_key(Action action, Key key, u32 modifiers) {
+	if (action >= ACTION_MAX || key >= KEY_COUNT) {
+		log_error("Cannot bind key %d to action %u", key, action);
+		return false;
+	}
+	return add_binding(action, false, key, SOURCE_NONE, modifiers, 1.0f);
+}
+
+b8 action_bind_mouse_button(Action action, Mouse_Button button, u32 modifiers) {
+	if (action >= ACTION_MAX || button >= MOUSE_BUTTON_COUNT) {
+		log_error("Cannot bind mouse button %d to action %u", button, action);
+		return false;
+	}
+	return add_binding(action, false, KEY_COUNT + button, SOURCE_NONE, modifiers, 1.0f);
+}
+
+b8 action_bind_chord(Action action, Key held, Key key, u32 modifiers) {
+	if (action >= ACTION_MAX || held >= KEY_COUNT || key >= KEY_COUNT) {
+		log_error("Cannot bind chord %d+%d to action %u", held, key, action);
+		return false;
+	}
+	return add_binding(action, false, key, held, modifiers, 1.0f);
+}
+
+b8 action_bind_axis_key(Axis axis, Key key, f32 scale) {
+	if (axis >= AXIS_MAX || key >= KEY_COUNT) {
+		log_error("Cannot bind key %d to axis %u", key, axis);
+		return false;
+	}
+	return add_binding(axis, true, key, SOURCE_NONE, ACTION_MODIFIER_NONE, scale);
+}
+
+static void remove_bindings(u32 target, b8 is_axis) {
+	u32 count = 0;
+	for (u32 i = 0; i < action_system.binding_count; i++) {
+		Action_Binding* binding = &action_system.bindings[i];
+		if (binding->target == target && binding->is_axis == is_axis) {
+			continue;
+		}
+		action_system.bindings[count++] = *binding;
+	}
+	action_system.binding_count = count;
+	action_system.dirty = true;
+}
+
+void action_unbind(Action action) {
+	remove_bindings(action, false);
+}
+
+void action_unbind_axis(Axis axis) {
+	remove_bindings(axis, true);
+}
+
+void action_clear_bindings(void) {
+	action_system.binding_count = 0;
+	action_system.dirty = true;
+}
+
+const Action_State* action_get_state(void) {
+	return &action_system.state;
+}
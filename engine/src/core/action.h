@@ -0,0 +1,90 @@
+#pragma once
+
+#include "core/export.h"
+#include "core/types.h"
+#include "core/input.h"
+
+/**
+ * Maps keys and mouse buttons to game defined actions and axes.
+ *
+ * Bindings are compiled into a flat table the first frame after they change, and evaluated once per frame into a
+ * packed Action_State. Gameplay reads the state with the inline helpers below, so each query is a bit test instead of
+ * a call into the engine, and rebinding never touches gameplay code.
+ */
+
+#define ACTION_MAX 256
+#define AXIS_MAX 32
+#define ACTION_BINDING_MAX 512
+#define ACTION_WORD_COUNT ((ACTION_MAX + 63) / 64)
+
+// Game defined, in [0, ACTION_MAX)
+typedef u32 Action;
+
+// Game defined, in [0, AXIS_MAX)
+typedef u32 Axis;
+
+typedef enum Action_Modifier {
+	ACTION_MODIFIER_NONE = 0,
+	ACTION_MODIFIER_SHIFT = 1 << 0,
+	ACTION_MODIFIER_CONTROL = 1 << 1,
+	ACTION_MODIFIER_ALT = 1 << 2,
+	// Modifiers not listed must be up, so Ctrl+S does not also trigger S
+	ACTION_MODIFIER_EXACT = 1 << 3,
+} Action_Modifier;
+
+typedef struct Action_State {
+	u64 down[ACTION_WORD_COUNT];
+	u64 pressed[ACTION_WORD_COUNT];
+	u64 released[ACTION_WORD_COUNT];
+	f32 axes[AXIS_MAX];
+} Action_State;
+
+//
+// Lifecycle
+//
+
+// Evaluates the bindings against the current input. Called once per frame by the engine after input is pumped.
+void action_update(void);
+
+//
+// Bindings
+//
+
+export b8 action_bind_key(Action action, Key key, u32 modifiers);
+
+export b8 action_bind_mouse_button(Action action, Mouse_Button button, u32 modifiers);
+
+// Binds a key that only triggers the action while another key is held
+export b8 action_bind_chord(Action action, Key held, Key key, u32 modifiers);
+
+// Adds scale to the axis while the key is down. Opposing keys cancel out.
+export b8 action_bind_axis_key(Axis axis, Key key, f32 scale);
+
+export void action_unbind(Action action);
+
+export void action_unbind_axis(Axis axis);
+
+export void action_clear_bindings(void);
+
+//
+// State
+//
+
+// Gets the state evaluated this frame. Valid for the lifetime of the engine.
+export const Action_State* action_get_state(void);
+
+static inline b8 action_is_down(const Action_State* state, Action action) {
+	return (state->down[action >> 6] >> (action & 63)) & 1;
+}
+
+static inline b8 action_is_pressed(const Action_State* state, Action action) {
+	return (state->pressed[action >> 6] >> (action & 63)) & 1;
+}
+
+static inline b8 action_is_released(const Action_State* state, Action action) {
+	return (state->released[action >> 6] >> (action & 63)) & 1;
+}
+
+static inline f32 action_get_axis(const Action_State* state, Axis axis) {
+	return state->axes[axis];
+}
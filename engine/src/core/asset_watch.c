@@ -0,0 +1,155 @@
+#include "core/asset_watch.h"
+
+#include "core/event.h"
+#include "core/log.h"
+#include "core/vfs.h"
+#include "platform/platform.h"
+#include "platform/platform_watch.h"
+
+#include <string.h>
+
+typedef struct Asset_Watch_File {
+	char path[VFS_PATH_MAX];
+	// OS path, split at the last separator into the watched directory and the name
+	char os_path[VFS_PATH_MAX];
+	u32 name_offset;
+	i32 watch;
+	u32 references;
+
+	b8 pending;
+	u64 changed_ns;
+} Asset_Watch_File;
+
+typedef struct Asset_Watch_System {
+	b8 running;
+	Asset_Watch_File files[ASSET_WATCH_MAX];
+	u32 file_count;
+} Asset_Watch_System;
+
+static Asset_Watch_System assets = {0};
+
+static Asset_Watch_File* find_file(const char* path) {
+	for (u32 i = 0; i < assets.file_count; i++) {
+		if (strcmp(assets.files[i].path, path) == 0) {
+			return &assets.files[i];
+		}
+	}
+	return null;
+}
+
+//
+// Lifecycle
+//
+
+void asset_watch_init(void) {
+	if (!ASSET_HOT_RELOAD_ENABLED) {
+		return;
+	}
+	assets.running = platform_watch_start();
+	assets.file_count = 0;
+}
+
+void asset_watch_shutdown(void) {
+	if (assets.running) {
+		platform_watch_shutdown();
+	}
+	assets.running = false;
+	assets.file_count = 0;
+}
+
+static void handle_change(i32 watch, const char* name, void* data) {
+	u64 now = *(u64*)data;
+	for (u32 i = 0; i < assets.file_count; i++) {
+		Asset_Watch_File* file = &assets.files[i];
+		if (watch == PLATFORM_WATCH_OVERFLOW || (file->watch == watch && strcmp(file->os_path + file->name_offset, name) == 0)) {
+			// Every change pushes the reload back, so it happens once the writes are done
+			file->pending = true;
+			file->changed_ns = now;
+		}
+	}
+}
+
+void asset_watch_update(void) {
+	if (!assets.running || assets.file_count == 0) {
+		return;
+	}
+
+	u64 now = platform_get_time_ns();
+	platform_watch_poll(handle_change, &now);
+
+	for (u32 i = 0; i < assets.file_count; i++) {
+		Asset_Watch_File* file = &assets.files[i];
+		if (!file->pending || now - file->changed_ns < ASSET_WATCH_DEBOUNCE_MS * 1000000ull) {
+			continue;
+		}
+		file->pending = false;
+
+		// Handlers may add or remove watches, which moves the files around
+		char path[VFS_PATH_MAX];
+		strcpy(path, file->path);
+		vfs_invalidate(path);
+		log_info("Asset changed: %s", path);
+		event_fire(EVENT_TYPE_ASSET_CHANGED, (Event_Context){0}, path);
+	}
+}
+
+//
+// Files
+//
+
+b8 asset_watch_add(const char* path) {
+	if (!assets.running) {
+		return false;
+	}
+
+	Asset_Watch_File* file = find_file(path);
+	if (file) {
+		file->references++;
+		return true;
+	}
+	if (assets.file_count == ASSET_WATCH_MAX || strlen(path) >= VFS_PATH_MAX) {
+		log_error("Can't watch %s, too many files are watched or the path is too long", path);
+		return false;
+	}
+
+	file = &assets.files[assets.file_count];
+	if (!vfs_resolve(path, file->os_path, sizeof(file->os_path))) {
+		// Served from an archive or memory, or missing
+		return false;
+	}
+
+	char* separator = strrchr(file->os_path, '/');
+	char* backslash = strrchr(file->os_path, '\\');
+	if (backslash > separator) {
+		separator = backslash;
+	}
+	if (separator) {
+		char original = *separator;
+		*separator = 0;
+		file->watch = platform_watch_directory(file->os_path);
+		*separator = original;
+		file->name_offset = (u32)(separator - file->os_path) + 1;
+	} else {
+		file->watch = platform_watch_directory(".");
+		file->name_offset = 0;
+	}
+	if (file->watch < 0) {
+		return false;
+	}
+
+	strcpy(file->path, path);
+	file->references = 1;
+	file->pending = false;
+	assets.file_count++;
+	return true;
+}
+
+void asset_watch_remove(const char* path) {
+	Asset_Watch_File* file = find_file(path);
+	if (!file || --file->references > 0) {
+		return;
+	}
+
+	platform_watch_release(file->watch);
+	*file = assets.files[--assets.file_count];
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "core/export.h"
+#include "core/types.h"
+
+/**
+ * Asset hot reload.
+ *
+ * Watches files by their virtual path and fires EVENT_TYPE_ASSET_CHANGED, with the path as the sender, once a changed
+ * file has been quiet for ASSET_WATCH_DEBOUNCE_MS. Editors often save in several steps, truncating, writing and
+ * renaming, and the debounce turns those into one reload of the finished file. The VFS cache entry for the file is
+ * invalidated before the event fires.
+ *
+ * Only files served from directory mounts are watched, archives and memory can't change.
+ */
+
+// Reloads assets when their files change, for development builds
+#define ASSET_HOT_RELOAD_ENABLED 1
+
+#define ASSET_WATCH_DEBOUNCE_MS 100
+#define ASSET_WATCH_MAX 128
+
+//
+// Lifecycle
+//
+
+void asset_watch_init(void);
+
+void asset_watch_shutdown(void);
+
+// Polls for changes and fires the events of files that settled. Called once per frame by the engine.
+void asset_watch_update(void);
+
+//
+// Files
+//
+
+// Watching the same path again counts a reference, each needs an asset_watch_remove
+export b8 asset_watch_add(const char* path);
+
+export void asset_watch_remove(const char* path);
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "core/types.h"
+
+/**
+ * Atomic operations with C11 memory ordering, on plain integer and pointer fields.
+ *
+ * These wrap the compiler's __atomic builtins rather than stdatomic.h, so a field does not need an _Atomic type to be
+ * used atomically and structs stay layout compatible across the engine and app. Every access to a shared field should
+ * go through these once any thread writes to it.
+ */
+
+typedef enum Memory_Order {
+	MEMORY_ORDER_RELAXED = __ATOMIC_RELAXED,
+	MEMORY_ORDER_ACQUIRE = __ATOMIC_ACQUIRE,
+	MEMORY_ORDER_RELEASE = __ATOMIC_RELEASE,
+	MEMORY_ORDER_ACQ_REL = __ATOMIC_ACQ_REL,
+	MEMORY_ORDER_SEQ_CST = __ATOMIC_SEQ_CST,
+} Memory_Order;
+
+//
+// u32
+//
+
+static inline u32 atomic_load_u32(const u32* value, Memory_Order order) {
+	return __atomic_load_n(value, order);
+}
+
+static inline void atomic_store_u32(u32* value, u32 desired, Memory_Order order) {
+	__atomic_store_n(value, desired, order);
+}
+
+static inline u32 atomic_exchange_u32(u32* value, u32 desired, Memory_Order order) {
+	return __atomic_exchange_n(value, desired, order);
+}
+
+// On failure expected is updated to the current value
+static inline b8 atomic_compare_exchange_u32(u32* value, u32* expected, u32 desired, Memory_Order success, Memory_Order failure) {
+	return __atomic_compare_exchange_n(value, expected, desired, false, success, failure);
+}
+
+// The fetch operations return the value from before the operation
+static inline u32 atomic_fetch_add_u32(u32* value, u32 operand, Memory_Order order) {
+	return __atomic_fetch_add(value, operand, order);
+}
+
+static inline u32 atomic_fetch_sub_u32(u32* value, u32 operand, Memory_Order order) {
+	return __atomic_fetch_sub(value, operand, order);
+}
+
+static inline u32 atomic_fetch_or_u32(u32* value, u32 operand, Memory_Order order) {
+	return __atomic_fetch_or(value, operand, order);
+}
+
+static inline u32 atomic_fetch_and_u32(u32* value, u32 operand, Memory_Order order) {
+	return __atomic_fetch_and(value, operand, order);
+}
+
+//
+// u64
+//
+
+static inline u64 atomic_load_u64(const u64* value, Memory_Order order) {
+	return __atomic_load_n(value, order);
+}
+
+static inline void atomic_store_u64(u64* value, u64 desired, Memory_Order order) {
+	__atomic_store_n(value, desired, order);
+}
+
+static inline u64 atomic_exchange_u64(u64* value, u64 desired, Memory_Order order) {
+	return __atomic_exchange_n(value, desired, order);
+}
+
+static inline b8 atomic_compare_exchange_u64(u64* value, u64* expected, u64 desired, Memory_Order success, Memory_Order failure) {
+	return __atomic_compare_exchange_n(value, expected, desired, false, success, failure);
+}
+
+static inline u64 atomic_fetch_add_u64(u64* value, u64 operand, Memory_Order order) {
+	return __atomic_fetch_add(value, operand, order);
+}
+
+static inline u64 atomic_fetch_sub_u64(u64* value, u64 operand, Memory_Order order) {
+	return __atomic_fetch_sub(value, operand, order);
+}
+
+static inline u64 atomic_fetch_or_u64(u64* value, u64 operand, Memory_Order order) {
+	return __atomic_fetch_or(value, operand, order);
+}
+
+static inline u64 atomic_fetch_and_u64(u64* value, u64 operand, Memory_Order order) {
+	return __atomic_fetch_and(value, operand, order);
+}
+
+//
+// Pointers
+//
+
+static inline void* atomic_load_ptr(void* const* value, Memory_Order order) {
+	return __atomic_load_n(value, order);
+}
+
+static inline void atomic_store_ptr(void** value, void* desired, Memory_Order order) {
+	__atomic_store_n(value, desired, order);
+}
+
+static inline void* atomic_exchange_ptr(void** value, void* desired, Memory_Order order) {
+	return __atomic_exchange_n(value, desired, order);
+}
+
+static inline b8 atomic_compare_exchange_ptr(void** value, void** expected, void* desired, Memory_Order success, Memory_Order failure) {
+	return __atomic_compare_exchange_n(value, expected, desired, false, success, failure);
+}
+
+//
+// Fences and hints
+//
+
+static inline void atomic_fence(Memory_Order order) {
+	__atomic_thread_fence(order);
+}
+
+// Tells the CPU it is in a spin wait loop, which saves power and frees the core for a sibling hyperthread
+static inline void cpu_pause(void) {
+#if defined(__x86_64__) || defined(_M_X64)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__)
+	__asm__ volatile("yield");
+#endif
+}
@@ -1,76 +1,248 @@
 #include "core/event.h"
 
+#include "core/event_record.h"
 #include "core/log.h"
 #include "core/memory.h"
+#include "platform/platform.h"
 
 #define EVENT_CODE_MAX EVENT_TYPE_MAX
 #define EVENT_CODE_ENTRY_MAX 512
+#define EVENT_HANDLE_MAX 4096
+#define EVENT_SLOT_NONE 0xFFFF
+
+static_assert(EVENT_HANDLE_MAX < EVENT_SLOT_NONE, "Expected handle slots to fit in 16 bits");
 
 typedef struct Registered_Event {
 	void* listener;
+	// Null once unregistered, until the entry is compacted
 	On_Event on_event;
+	i32 priority;
+	u16 slot;
 } Registered_Event;
 
 typedef struct Event_Code_Entry {
 	// TODO: Use a dynamic_array
 	Registered_Event events[EVENT_CODE_ENTRY_MAX];
 	u32 event_count;
+	u32 dead_count;
+	u32 fire_depth;
+	// Events registered during a fire, appended unsorted at the end until the fire is done
+	u32 pending_count;
 } Event_Code_Entry;
 
+// Maps a handle to the current position of its registration in the dense, priority sorted events array.
+typedef struct Event_Handle_Slot {
+	u16 generation;
+	u16 code;
+	u16 index;
+	// Free list link, stored as slot + 1 so zero means end of list
+	u16 next_free;
+} Event_Handle_Slot;
+
+#if EVENT_STATS_ENABLED
+typedef struct Event_Counters {
+	u64 fire_count;
+	u64 handler_calls;
+	u64 handled_count;
+	u64 handler_time;
+} Event_Counters;
+
+typedef struct Event_Stats_State {
+	Event_Counters frame[EVENT_CODE_MAX];
+	Event_Counters last_frame[EVENT_CODE_MAX];
+	Event_Counters total[EVENT_CODE_MAX];
+	u64 frame_number;
+} Event_Stats_State;
+
+static Event_Stats_State stats = {0};
+#endif
+
 typedef struct Event_System {
 	Event_Code_Entry entries[EVENT_CODE_MAX];
-	u32 entry_count;
+	Event_Handle_Slot slots[EVENT_HANDLE_MAX];
+	u32 slot_count;
+	u32 free_slot;
+	u32 fire_depth;
 } Event_System;
 
 static Event_System event_system = {0};
 
-b8 event_register(Event_Code code, void* listener, On_Event on_event) {
+static Event_Handle make_handle(u32 slot) {
+	return ((Event_Handle)event_system.slots[slot].generation << 16) | (slot + 1);
+}
+
+static b8 alloc_slot(u32* out_slot) {
+	if (event_system.free_slot) {
+		*out_slot = event_system.free_slot - 1;
+		event_system.free_slot = event_system.slots[*out_slot].next_free;
+		return true;
+	}
+
+	if (event_system.slot_count >= EVENT_HANDLE_MAX) {
+		return false;
+	}
+
+	*out_slot = event_system.slot_count++;
+	return true;
+}
+
+static void free_slot(u32 slot) {
+	Event_Handle_Slot* handle_slot = &event_system.slots[slot];
+	// Invalidate any outstanding copies of the handle
+	handle_slot->generation++;
+	handle_slot->next_free = event_system.free_slot;
+	event_system.free_slot = slot + 1;
+}
+
+static void move_event(Event_Code_Entry* entry, u32 from, u32 to) {
+	Registered_Event* event = &entry->events[to];
+	*event = entry->events[from];
+	if (event->slot != EVENT_SLOT_NONE) {
+		event_system.slots[event->slot].index = to;
+	}
+}
+
+// Removes unregistered events while preserving dispatch order
+static void compact_entry(Event_Code_Entry* entry) {
+	u32 count = 0;
+	for (u32 i = 0; i < entry->event_count; i++) {
+		if (!entry->events[i].on_event) {
+			continue;
+		}
+		if (i != count) {
+			move_event(entry, i, count);
+		}
+		count++;
+	}
+	entry->event_count = count;
+	entry->dead_count = 0;
+}
+
+// Sorts events registered during a fire into place, in registration order
+static void insert_pending(Event_Code_Entry* entry) {
+	for (u32 i = entry->event_count - entry->pending_count; i < entry->event_count; i++) {
+		Registered_Event pending = entry->events[i];
+		u32 index = i;
+		while (index > 0 && entry->events[index - 1].priority < pending.priority) {
+			move_event(entry, index - 1, index);
+			index--;
+		}
+		entry->events[index] = pending;
+		if (pending.slot != EVENT_SLOT_NONE) {
+			event_system.slots[pending.slot].index = index;
+		}
+	}
+	entry->pending_count = 0;
+}
+
+static void collect_entry(Event_Code_Entry* entry) {
+	if (entry->fire_depth > 0) {
+		return;
+	}
+
+	if (entry->pending_count > 0) {
+		insert_pending(entry);
+	}
+
+	if (entry->dead_count == 0) {
+		return;
+	}
+
+	// Dropping dead events off the end is free, which covers the common LIFO unregister
+	while (entry->event_count > 0 && !entry->events[entry->event_count - 1].on_event) {
+		entry->event_count--;
+		entry->dead_count--;
+	}
+
+	// Only pay for a full compaction once half of the array is dead, so unregister stays amortized O(1)
+	if (entry->dead_count * 2 > entry->event_count) {
+		compact_entry(entry);
+	}
+}
+
+Event_Handle event_register(Event_Code code, void* listener, On_Event on_event) {
+	return event_register_priority(code, EVENT_PRIORITY_DEFAULT, listener, on_event);
+}
+
+Event_Handle event_register_priority(Event_Code code, i32 priority, void* listener, On_Event on_event) {
 	if (code >= EVENT_CODE_MAX) {
 		log_error("Event code %d is out of range", code);
-		return false;
+		return EVENT_HANDLE_INVALID;
+	}
+
+	if (!on_event) {
+		log_error("Event code %d registered without a callback", code);
+		return EVENT_HANDLE_INVALID;
 	}
 
 	Event_Code_Entry* entry = &event_system.entries[code];
+	if (entry->event_count >= EVENT_CODE_ENTRY_MAX && entry->fire_depth == 0) {
+		compact_entry(entry);
+	}
 	if (entry->event_count >= EVENT_CODE_ENTRY_MAX) {
 		log_error("Event code entry %d is full", code);
-		return false;
+		return EVENT_HANDLE_INVALID;
 	}
 
-	for (u32 i = 0; i < entry->event_count; i++) {
-		Registered_Event* event = &entry->events[i];
-		if (event->listener == listener && event->on_event == on_event) {
-			log_error("Event code %d already registered", code);
-			return false;
+	u32 slot;
+	if (!alloc_slot(&slot)) {
+		log_error("Out of event handles registering event code %d", code);
+		return EVENT_HANDLE_INVALID;
+	}
+
+	// Keep the array sorted by descending priority. Registering at the lowest priority, the common case, appends
+	// without moving anything. Mid-fire registrations append and are sorted in once the fire is done, so the events
+	// under the dispatch loop never move.
+	u32 index = entry->event_count;
+	if (entry->fire_depth > 0) {
+		entry->pending_count++;
+	} else {
+		while (index > 0 && entry->events[index - 1].priority < priority) {
+			move_event(entry, index - 1, index);
+			index--;
 		}
 	}
 
-	Registered_Event* event = &entry->events[entry->event_count];
+	Registered_Event* event = &entry->events[index];
 	event->listener = listener;
 	event->on_event = on_event;
+	event->priority = priority;
+	event->slot = slot;
 	entry->event_count++;
 
-	return true;
+	Event_Handle_Slot* handle_slot = &event_system.slots[slot];
+	handle_slot->code = code;
+	handle_slot->index = index;
+	handle_slot->next_free = 0;
+
+	return make_handle(slot);
 }
 
-b8 event_unregister(Event_Code code, void* listener, On_Event on_event) {
-	if (code >= EVENT_CODE_MAX) {
-		log_error("Event code %d is out of range", code);
+b8 event_unregister(Event_Handle handle) {
+	u32 slot = (handle & 0xFFFF) - 1;
+	u16 generation = handle >> 16;
+	if (handle == EVENT_HANDLE_INVALID || slot >= event_system.slot_count) {
+		log_error("Event handle %u is invalid", handle);
 		return false;
 	}
 
-	Event_Code_Entry* entry = &event_system.entries[code];
-	for (u32 i = 0; i < entry->event_count; i++) {
-		Registered_Event* event = &entry->events[i];
-		if (event->listener == listener && event->on_event == on_event) {
-			// TODO: use dynamic_array_unordered_remove
-			entry->events[i] = entry->events[entry->event_count - 1];
-			entry->event_count--;
-			return true;
-		}
+	Event_Handle_Slot* handle_slot = &event_system.slots[slot];
+	if (handle_slot->generation != generation) {
+		// Already unregistered
+		return false;
 	}
 
-	// Not found
-	return false;
+	Event_Code_Entry* entry = &event_system.entries[handle_slot->code];
+	Registered_Event* event = &entry->events[handle_slot->index];
+	event->on_event = null;
+	event->listener = null;
+	event->slot = EVENT_SLOT_NONE;
+	entry->dead_count++;
+	free_slot(slot);
+
+	collect_entry(entry);
+
+	return true;
 }
 
 b8 event_fire(Event_Code code, Event_Context context, void* sender) {
@@ -79,14 +251,122 @@ b8 event_fire(Event_Code code, Event_Context context, void* sender) {
 		return false;
 	}
 
+	// Events fired from inside handlers are reproduced by replaying the outer event, so only record top level events
+	if (event_system.fire_depth == 0) {
+		event_record_capture(code, &context);
+	}
+
 	Event_Code_Entry* entry = &event_system.entries[code];
-	for (u32 i = 0; i < entry->event_count; i++) {
+	// Handlers may unregister themselves or others, so hold off compaction until dispatch is done
+	entry->fire_depth++;
+	event_system.fire_depth++;
+#if EVENT_STATS_ENABLED
+	Event_Counters* counters = &stats.frame[code];
+	counters->fire_count++;
+#if EVENT_STATS_TIMING_ENABLED
+	u64 start_time = platform_get_time_ns();
+#endif
+#endif
+	// Events registered by handlers are not called until the next fire
+	u32 event_count = entry->event_count;
+	for (u32 i = 0; i < event_count; i++) {
 		Registered_Event* registered_event = &entry->events[i];
+		if (!registered_event->on_event) {
+			continue;
+		}
+#if EVENT_STATS_ENABLED
+		counters->handler_calls++;
+#endif
 		b8 handled = registered_event->on_event(code, &context, sender, registered_event->listener);
 		if (handled) {
-			return true;
+#if EVENT_STATS_ENABLED
+			counters->handled_count++;
+#endif
+			break;
 		}
 	}
+#if EVENT_STATS_ENABLED && EVENT_STATS_TIMING_ENABLED
+	// Includes nested fires, which are also counted against their own codes
+	counters->handler_time += platform_get_time_ns() - start_time;
+#endif
+	entry->fire_depth--;
+	event_system.fire_depth--;
+
+	collect_entry(entry);
+
+	return true;
+}
+
+#if EVENT_STATS_ENABLED
+static void add_counters(Event_Counters* dest, const Event_Counters* src) {
+	dest->fire_count += src->fire_count;
+	dest->handler_calls += src->handler_calls;
+	dest->handled_count += src->handled_count;
+	dest->handler_time += src->handler_time;
+}
+
+static b8 get_stats(Event_Code code, const Event_Counters* counters, Event_Stats* out_stats) {
+	if (code >= EVENT_CODE_MAX) {
+		log_error("Event code %d is out of range", code);
+		return false;
+	}
 
+	Event_Code_Entry* entry = &event_system.entries[code];
+	out_stats->fire_count = counters[code].fire_count;
+	out_stats->handler_calls = counters[code].handler_calls;
+	out_stats->handled_count = counters[code].handled_count;
+	out_stats->handler_time = counters[code].handler_time;
+	out_stats->listener_count = entry->event_count - entry->dead_count;
 	return true;
 }
+#endif
+
+void event_stats_end_frame(void) {
+#if EVENT_STATS_ENABLED
+	for (u32 code = 0; code < EVENT_CODE_MAX; code++) {
+		add_counters(&stats.total[code], &stats.frame[code]);
+	}
+	memory_copy(stats.last_frame, stats.frame, sizeof(stats.frame));
+	memory_zero(stats.frame, sizeof(stats.frame));
+	stats.frame_number++;
+#endif
+}
+
+b8 event_get_frame_stats(Event_Code code, Event_Stats* out_stats) {
+#if EVENT_STATS_ENABLED
+	return get_stats(code, stats.last_frame, out_stats);
+#else
+	memory_zero(out_stats, sizeof(Event_Stats));
+	return false;
+#endif
+}
+
+b8 event_get_total_stats(Event_Code code, Event_Stats* out_stats) {
+#if EVENT_STATS_ENABLED
+	return get_stats(code, stats.total, out_stats);
+#else
+	memory_zero(out_stats, sizeof(Event_Stats));
+	return false;
+#endif
+}
+
+void event_report_frame_stats(void) {
+#if EVENT_STATS_ENABLED
+	log_debug("Event stats for frame %llu", stats.frame_number);
+	for (u32 code = 0; code < EVENT_CODE_MAX; code++) {
+		Event_Stats frame_stats;
+		get_stats(code, stats.last_frame, &frame_stats);
+		if (frame_stats.fire_count == 0) {
+			continue;
+		}
+		log_debug(
+			"  code %3u: fired %llu, calls %llu, handled %llu, listeners %u, time %.3f us",
+			code,
+			frame_stats.fire_count,
+			frame_stats.handler_calls,
+			frame_stats.handled_count,
+			frame_stats.listener_count,
+			(f64)frame_stats.handler_time / 1000.0);
+	}
+#endif
+}
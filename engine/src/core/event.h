@@ -2,6 +2,12 @@
 
 #include "core/types.h"
 
+// Counts fires and handler calls per code. Closing each frame copies and clears the counters of every code, so it is
+// off unless profiling.
+#define EVENT_STATS_ENABLED        0
+// Times every dispatch, which costs two clock reads per event_fire
+#define EVENT_STATS_TIMING_ENABLED 0
+
 typedef enum Event_Type {
 	// Engine events
 	EVENT_TYPE_APP_QUIT, // ()
@@ -13,6 +19,9 @@ typedef enum Event_Type {
 	EVENT_TYPE_MOUSE_WHEEL, // (i32 y)
 	EVENT_TYPE_MOUSE_BUTTON_PRESS, // (i32 button)
 	EVENT_TYPE_MOUSE_BUTTON_RELEASE, // (i32 button)
+	EVENT_TYPE_ASSET_CHANGED, // (), sender is the virtual path as a const char*
+	EVENT_TYPE_APP_SUSPEND, // (), the window was minimized or hidden and frames stop rendering, see ENGINE_SUSPEND_UNFOCUSED
+	EVENT_TYPE_APP_RESUME, // ()
 	// Begin custom application events
 	EVENT_TYPE_CUSTOM = 256,
 	// End custom application events
@@ -29,8 +38,44 @@ typedef union Event_Context {
 
 typedef b8 (*On_Event)(Event_Code code, Event_Context* context, void* sender, void* listener);
 
-export b8 event_register(Event_Code code, void* listener, On_Event on_event);
+typedef struct Event_Stats {
+	u64 fire_count;
+	u64 handler_calls;
+	// Fires stopped early by a handler returning true
+	u64 handled_count;
+	// Nanoseconds spent dispatching to handlers, zero unless EVENT_STATS_TIMING_ENABLED
+	u64 handler_time;
+	u32 listener_count;
+} Event_Stats;
+
+// Identifies a single registration. Zero is never a valid handle.
+typedef u32 Event_Handle;
+
+#define EVENT_HANDLE_INVALID 0
+
+// Listeners with a higher priority are called first. Equal priorities are called in registration order.
+#define EVENT_PRIORITY_DEFAULT 0
+
+export Event_Handle event_register(Event_Code code, void* listener, On_Event on_event);
+
+export Event_Handle event_register_priority(Event_Code code, i32 priority, void* listener, On_Event on_event);
 
-export b8 event_unregister(Event_Code code, void* listener, On_Event on_event);
+export b8 event_unregister(Event_Handle handle);
 
 export b8 event_fire(Event_Code code, Event_Context context, void* sender);
+
+//
+// Stats
+//
+
+// Closes the current stats frame. Called once per frame by the engine.
+void event_stats_end_frame(void);
+
+// Gets the stats for the last completed frame.
+export b8 event_get_frame_stats(Event_Code code, Event_Stats* out_stats);
+
+// Gets the stats accumulated since startup.
+export b8 event_get_total_stats(Event_Code code, Event_Stats* out_stats);
+
+// Logs the stats of every event code fired during the last completed frame.
+export void event_report_frame_stats(void);
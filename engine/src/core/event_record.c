@@ -0,0 +1,280 @@
+#include "core/event_record.h"
+
+#include "core/input.h"
+#include "core/log.h"
+#include "core/memory.h"
+
+#include <stdio.h>
+
+static_assert(sizeof(Event_Record) == 32, "Expected Event_Record to be 32 bytes");
+
+typedef struct Event_Recorder {
+	Platform* platform;
+	u32 frame;
+	b8 capturing;
+
+	// Recording
+	FILE* file;
+	u64 start_time;
+	u64 record_count;
+
+	// Replay
+	Event_Record* records;
+	u64 replay_size;
+	u64 replay_count;
+	u64 replay_cursor;
+	u64 replay_start_time;
+	b8 replaying;
+} Event_Recorder;
+
+static Event_Recorder recorder = {0};
+
+void event_record_init(Platform* platform) {
+	recorder.platform = platform;
+}
+
+void event_record_shutdown(void) {
+	event_record_stop();
+	event_replay_stop();
+}
+
+// Feeds a recorded input change through the same path the platform uses, so key state, the input buffer and actions
+// are rebuilt exactly as they were
+static void replay_input(const Event_Record* record) {
+	Input_Event_Type type = (Input_Event_Type)(record->context.vals[0] & 0xFF);
+	b8 pressed = (record->context.vals[0] >> 8) & 1;
+	i32 code = record->context.vals[1];
+	i32 x = record->context.vals[2];
+	i32 y = record->context.vals[3];
+	u64 time = recorder.replay_start_time + record->time;
+
+	switch (type) {
+		case INPUT_EVENT_TYPE_KEY:
+			input_process_key((Key)code, pressed, time);
+			break;
+		case INPUT_EVENT_TYPE_MOUSE_BUTTON:
+			input_process_mouse_button((Mouse_Button)code, pressed, time);
+			break;
+		case INPUT_EVENT_TYPE_MOUSE_WHEEL:
+			input_process_mouse_wheel(y, time);
+			break;
+		case INPUT_EVENT_TYPE_MOUSE_MOVE:
+			input_process_mouse_position(x, y, time);
+			break;
+		case INPUT_EVENT_TYPE_MOUSE_DELTA:
+			input_process_mouse_delta(x, y, time);
+			break;
+		default:
+			log_warn("Skipping replayed input of unknown type %d", type);
+			break;
+	}
+}
+
+b8 event_record_begin_frame(void) {
+	if (!recorder.replaying) {
+		recorder.capturing = recorder.file != null;
+		return true;
+	}
+
+	while (recorder.replay_cursor < recorder.replay_count) {
+		Event_Record* record = &recorder.records[recorder.replay_cursor];
+		if (record->frame != recorder.frame) {
+			break;
+		}
+		recorder.replay_cursor++;
+
+		if (record->code == EVENT_RECORD_CODE_END) {
+			log_info("Event replay finished after %u frames", recorder.frame);
+			event_replay_stop();
+			return false;
+		}
+		if (record->code == EVENT_RECORD_CODE_INPUT) {
+			replay_input(record);
+		} else {
+			event_fire(record->code, record->context, null);
+		}
+	}
+
+	if (recorder.replay_cursor >= recorder.replay_count) {
+		log_warn("Event replay ended without an end marker after %u frames", recorder.frame);
+		event_replay_stop();
+		return false;
+	}
+
+	return true;
+}
+
+void event_record_end_frame(void) {
+	recorder.capturing = false;
+	recorder.frame++;
+}
+
+static b8 write_record(Event_Code code, u64 time, const Event_Context* context) {
+	Event_Record record = {0};
+	record.frame = recorder.frame;
+	record.code = code;
+	record.time = time > recorder.start_time ? time - recorder.start_time : 0;
+	if (context) {
+		record.context = *context;
+	}
+
+	if (fwrite(&record, sizeof(record), 1, recorder.file) != 1) {
+		log_error("Failed to write event record, stopping recording");
+		fclose(recorder.file);
+		recorder.file = null;
+		recorder.capturing = false;
+		return false;
+	}
+
+	recorder.record_count++;
+	return true;
+}
+
+void event_record_capture(Event_Code code, const Event_Context* context) {
+	if (!recorder.capturing) {
+		return;
+	}
+
+	write_record(code, platform_get_time_ns(), context);
+}
+
+void event_record_capture_input(const Input_Event* event) {
+	if (!recorder.capturing) {
+		return;
+	}
+
+	Event_Context context = { (i32)event->type | ((i32)event->pressed << 8), event->code, event->x, event->y };
+	write_record(EVENT_RECORD_CODE_INPUT, event->time, &context);
+}
+
+b8 event_record_start(const char* path) {
+	if (recorder.file) {
+		log_error("Event recording already in progress");
+		return false;
+	}
+	if (recorder.replaying) {
+		log_error("Cannot record events during a replay");
+		return false;
+	}
+
+	recorder.file = fopen(path, "wb");
+	if (!recorder.file) {
+		log_error("Failed to open event recording file: %s", path);
+		return false;
+	}
+
+	Event_Record_Header header = {EVENT_RECORD_MAGIC, EVENT_RECORD_VERSION};
+	if (fwrite(&header, sizeof(header), 1, recorder.file) != 1) {
+		log_error("Failed to write event recording header: %s", path);
+		fclose(recorder.file);
+		recorder.file = null;
+		return false;
+	}
+
+	recorder.frame = 0;
+	recorder.record_count = 0;
+	recorder.start_time = platform_get_time_ns();
+
+	log_info("Recording events to %s", path);
+	return true;
+}
+
+void event_record_stop(void) {
+	if (!recorder.file) {
+		return;
+	}
+
+	u64 count = recorder.record_count;
+	if (write_record(EVENT_RECORD_CODE_END, platform_get_time_ns(), null)) {
+		fclose(recorder.file);
+		recorder.file = null;
+	}
+	recorder.capturing = false;
+
+	log_info("Recorded %llu events over %u frames", count, recorder.frame);
+}
+
+b8 event_record_is_active(void) {
+	return recorder.file != null;
+}
+
+b8 event_replay_start(const char* path) {
+	if (recorder.replaying) {
+		log_error("Event replay already in progress");
+		return false;
+	}
+	if (recorder.file) {
+		log_error("Cannot replay events during a recording");
+		return false;
+	}
+
+	FILE* file = fopen(path, "rb");
+	if (!file) {
+		log_error("Failed to open event replay file: %s", path);
+		return false;
+	}
+
+	Event_Record_Header header;
+	if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != EVENT_RECORD_MAGIC) {
+		log_error("Invalid event replay file: %s", path);
+		fclose(file);
+		return false;
+	}
+	if (header.version != EVENT_RECORD_VERSION) {
+		log_error("Unsupported event replay version %u: %s", header.version, path);
+		fclose(file);
+		return false;
+	}
+
+	// Load the whole stream up front so the replay does no file I/O mid-frame
+	long end = fseek(file, 0, SEEK_END) == 0 ? ftell(file) : -1;
+	if (end < (long)sizeof(header) || fseek(file, sizeof(header), SEEK_SET) != 0) {
+		log_error("Failed to size event replay file: %s", path);
+		fclose(file);
+		return false;
+	}
+
+	u64 count = ((u64)end - sizeof(header)) / sizeof(Event_Record);
+	if (count == 0) {
+		log_error("Event replay file holds no frames: %s", path);
+		fclose(file);
+		return false;
+	}
+	u64 replay_size = count * sizeof(Event_Record);
+	Event_Record* records = memory_alloc(replay_size, MEMORY_TAG_ENGINE);
+	if (fread(records, sizeof(Event_Record), count, file) != count) {
+		log_error("Failed to read event replay file: %s", path);
+		memory_free(records, replay_size, MEMORY_TAG_ENGINE);
+		fclose(file);
+		return false;
+	}
+	fclose(file);
+
+	recorder.records = records;
+	recorder.replay_size = replay_size;
+	recorder.replay_count = count;
+	recorder.replay_cursor = 0;
+	recorder.replay_start_time = platform_get_time_ns();
+	recorder.frame = 0;
+	recorder.replaying = true;
+
+	log_info("Replaying %llu events from %s", count, path);
+	return true;
+}
+
+void event_replay_stop(void) {
+	if (!recorder.replaying) {
+		return;
+	}
+
+	memory_free(recorder.records, recorder.replay_size, MEMORY_TAG_ENGINE);
+	recorder.records = null;
+	recorder.replay_size = 0;
+	recorder.replay_count = 0;
+	recorder.replay_cursor = 0;
+	recorder.replaying = false;
+}
+
+b8 event_replay_is_active(void) {
+	return recorder.replaying;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "core/event.h"
+#include "core/input.h"
+#include "platform/platform.h"
+
+/**
+ * Records the input the platform feeds the input system each frame, and the events the platform fires, to a binary
+ * file. Replays them back frame by frame in place of the platform so the same session can be run deterministically
+ * across engine builds.
+ *
+ * Recorded input goes back through input_process_*, so key state, the input buffer and actions are rebuilt and the
+ * input system fires its events as it did live. Only top level events fired while the engine is pumping are recorded.
+ * Events fired from inside handlers, or by the app itself, are reproduced by the replay and are not stored.
+ */
+
+#define EVENT_RECORD_MAGIC   0x52564548 // "HEVR"
+#define EVENT_RECORD_VERSION 2
+
+// Marks the final frame of a recording, so a replay runs for as many frames as were recorded.
+#define EVENT_RECORD_CODE_END 0xFFFFFFFF
+// An Input_Event, stored in the context as { type | pressed << 8, code, x, y }
+#define EVENT_RECORD_CODE_INPUT 0xFFFFFFFE
+
+typedef struct Event_Record_Header {
+	u32 magic;
+	u32 version;
+} Event_Record_Header;
+
+typedef struct Event_Record {
+	u32 frame;
+	Event_Code code;
+	// Nanoseconds since recording started. For input, when the platform received it.
+	u64 time;
+	Event_Context context;
+} Event_Record;
+
+//
+// Lifecycle
+//
+
+void event_record_init(Platform* platform);
+
+void event_record_shutdown(void);
+
+// Opens the frame for capture. During a replay this fires the frame's recorded events instead.
+// Returns false once a replay has run out of frames.
+b8 event_record_begin_frame(void);
+
+void event_record_end_frame(void);
+
+void event_record_capture(Event_Code code, const Event_Context* context);
+
+void event_record_capture_input(const Input_Event* event);
+
+//
+// Recording
+//
+
+export b8 event_record_start(const char* path);
+
+export void event_record_stop(void);
+
+export b8 event_record_is_active(void);
+
+//
+// Replay
+//
+
+export b8 event_replay_start(const char* path);
+
+export void event_replay_stop(void);
+
+export b8 event_replay_is_active(void);
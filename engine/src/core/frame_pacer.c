@@ -0,0 +1,126 @@
+#include "core/frame_pacer.h"
+
+#include "core/log.h"
+#include "platform/platform.h"
+
+#include <math.h>
+
+typedef struct Frame_Pacer {
+	f32 target_frame_rate;
+	// Zero when unlimited
+	u64 interval_ns;
+	u64 spin_ns;
+	// Zero until the first frame after the target changes
+	u64 next_deadline;
+	u64 prev_frame_start;
+
+	// Interval stats, with the variance kept as a running sum of squares
+	u64 frame_count;
+	u64 missed_count;
+	f64 mean;
+	f64 sum_squares;
+	f64 min;
+	f64 max;
+} Frame_Pacer;
+
+static Frame_Pacer pacer = {0};
+
+void frame_pacer_init(f32 target_frame_rate) {
+	pacer.spin_ns = FRAME_PACER_DEFAULT_SPIN_NS;
+	frame_pacer_set_target_frame_rate(target_frame_rate);
+	frame_pacer_reset_stats();
+}
+
+static void record_interval(u64 frame_start) {
+	if (pacer.prev_frame_start) {
+		f64 interval = (f64)(frame_start - pacer.prev_frame_start) / 1000000.0;
+		pacer.frame_count++;
+		f64 delta = interval - pacer.mean;
+		pacer.mean += delta / (f64)pacer.frame_count;
+		pacer.sum_squares += delta * (interval - pacer.mean);
+		pacer.min = pacer.frame_count == 1 || interval < pacer.min ? interval : pacer.min;
+		pacer.max = interval > pacer.max ? interval : pacer.max;
+	}
+	pacer.prev_frame_start = frame_start;
+}
+
+void frame_pacer_wait(void) {
+	u64 now = platform_get_time_ns();
+
+	if (pacer.interval_ns) {
+		if (!pacer.next_deadline) {
+			pacer.next_deadline = now;
+		}
+
+		if (now > pacer.next_deadline) {
+			pacer.missed_count++;
+			// More than a whole frame behind, start a new schedule instead of rushing frames out to catch up
+			if (now - pacer.next_deadline >= pacer.interval_ns) {
+				pacer.next_deadline = now;
+			}
+		} else {
+			platform_sleep_until_ns(pacer.next_deadline, pacer.spin_ns);
+			now = platform_get_time_ns();
+		}
+
+		pacer.next_deadline += pacer.interval_ns;
+	}
+
+	record_interval(now);
+}
+
+void frame_pacer_set_target_frame_rate(f32 target_frame_rate) {
+	if (target_frame_rate < 0.0f) {
+		log_error("Invalid target frame rate %f", target_frame_rate);
+		return;
+	}
+
+	pacer.target_frame_rate = target_frame_rate;
+	pacer.interval_ns = target_frame_rate > 0.0f ? (u64)(1000000000.0 / (f64)target_frame_rate) : 0;
+	pacer.next_deadline = 0;
+}
+
+f32 frame_pacer_get_target_frame_rate(void) {
+	return pacer.target_frame_rate;
+}
+
+void frame_pacer_set_spin_ns(u64 spin_ns) {
+	pacer.spin_ns = spin_ns;
+}
+
+void frame_pacer_get_stats(Frame_Pacer_Stats* out_stats) {
+	out_stats->frame_count = pacer.frame_count;
+	out_stats->missed_count = pacer.missed_count;
+	out_stats->mean_interval = pacer.mean;
+	out_stats->min_interval = pacer.min;
+	out_stats->max_interval = pacer.max;
+	out_stats->jitter = pacer.frame_count > 1 ? sqrt(pacer.sum_squares / (f64)(pacer.frame_count - 1)) : 0.0;
+}
+
+void frame_pacer_reset_stats(void) {
+	pacer.frame_count = 0;
+	pacer.missed_count = 0;
+	pacer.mean = 0.0;
+	pacer.sum_squares = 0.0;
+	pacer.min = 0.0;
+	pacer.max = 0.0;
+}
+
+void frame_pacer_report_stats(void) {
+	Frame_Pacer_Stats stats;
+	frame_pacer_get_stats(&stats);
+
+	if (pacer.interval_ns) {
+		log_info("Frame pacing at %.1f fps (%.3f ms)", pacer.target_frame_rate, (f64)pacer.interval_ns / 1000000.0);
+	} else {
+		log_info("Frame pacing unlimited");
+	}
+	log_info(
+		"%llu frames, %llu missed, interval mean %.3f ms, min %.3f ms, max %.3f ms, jitter %.3f ms",
+		stats.frame_count,
+		stats.missed_count,
+		stats.mean_interval,
+		stats.min_interval,
+		stats.max_interval,
+		stats.jitter);
+}
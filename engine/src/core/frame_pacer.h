@@ -0,0 +1,56 @@
+#pragma once
+
+#include "core/export.h"
+#include "core/types.h"
+
+/**
+ * Limits the main loop to a target frame rate. Frames are scheduled against absolute deadlines so an early or late
+ * frame does not shift every frame after it, and the interval between frames is tracked to measure jitter.
+ */
+
+// Time spun at the end of each wait instead of sleeping, covering the scheduler's wake up latency
+#define FRAME_PACER_DEFAULT_SPIN_NS 1000000ull
+
+typedef struct Frame_Pacer_Stats {
+	u64 frame_count;
+	// Frames that finished after their deadline
+	u64 missed_count;
+	// Intervals between frame starts, in milliseconds
+	f64 mean_interval;
+	f64 min_interval;
+	f64 max_interval;
+	// Standard deviation of the interval
+	f64 jitter;
+} Frame_Pacer_Stats;
+
+//
+// Lifecycle
+//
+
+// A target frame rate of zero leaves the loop unlimited
+void frame_pacer_init(f32 target_frame_rate);
+
+// Waits for the next frame's deadline. Called by the engine at the start of every frame.
+void frame_pacer_wait(void);
+
+//
+// Settings
+//
+
+export void frame_pacer_set_target_frame_rate(f32 target_frame_rate);
+
+export f32 frame_pacer_get_target_frame_rate(void);
+
+// Higher values trade CPU time for more consistent intervals
+export void frame_pacer_set_spin_ns(u64 spin_ns);
+
+//
+// Stats
+//
+
+// Gets the interval stats since startup or the last reset.
+export void frame_pacer_get_stats(Frame_Pacer_Stats* out_stats);
+
+export void frame_pacer_reset_stats(void);
+
+export void frame_pacer_report_stats(void);
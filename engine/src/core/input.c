@@ -1,12 +1,18 @@
 #include "core/input.h"
 
-#include "core/memory.h"
 #include "core/event.h"
+#include "core/event_record.h"
+#include "core/log.h"
+
+static_assert(MOUSE_BUTTON_COUNT <= 32, "Expected mouse buttons to fit in a u32 mask");
 
 typedef struct Key_State {
-	b8 pressed[KEY_COUNT];
-	b8 released[KEY_COUNT];
-	b8 down[KEY_COUNT];
+	u64 pressed[KEY_WORD_COUNT];
+	u64 released[KEY_WORD_COUNT];
+	u64 down[KEY_WORD_COUNT];
+	// Keys pressed or released this frame, in the order they changed
+	u16 changed[KEY_COUNT];
+	u32 changed_count;
 } Key_State;
 
 typedef struct Mouse_Position {
@@ -17,26 +23,79 @@ typedef struct Mouse_Position {
 } Mouse_Position;
 
 typedef struct Mouse_State {
-	b8 pressed[MOUSE_BUTTON_COUNT];
-	b8 released[MOUSE_BUTTON_COUNT];
-	b8 down[MOUSE_BUTTON_COUNT];
+	u32 pressed;
+	u32 released;
+	u32 down;
 	i32 wheel;
 	Mouse_Position position;
+	i32 raw_x;
+	i32 raw_y;
+	b8 has_raw;
+	// Sampled right before render
+	i32 latched_x;
+	i32 latched_y;
+	i32 latched_raw_x;
+	i32 latched_raw_y;
 } Mouse_State;
 
+typedef struct Input_Buffer {
+	Input_Event events[INPUT_EVENT_MAX];
+	u32 count;
+	u32 dropped;
+} Input_Buffer;
+
 typedef struct Input_System {
 	Key_State key;
 	Mouse_State mouse;
+	Input_Buffer buffer;
 } Input_System;
 
 static Input_System input_system = {0};
 
+static inline b8 key_bit(const u64* bits, Key key) {
+	return (bits[key >> 6] >> (key & 63)) & 1;
+}
+
+static inline void set_key_bit(u64* bits, Key key, b8 value) {
+	u64 mask = 1ull << (key & 63);
+	bits[key >> 6] = value ? bits[key >> 6] | mask : bits[key >> 6] & ~mask;
+}
+
+static inline b8 button_bit(u32 bits, Mouse_Button button) {
+	return (bits >> button) & 1;
+}
+
+static inline u32 set_button_bit(u32 bits, Mouse_Button button, b8 value) {
+	return value ? bits | (1u << button) : bits & ~(1u << button);
+}
+
+static void push_event(Input_Event_Type type, i32 code, i32 x, i32 y, b8 pressed, u64 time) {
+	Input_Event event = { time, type, code, x, y, pressed };
+	event_record_capture_input(&event);
+
+	Input_Buffer* buffer = &input_system.buffer;
+	if (buffer->count >= INPUT_EVENT_MAX) {
+		buffer->dropped++;
+		return;
+	}
+	buffer->events[buffer->count++] = event;
+}
+
 static void fire_events(void) {
-	// Fire key events
-	for (u32 key = 0; key < KEY_COUNT; key++) {
-		if (input_system.key.pressed[key]) {
+	// Fire key events, only visiting keys that changed this frame
+	// A key both pressed and released this frame fires both, in the order its final state implies
+	for (u32 i = 0; i < input_system.key.changed_count; i++) {
+		Key key = (Key)input_system.key.changed[i];
+		b8 pressed = key_bit(input_system.key.pressed, key);
+		b8 released = key_bit(input_system.key.released, key);
+		b8 down = key_bit(input_system.key.down, key);
+		if (released && down) {
+			event_fire(EVENT_TYPE_KEY_RELEASE, (Event_Context){ (i32)key }, null);
+		}
+		if (pressed) {
 			event_fire(EVENT_TYPE_KEY_PRESS, (Event_Context){ (i32)key }, null);
-		} else if (input_system.key.released[key]) {
+		}
+		if (released && !down) {
 			event_fire(EVENT_TYPE_KEY_RELEASE, (Event_Context){ (i32)key }, null);
 		}
 	}
@@ -61,28 +120,53 @@ static void fire_events(void) {
 	}
 
 	// Fire button mouse events
-	for (u32 button = 0; button < MOUSE_BUTTON_COUNT; button++) {
-		if (input_system.mouse.pressed[button]) {
+	u32 changed_buttons = input_system.mouse.pressed | input_system.mouse.released;
+	while (changed_buttons) {
+		Mouse_Button button = (Mouse_Button)__builtin_ctz(changed_buttons);
+		changed_buttons &= changed_buttons - 1;
+		b8 pressed = button_bit(input_system.mouse.pressed, button);
+		b8 released = button_bit(input_system.mouse.released, button);
+		b8 down = button_bit(input_system.mouse.down, button);
+		if (released && down) {
+			event_fire(EVENT_TYPE_MOUSE_BUTTON_RELEASE, (Event_Context){ button }, null);
+		}
+		if (pressed) {
 			event_fire(EVENT_TYPE_MOUSE_BUTTON_PRESS, (Event_Context){ button }, null);
-		} else if (input_system.mouse.released[button]) {
+		}
+		if (released && !down) {
 			event_fire(EVENT_TYPE_MOUSE_BUTTON_RELEASE, (Event_Context){ button }, null);
 		}
 	}
 }
 
 static void reset_state(void) {
-	// Reset pressed and released
-	memory_zero(input_system.key.pressed, sizeof(input_system.key.pressed));
-	memory_zero(input_system.key.released, sizeof(input_system.key.released));
-	memory_zero(input_system.mouse.pressed, sizeof(input_system.mouse.pressed));
-	memory_zero(input_system.mouse.released, sizeof(input_system.mouse.released));
+	// Reset pressed and released for the keys that changed
+	for (u32 i = 0; i < input_system.key.changed_count; i++) {
+		Key key = (Key)input_system.key.changed[i];
+		set_key_bit(input_system.key.pressed, key, false);
+		set_key_bit(input_system.key.released, key, false);
+	}
+	input_system.key.changed_count = 0;
+	input_system.mouse.pressed = 0;
+	input_system.mouse.released = 0;
 
 	// Update prev positions
 	input_system.mouse.position.prev_x = input_system.mouse.position.x;
 	input_system.mouse.position.prev_y = input_system.mouse.position.y;
 
-	// Reset wheel
+	// Reset wheel and raw motion
 	input_system.mouse.wheel = 0;
+	input_system.mouse.raw_x = 0;
+	input_system.mouse.raw_y = 0;
+	input_system.mouse.latched_raw_x = 0;
+	input_system.mouse.latched_raw_y = 0;
+
+	// Reset buffered events
+	if (input_system.buffer.dropped > 0) {
+		log_warn("Dropped %u input events, buffer holds %u per frame", input_system.buffer.dropped, INPUT_EVENT_MAX);
+	}
+	input_system.buffer.count = 0;
+	input_system.buffer.dropped = 0;
 }
 
 void input_update(void) {
@@ -90,59 +174,105 @@ void input_update(void) {
 	reset_state();
 }
 
-void input_process_key(Key key, b8 pressed) {
-	if (!input_system.key.down[key]) {
-		input_system.key.pressed[key] = pressed;
+void input_process_key(Key key, b8 pressed, u64 time) {
+	if (key >= KEY_COUNT) {
+		return;
+	}
+
+	push_event(INPUT_EVENT_TYPE_KEY, key, 0, 0, pressed, time);
+
+	Key_State* state = &input_system.key;
+	b8 changed = key_bit(state->pressed, key) || key_bit(state->released, key);
+
+	// Pressed and released stay set for the rest of the frame, so a tap shorter than a frame still shows up
+	b8 was_down = key_bit(state->down, key);
+	if (pressed && !was_down) {
+		set_key_bit(state->pressed, key, true);
+	} else if (!pressed && was_down) {
+		set_key_bit(state->released, key, true);
+	}
+	set_key_bit(state->down, key, pressed);
+
+	// Track the key the first time it changes this frame. Repeats of a held key change nothing.
+	if (!changed && (key_bit(state->pressed, key) || key_bit(state->released, key))) {
+		state->changed[state->changed_count++] = (u16)key;
 	}
-	input_system.key.released[key] = !pressed;
-	input_system.key.down[key] = pressed;
 }
 
-void input_process_mouse_button(Mouse_Button button, b8 pressed) {
-	input_system.mouse.pressed[button] = pressed;
-	input_system.mouse.released[button] = !pressed;
-	input_system.mouse.down[button] = pressed;
+void input_process_mouse_button(Mouse_Button button, b8 pressed, u64 time) {
+	if (button >= MOUSE_BUTTON_COUNT) {
+		return;
+	}
+
+	push_event(INPUT_EVENT_TYPE_MOUSE_BUTTON, button, 0, 0, pressed, time);
+
+	Mouse_State* mouse = &input_system.mouse;
+	b8 was_down = button_bit(mouse->down, button);
+	if (pressed && !was_down) {
+		mouse->pressed = set_button_bit(mouse->pressed, button, true);
+	} else if (!pressed && was_down) {
+		mouse->released = set_button_bit(mouse->released, button, true);
+	}
+	mouse->down = set_button_bit(mouse->down, button, pressed);
 }
 
-void input_process_mouse_wheel(i32 y) {
+void input_process_mouse_wheel(i32 y, u64 time) {
+	push_event(INPUT_EVENT_TYPE_MOUSE_WHEEL, 0, 0, y, false, time);
 	input_system.mouse.wheel = y;
 }
 
-void input_process_mouse_position(i32 x, i32 y) {
+void input_process_mouse_position(i32 x, i32 y, u64 time) {
+	push_event(INPUT_EVENT_TYPE_MOUSE_MOVE, 0, x, y, false, time);
 	input_system.mouse.position.x = x;
 	input_system.mouse.position.y = y;
+	input_system.mouse.latched_x = x;
+	input_system.mouse.latched_y = y;
+}
+
+void input_process_mouse_delta(i32 x, i32 y, u64 time) {
+	push_event(INPUT_EVENT_TYPE_MOUSE_DELTA, 0, x, y, false, time);
+	input_system.mouse.raw_x += x;
+	input_system.mouse.raw_y += y;
+	input_system.mouse.has_raw = true;
+}
+
+void input_process_latch(i32 x, i32 y, i32 raw_x, i32 raw_y) {
+	input_system.mouse.latched_x = x;
+	input_system.mouse.latched_y = y;
+	input_system.mouse.latched_raw_x = raw_x;
+	input_system.mouse.latched_raw_y = raw_y;
 }
 
 b8 input_is_key_pressed(Key key) {
-	return input_system.key.pressed[key];
+	return key_bit(input_system.key.pressed, key);
 }
 
 b8 input_is_key_released(Key key) {
-	return input_system.key.released[key];
+	return key_bit(input_system.key.released, key);
 }
 
 b8 input_is_key_down(Key key) {
-	return input_system.key.down[key];
+	return key_bit(input_system.key.down, key);
 }
 
 b8 input_is_key_up(Key key) {
-	return !input_system.key.down[key];
+	return !key_bit(input_system.key.down, key);
 }
 
 b8 input_is_mouse_button_pressed(Mouse_Button button) {
-	return input_system.mouse.pressed[button];
+	return button_bit(input_system.mouse.pressed, button);
 }
 
 b8 input_is_mouse_button_released(Mouse_Button button) {
-	return input_system.mouse.released[button];
+	return button_bit(input_system.mouse.released, button);
 }
 
 b8 input_is_mouse_button_down(Mouse_Button button) {
-	return input_system.mouse.down[button];
+	return button_bit(input_system.mouse.down, button);
 }
 
 b8 input_is_mouse_button_up(Mouse_Button button) {
-	return !input_system.mouse.down[button];
+	return !button_bit(input_system.mouse.down, button);
 }
 
 i32 input_get_mouse_wheel(void) {
@@ -158,3 +288,43 @@ void input_get_mouse_position_delta(i32* x, i32* y) {
 	*x = input_system.mouse.position.x - input_system.mouse.position.prev_x;
 	*y = input_system.mouse.position.y - input_system.mouse.position.prev_y;
 }
+
+void input_get_mouse_raw_delta(i32* x, i32* y) {
+	*x = input_system.mouse.raw_x;
+	*y = input_system.mouse.raw_y;
+}
+
+void input_get_latched_mouse_position(i32* x, i32* y) {
+	*x = input_system.mouse.latched_x;
+	*y = input_system.mouse.latched_y;
+}
+
+void input_get_latched_mouse_raw_delta(i32* x, i32* y) {
+	*x = input_system.mouse.latched_raw_x;
+	*y = input_system.mouse.latched_raw_y;
+}
+
+b8 input_has_mouse_raw_delta(void) {
+	return input_system.mouse.has_raw;
+}
+
+const u64* input_get_key_down_bits(void) {
+	return input_system.key.down;
+}
+
+u32 input_get_mouse_button_down_bits(void) {
+	return input_system.mouse.down;
+}
+
+const u64* input_get_key_pressed_bits(void) {
+	return input_system.key.pressed;
+}
+
+u32 input_get_mouse_button_pressed_bits(void) {
+	return input_system.mouse.pressed;
+}
+
+const Input_Event* input_get_events(u32* out_count) {
+	*out_count = input_system.buffer.count;
+	return input_system.buffer.events;
+}
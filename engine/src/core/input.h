@@ -133,15 +133,58 @@ typedef enum Mouse_Button {
 	MOUSE_BUTTON_COUNT,
 } Mouse_Button;
 
+typedef enum Input_Event_Type {
+	INPUT_EVENT_TYPE_KEY,
+	INPUT_EVENT_TYPE_MOUSE_BUTTON,
+	INPUT_EVENT_TYPE_MOUSE_WHEEL,
+	INPUT_EVENT_TYPE_MOUSE_MOVE,
+	INPUT_EVENT_TYPE_MOUSE_DELTA,
+} Input_Event_Type;
+
+#define KEY_WORD_COUNT ((KEY_COUNT + 63) / 64)
+
+// A single input change, in the order the platform received it.
+typedef struct Input_Event {
+	// Monotonic nanoseconds, in the same time base as platform_get_time_ns
+	u64 time;
+	Input_Event_Type type;
+	// Key or Mouse_Button
+	i32 code;
+	// Mouse position, raw mouse delta, or the wheel delta in y
+	i32 x;
+	i32 y;
+	b8 pressed;
+} Input_Event;
+
+#define INPUT_EVENT_MAX 512
+
 void input_update(void);
 
-void input_process_key(Key key, b8 pressed);
+void input_process_key(Key key, b8 pressed, u64 time);
+
+void input_process_mouse_button(Mouse_Button button, b8 pressed, u64 time);
+
+void input_process_mouse_wheel(i32 y, u64 time);
+
+void input_process_mouse_position(i32 x, i32 y, u64 time);
+
+// Unaccelerated relative motion, already accumulated by the platform. Called at most once per pump.
+void input_process_mouse_delta(i32 x, i32 y, u64 time);
+
+// Pointer state sampled right before render, including raw motion that arrived after the frame's input was read.
+void input_process_latch(i32 x, i32 y, i32 raw_x, i32 raw_y);
 
-void input_process_mouse_button(Mouse_Button button, b8 pressed);
+// Packed down state, one bit per key, for the action layer
+const u64* input_get_key_down_bits(void);
 
-void input_process_mouse_wheel(i32 y);
+// Packed down state, one bit per mouse button, for the action layer
+u32 input_get_mouse_button_down_bits(void);
 
-void input_process_mouse_position(i32 x, i32 y);
+// Keys that went down at any point this frame, even if they are up again
+const u64* input_get_key_pressed_bits(void);
+
+// Mouse buttons that went down at any point this frame, even if they are up again
+u32 input_get_mouse_button_pressed_bits(void);
 
 export b8 input_is_key_pressed(Key key);
 
@@ -164,3 +207,20 @@ export i32 input_get_mouse_wheel(void);
 export void input_get_mouse_position(i32* x, i32* y);
 
 export void input_get_mouse_position_delta(i32* x, i32* y);
+
+// Gets the unaccelerated, unclamped mouse motion this frame. Zero when the platform has no raw mouse input.
+export void input_get_mouse_raw_delta(i32* x, i32* y);
+
+// Gets the newest mouse position, sampled right before render. Same as input_get_mouse_position unless the platform
+// reads input on its own thread.
+export void input_get_latched_mouse_position(i32* x, i32* y);
+
+// Gets the raw mouse motion that arrived after the frame's input was read, to add on top of input_get_mouse_raw_delta
+// when rendering.
+export void input_get_latched_mouse_raw_delta(i32* x, i32* y);
+
+// True once the platform has delivered raw mouse motion, otherwise fall back to input_get_mouse_position_delta.
+export b8 input_has_mouse_raw_delta(void);
+
+// Gets every input event received this frame, oldest first. Valid until the next engine update.
+export const Input_Event* input_get_events(u32* out_count);
@@ -0,0 +1,667 @@
+#include "core/job.h"
+
+#include "core/atomic.h"
+#include "core/log.h"
+#include "core/memory.h"
+#include "platform/platform.h"
+#include "platform/platform_cpu.h"
+#include "platform/platform_fiber.h"
+#include "platform/platform_thread.h"
+
+#include <stdio.h>
+
+// Must be a power of two
+#define JOB_DEQUE_CAPACITY JOB_POOL_SIZE
+// Ranges per worker picked by job_parallel_for, enough to even out uneven ranges without much scheduling overhead
+#define JOB_RANGES_PER_WORKER 4
+// Attempts to find a job before an idle worker goes to sleep
+#define JOB_SPIN_COUNT 64
+#define CACHE_LINE_SIZE 64
+// Fibers shared by all workers. Each worker holds one while it runs jobs and every waiting job holds its own, so this
+// bounds how many jobs can be waiting at once. Beyond that job_wait runs other jobs on the waiting stack instead.
+#define JOB_FIBER_COUNT 128
+// Jobs run arbitrary engine code on these stacks, and a log call alone has taken over 64 KiB of formatting buffers.
+// Stacks are only committed as they are touched, so the headroom mostly costs address space.
+#define JOB_FIBER_STACK_SIZE kib(256)
+
+static_assert(JOB_FIBER_COUNT > JOB_WORKER_MAX, "Expected a fiber for every worker and some to wait with");
+
+typedef struct Job {
+	Job_Function function;
+	Job_Range_Function range_function;
+	void* data;
+	u32 begin;
+	u32 end;
+	Job_Counter* counter;
+	// Set while the job is queued, cleared by whichever worker takes it once it has read the job
+	u32 queued;
+} Job;
+
+// Chase-Lev deque with a fixed capacity. The owner pushes and pops at the bottom, thieves take from the top. Top and
+// bottom only ever grow, and are compared as signed so a pop from an empty deque can briefly put bottom below top.
+typedef struct Job_Deque {
+	u64 top;
+	u8 top_padding[CACHE_LINE_SIZE - sizeof(u64)];
+	u64 bottom;
+	u8 bottom_padding[CACHE_LINE_SIZE - sizeof(u64)];
+	Job* buffer[JOB_DEQUE_CAPACITY];
+} Job_Deque;
+
+typedef struct Job_Worker Job_Worker;
+
+typedef struct Job_Fiber {
+	Fiber fiber;
+	// Worker the fiber runs on, set by whichever worker switches to it
+	Job_Worker* worker;
+	// Counter the fiber waits on while parked
+	Job_Counter* counter;
+	// Worker that has to resume the fiber, or JOB_WORKER_MAX for any. Threads converted to fibers never move.
+	u32 pinned_worker;
+} Job_Fiber;
+
+struct Job_Worker {
+	Job_Deque deque;
+	Job pool[JOB_POOL_SIZE];
+	u32 pool_next;
+	u32 random;
+	u32 index;
+	Thread thread;
+
+	// The worker's own thread as a fiber, and the fiber currently running on it
+	Job_Fiber thread_fiber;
+	Job_Fiber* current;
+	// A fiber can't be freed or parked while it is still running, so the fiber that switches away leaves itself here
+	// for the next one to handle
+	Job_Fiber* release_fiber;
+	Job_Fiber* wait_fiber;
+	// Pinned fiber whose counter has reached zero
+	Job_Fiber* pinned_ready;
+};
+
+typedef struct Job_System {
+	u32 running;
+	u32 worker_count;
+	u32 worker_capacity;
+	b8 pin_threads;
+	Job_Worker* workers;
+	// Idle workers sleep here
+	Semaphore wake;
+	u32 sleeping;
+
+	// Guards the free, waiting and ready fibers
+	Mutex fiber_lock;
+	Job_Fiber* fibers;
+	Job_Fiber* free_fibers[JOB_FIBER_COUNT];
+	u32 free_count;
+	// Pool fibers and the main thread
+	Job_Fiber* waiting_fibers[JOB_FIBER_COUNT + 1];
+	u32 waiting_count;
+	Job_Fiber* ready_fibers[JOB_FIBER_COUNT];
+	u32 ready_count;
+} Job_System;
+
+static Job_System job_system = {0};
+
+static thread_local u32 worker_index = JOB_WORKER_MAX;
+
+//
+// Deque
+//
+
+static b8 deque_push(Job_Deque* deque, Job* job) {
+	u64 bottom = atomic_load_u64(&deque->bottom, MEMORY_ORDER_RELAXED);
+	u64 top = atomic_load_u64(&deque->top, MEMORY_ORDER_ACQUIRE);
+	if ((i64)(bottom - top) >= JOB_DEQUE_CAPACITY) {
+		return false;
+	}
+
+	atomic_store_ptr((void**)&deque->buffer[bottom & (JOB_DEQUE_CAPACITY - 1)], job, MEMORY_ORDER_RELAXED);
+	atomic_fence(MEMORY_ORDER_RELEASE);
+	atomic_store_u64(&deque->bottom, bottom + 1, MEMORY_ORDER_RELAXED);
+	return true;
+}
+
+static Job* deque_pop(Job_Deque* deque) {
+	u64 bottom = atomic_load_u64(&deque->bottom, MEMORY_ORDER_RELAXED) - 1;
+	atomic_store_u64(&deque->bottom, bottom, MEMORY_ORDER_RELAXED);
+	atomic_fence(MEMORY_ORDER_SEQ_CST);
+	u64 top = atomic_load_u64(&deque->top, MEMORY_ORDER_RELAXED);
+
+	if ((i64)(bottom - top) < 0) {
+		// Empty
+		atomic_store_u64(&deque->bottom, bottom + 1, MEMORY_ORDER_RELAXED);
+		return null;
+	}
+
+	Job* job = atomic_load_ptr((void**)&deque->buffer[bottom & (JOB_DEQUE_CAPACITY - 1)], MEMORY_ORDER_RELAXED);
+	if (bottom == top) {
+		// Last job, race any thieves for it
+		if (!atomic_compare_exchange_u64(&deque->top, &top, top + 1, MEMORY_ORDER_SEQ_CST, MEMORY_ORDER_RELAXED)) {
+			job = null;
+		}
+		atomic_store_u64(&deque->bottom, bottom + 1, MEMORY_ORDER_RELAXED);
+	}
+	return job;
+}
+
+static Job* deque_steal(Job_Deque* deque) {
+	u64 top = atomic_load_u64(&deque->top, MEMORY_ORDER_ACQUIRE);
+	atomic_fence(MEMORY_ORDER_SEQ_CST);
+	u64 bottom = atomic_load_u64(&deque->bottom, MEMORY_ORDER_ACQUIRE);
+	if ((i64)(bottom - top) <= 0) {
+		return null;
+	}
+
+	Job* job = atomic_load_ptr((void**)&deque->buffer[top & (JOB_DEQUE_CAPACITY - 1)], MEMORY_ORDER_RELAXED);
+	if (!atomic_compare_exchange_u64(&deque->top, &top, top + 1, MEMORY_ORDER_SEQ_CST, MEMORY_ORDER_RELAXED)) {
+		// Lost to the owner or another thief
+		return null;
+	}
+	return job;
+}
+
+//
+// Scheduling
+//
+
+static u32 next_random(Job_Worker* worker) {
+	u32 x = worker->random;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	worker->random = x;
+	return x;
+}
+// Pops the worker's own newest job, or steals the oldest job of another worker starting from a random one
+static Job* find_job(Job_Worker* worker) {
+	Job* job = deque_pop(&worker->deque);
+	if (job) {
+		return job;
+	}
+
+	u32 worker_count = job_system.worker_count;
+	u32 start = next_random(worker) % worker_count;
+	for (u32 i = 0; i < worker_count; i++) {
+		u32 victim = (start + i) % worker_count;
+		if (victim == worker->index) {
+			continue;
+		}
+		job = deque_steal(&job_system.workers[victim].deque);
+		if (job) {
+			return job;
+		}
+	}
+	return null;
+}
+
+// Pairs with the sleeping count and recheck in scheduler_main, so a worker never sleeps through a push or a resume
+static void wake_workers(u32 count) {
+	atomic_fence(MEMORY_ORDER_SEQ_CST);
+	u32 sleeping = atomic_load_u32(&job_system.sleeping, MEMORY_ORDER_SEQ_CST);
+	if (sleeping > 0) {
+		semaphore_post(&job_system.wake, count < sleeping ? count : sleeping);
+	}
+}
+
+//
+// Fibers
+//
+
+static Job_Fiber* acquire_fiber(void) {
+	Job_Fiber* fiber = null;
+	mutex_lock(&job_system.fiber_lock);
+	if (job_system.free_count > 0) {
+		fiber = job_system.free_fibers[--job_system.free_count];
+	}
+	mutex_unlock(&job_system.fiber_lock);
+	return fiber;
+}
+
+static void release_fiber(Job_Fiber* fiber) {
+	mutex_lock(&job_system.fiber_lock);
+	job_system.free_fibers[job_system.free_count++] = fiber;
+	mutex_unlock(&job_system.fiber_lock);
+}
+
+// Must be called with the fiber lock held
+static void make_ready(Job_Fiber* fiber) {
+	if (fiber->pinned_worker < JOB_WORKER_MAX) {
+		atomic_store_ptr((void**)&job_system.workers[fiber->pinned_worker].pinned_ready, fiber, MEMORY_ORDER_RELEASE);
+	} else {
+		job_system.ready_fibers[job_system.ready_count] = fiber;
+		atomic_store_u32(&job_system.ready_count, job_system.ready_count + 1, MEMORY_ORDER_SEQ_CST);
+	}
+}
+
+// Must be called with the fiber lock held
+static void remove_waiting(u32 index) {
+	u32 count = job_system.waiting_count - 1;
+	job_system.waiting_fibers[index] = job_system.waiting_fibers[count];
+	atomic_store_u32(&job_system.waiting_count, count, MEMORY_ORDER_SEQ_CST);
+}
+
+// Readies the fibers waiting on a counter that just reached zero. Pairs with the waiting count and recheck in
+// park_fiber, so a fiber never parks on a counter that has already finished.
+static void resume_waiters(Job_Counter* counter) {
+	if (atomic_load_u32(&job_system.waiting_count, MEMORY_ORDER_SEQ_CST) == 0) {
+		return;
+	}
+
+	u32 resumed = 0;
+	mutex_lock(&job_system.fiber_lock);
+	for (u32 i = 0; i < job_system.waiting_count;) {
+		Job_Fiber* fiber = job_system.waiting_fibers[i];
+		if (fiber->counter == counter) {
+			remove_waiting(i);
+			make_ready(fiber);
+			resumed++;
+		} else {
+			i++;
+		}
+	}
+	mutex_unlock(&job_system.fiber_lock);
+
+	if (resumed > 0) {
+		wake_workers(resumed);
+	}
+}
+
+// Called once the fiber has switched away. If its counter finished in the meantime the calling worker picks it up
+// again itself.
+static void park_fiber(Job_Fiber* fiber) {
+	mutex_lock(&job_system.fiber_lock);
+	job_system.waiting_fibers[job_system.waiting_count] = fiber;
+	atomic_store_u32(&job_system.waiting_count, job_system.waiting_count + 1, MEMORY_ORDER_SEQ_CST);
+	if (atomic_load_u32(&fiber->counter->value, MEMORY_ORDER_SEQ_CST) == 0) {
+		remove_waiting(job_system.waiting_count - 1);
+		make_ready(fiber);
+	}
+	mutex_unlock(&job_system.fiber_lock);
+}
+
+static b8 has_ready_fiber(Job_Worker* worker) {
+	return atomic_load_ptr((void**)&worker->pinned_ready, MEMORY_ORDER_SEQ_CST) != null
+		|| atomic_load_u32(&job_system.ready_count, MEMORY_ORDER_SEQ_CST) > 0;
+}
+
+static Job_Fiber* take_ready_fiber(Job_Worker* worker) {
+	Job_Fiber* fiber = atomic_load_ptr((void**)&worker->pinned_ready, MEMORY_ORDER_ACQUIRE);
+	if (fiber) {
+		atomic_store_ptr((void**)&worker->pinned_ready, null, MEMORY_ORDER_RELAXED);
+		return fiber;
+	}
+
+	if (atomic_load_u32(&job_system.ready_count, MEMORY_ORDER_RELAXED) == 0) {
+		return null;
+	}
+	mutex_lock(&job_system.fiber_lock);
+	if (job_system.ready_count > 0) {
+		fiber = job_system.ready_fibers[job_system.ready_count - 1];
+		atomic_store_u32(&job_system.ready_count, job_system.ready_count - 1, MEMORY_ORDER_RELAXED);
+	}
+	mutex_unlock(&job_system.fiber_lock);
+	return fiber;
+}
+
+// Handles what the previous fiber on this worker left behind when it switched away
+static void finish_switch(Job_Worker* worker) {
+	if (worker->release_fiber) {
+		release_fiber(worker->release_fiber);
+		worker->release_fiber = null;
+	}
+	if (worker->wait_fiber) {
+		park_fiber(worker->wait_fiber);
+		worker->wait_fiber = null;
+	}
+}
+
+// Runs another fiber on the worker. Returns once the calling fiber is switched back to, which may be on another
+// worker, so the worker it now runs on is returned. Thread locals must not be read across the switch, since the
+// compiler is free to reuse the address it looked up on the old thread.
+static Job_Worker* switch_to(Job_Worker* worker, Job_Fiber* fiber) {
+	Job_Fiber* self = worker->current;
+	fiber->worker = worker;
+	worker->current = fiber;
+	fiber_switch(&self->fiber, &fiber->fiber);
+
+	worker = self->worker;
+	finish_switch(worker);
+	return worker;
+}
+
+//
+// Workers
+//
+
+static void execute(Job* job) {
+	// The slot is handed back before the job runs, since the job may wait and the submitter reuse it meanwhile
+	Job copy = *job;
+	atomic_store_u32(&job->queued, 0, MEMORY_ORDER_RELEASE);
+	Job_Counter* counter = copy.counter;
+	if (copy.range_function) {
+		copy.range_function(copy.begin, copy.end, copy.data);
+	} else {
+		copy.function(copy.data);
+	}
+
+	if (counter && atomic_fetch_sub_u32(&counter->value, 1, MEMORY_ORDER_SEQ_CST) == 1) {
+		resume_waiters(counter);
+	}
+}
+
+// Finds a slot in the worker's pool whose job has been taken. Jobs are taken roughly in the order they were queued,
+// so the next slot is almost always free and the search only runs long when the pool is nearly full.
+static Job* acquire_job(Job_Worker* worker) {
+	for (u32 i = 0; i < JOB_POOL_SIZE; i++) {
+		Job* job = &worker->pool[worker->pool_next++ & (JOB_POOL_SIZE - 1)];
+		if (!atomic_load_u32(&job->queued, MEMORY_ORDER_ACQUIRE)) {
+			job->queued = 1;
+			return job;
+		}
+	}
+	return null;
+}
+
+static void submit(Job_Function function, Job_Range_Function range_function, void* data, u32 begin, u32 end, Job_Counter* counter) {
+	u32 index = worker_index;
+	Job* job = index < job_system.worker_count ? acquire_job(&job_system.workers[index]) : null;
+	if (!job) {
+		// Outside the job system or every slot still queued, so the job runs right away
+		Job inline_job = { function, range_function, data, begin, end, counter, 0 };
+		execute(&inline_job);
+		return;
+	}
+
+	Job_Worker* worker = &job_system.workers[index];
+	job->function = function;
+	job->range_function = range_function;
+	job->data = data;
+	job->begin = begin;
+	job->end = end;
+	job->counter = counter;
+
+	if (!deque_push(&worker->deque, job)) {
+		execute(job);
+	}
+}
+
+// Every pool fiber runs this loop. Finished waits are resumed before new jobs start, and a fiber switching to another
+// one goes back to the pool where it stays suspended inside the loop until it is picked up again.
+static void scheduler_main(void* data) {
+	Job_Fiber* self = (Job_Fiber*)data;
+	Job_Worker* worker = self->worker;
+	finish_switch(worker);
+
+	u32 spins = 0;
+	for (;;) {
+		Job_Fiber* ready = take_ready_fiber(worker);
+		if (ready) {
+			worker->release_fiber = self;
+			worker = switch_to(worker, ready);
+			continue;
+		}
+
+		// The main thread only gets here while its own fiber waits, and leaves through its pinned resume
+		if (worker->index != 0 && !atomic_load_u32(&job_system.running, MEMORY_ORDER_ACQUIRE)) {
+			worker->release_fiber = self;
+			worker = switch_to(worker, &worker->thread_fiber);
+			continue;
+		}
+
+		Job* job = find_job(worker);
+		if (job) {
+			execute(job);
+			worker = self->worker;
+			spins = 0;
+			continue;
+		}
+
+		if (++spins < JOB_SPIN_COUNT) {
+			cpu_pause();
+			continue;
+		}
+		spins = 0;
+
+		// Sleeping would need a wake aimed at the main thread, and it is only ever here briefly
+		if (worker->index == 0) {
+			thread_yield();
+			continue;
+		}
+
+		// Pairs with wake_workers, so a worker never sleeps through a push or a resume
+		atomic_fetch_add_u32(&job_system.sleeping, 1, MEMORY_ORDER_SEQ_CST);
+		job = find_job(worker);
+		if (!job && !has_ready_fiber(worker) && atomic_load_u32(&job_system.running, MEMORY_ORDER_ACQUIRE)) {
+			semaphore_wait(&job_system.wake);
+		}
+		atomic_fetch_sub_u32(&job_system.sleeping, 1, MEMORY_ORDER_RELAXED);
+
+		if (job) {
+			execute(job);
+			worker = self->worker;
+		}
+	}
+}
+
+static i32 worker_main(void* data) {
+	Job_Worker* worker = (Job_Worker*)data;
+	worker_index = worker->index;
+	if (job_system.pin_threads) {
+		platform_pin_thread(THREAD_ROLE_WORKER, worker->index);
+	}
+
+	if (!fiber_convert_thread(&worker->thread_fiber.fiber)) {
+		return 1;
+	}
+	Job_Fiber* fiber = acquire_fiber();
+	if (!fiber) {
+		log_error("No fiber left for job worker %u", worker->index);
+		fiber_convert_back(&worker->thread_fiber.fiber);
+		return 1;
+	}
+
+	// Comes back here once the job system stops running
+	switch_to(worker, fiber);
+	fiber_convert_back(&worker->thread_fiber.fiber);
+	return 0;
+}
+
+//
+// Lifecycle
+//
+
+b8 job_system_init(u32 worker_count, b8 pin_threads) {
+	// SMT siblings share a core's execution units, so a worker for each would mostly contend with the other
+	if (worker_count == JOB_WORKER_COUNT_AUTO) {
+		worker_count = platform_get_cpu_topology()->core_count;
+	}
+	if (worker_count < 1) {
+		worker_count = 1;
+	} else if (worker_count > JOB_WORKER_MAX) {
+		worker_count = JOB_WORKER_MAX;
+	}
+
+	job_system.worker_count = worker_count;
+	job_system.worker_capacity = worker_count;
+	job_system.pin_threads = pin_threads;
+	job_system.workers = memory_alloc(sizeof(Job_Worker) * worker_count, MEMORY_TAG_ENGINE);
+	memory_zero(job_system.workers, sizeof(Job_Worker) * worker_count);
+	atomic_store_u32(&job_system.running, 1, MEMORY_ORDER_RELEASE);
+
+	for (u32 i = 0; i < worker_count; i++) {
+		Job_Worker* worker = &job_system.workers[i];
+		worker->index = i;
+		worker->random = 0x9E3779B9u * (i + 1);
+		worker->thread_fiber.worker = worker;
+		worker->thread_fiber.pinned_worker = i;
+		worker->current = &worker->thread_fiber;
+	}
+
+	job_system.fibers = memory_alloc(sizeof(Job_Fiber) * JOB_FIBER_COUNT, MEMORY_TAG_ENGINE);
+	memory_zero(job_system.fibers, sizeof(Job_Fiber) * JOB_FIBER_COUNT);
+	job_system.free_count = 0;
+	for (u32 i = 0; i < JOB_FIBER_COUNT; i++) {
+		Job_Fiber* fiber = &job_system.fibers[i];
+		fiber->pinned_worker = JOB_WORKER_MAX;
+		if (!fiber_create(&fiber->fiber, JOB_FIBER_STACK_SIZE, scheduler_main, fiber)) {
+			log_warn("Only created %u of %u job fibers", i, JOB_FIBER_COUNT);
+			break;
+		}
+		job_system.free_fibers[job_system.free_count++] = fiber;
+	}
+
+	// The calling thread is worker zero
+	worker_index = 0;
+	if (pin_threads) {
+		platform_pin_thread(THREAD_ROLE_MAIN, 0);
+	}
+	if (!fiber_convert_thread(&job_system.workers[0].thread_fiber.fiber)) {
+		return false;
+	}
+	for (u32 i = 1; i < worker_count; i++) {
+		char name[THREAD_NAME_MAX];
+		snprintf(name, sizeof(name), "haunt-job-%u", i);
+		if (!thread_create(&job_system.workers[i].thread, name, 0, worker_main, &job_system.workers[i])) {
+			log_error("Failed to start job worker %u", i);
+			job_system.worker_count = i;
+			break;
+		}
+	}
+
+	log_info("Job system started with %u workers%s", job_system.worker_count, pin_threads ? ", pinned" : "");
+	return true;
+}
+
+void job_system_shutdown(void) {
+	if (!job_system.workers) {
+		return;
+	}
+
+	atomic_store_u32(&job_system.running, 0, MEMORY_ORDER_RELEASE);
+	semaphore_post(&job_system.wake, job_system.worker_count);
+	for (u32 i = 1; i < job_system.worker_count; i++) {
+		thread_join(&job_system.workers[i].thread);
+	}
+
+	fiber_convert_back(&job_system.workers[0].thread_fiber.fiber);
+	for (u32 i = 0; i < JOB_FIBER_COUNT; i++) {
+		if (job_system.fibers[i].fiber.context) {
+			fiber_destroy(&job_system.fibers[i].fiber);
+		}
+	}
+	memory_free(job_system.fibers, sizeof(Job_Fiber) * JOB_FIBER_COUNT, MEMORY_TAG_ENGINE);
+	job_system.fibers = null;
+	job_system.free_count = 0;
+
+	memory_free(job_system.workers, sizeof(Job_Worker) * job_system.worker_capacity, MEMORY_TAG_ENGINE);
+	job_system.workers = null;
+	job_system.worker_count = 0;
+	worker_index = JOB_WORKER_MAX;
+}
+
+//
+// Jobs
+//
+
+void job_run(const Job_Desc* jobs, u32 count, Job_Counter* counter) {
+	if (counter) {
+		atomic_fetch_add_u32(&counter->value, count, MEMORY_ORDER_RELAXED);
+	}
+	for (u32 i = 0; i < count; i++) {
+		submit(jobs[i].function, null, jobs[i].data, 0, 0, counter);
+	}
+	wake_workers(count);
+}
+
+void job_wait(Job_Counter* counter) {
+	if (atomic_load_u32(&counter->value, MEMORY_ORDER_ACQUIRE) == 0) {
+		return;
+	}
+
+	u32 index = worker_index;
+	if (index >= job_system.worker_count) {
+		while (atomic_load_u32(&counter->value, MEMORY_ORDER_ACQUIRE) != 0) {
+			cpu_pause();
+		}
+		return;
+	}
+
+	Job_Worker* worker = &job_system.workers[index];
+	Job_Fiber* self = worker->current;
+	// A counter reused at the same address can resume the fiber early, so check again after every resume
+	while (atomic_load_u32(&counter->value, MEMORY_ORDER_ACQUIRE) != 0) {
+		Job_Fiber* fiber = acquire_fiber();
+		if (fiber) {
+			self->counter = counter;
+			worker->wait_fiber = self;
+			worker = switch_to(worker, fiber);
+			continue;
+		}
+
+		// Every fiber is taken, so run jobs on this stack until the counter finishes
+		Job* job = find_job(worker);
+		if (job) {
+			execute(job);
+			worker = self->worker;
+		} else {
+			cpu_pause();
+		}
+	}
+}
+
+b8 job_is_done(Job_Counter* counter) {
+	return atomic_load_u32(&counter->value, MEMORY_ORDER_ACQUIRE) == 0;
+}
+
+void job_counter_add(Job_Counter* counter, u32 count) {
+	atomic_fetch_add_u32(&counter->value, count, MEMORY_ORDER_RELAXED);
+}
+
+void job_counter_done(Job_Counter* counter) {
+	if (atomic_fetch_sub_u32(&counter->value, 1, MEMORY_ORDER_SEQ_CST) == 1) {
+		resume_waiters(counter);
+	}
+}
+
+void job_parallel_for(u32 count, u32 grain_size, Job_Range_Function function, void* data) {
+	if (count == 0) {
+		return;
+	}
+
+	// Also covers a job system that isn't running, which has no workers
+	if (job_system.worker_count <= 1) {
+		function(0, count, data);
+		return;
+	}
+
+	if (grain_size == 0) {
+		grain_size = count / (job_system.worker_count * JOB_RANGES_PER_WORKER);
+	}
+	// Leave half the pool for jobs the ranges submit themselves
+	u32 range_max = JOB_POOL_SIZE / 2;
+	if (grain_size == 0 || (count + grain_size - 1) / grain_size > range_max) {
+		grain_size = (count + range_max - 1) / range_max;
+	}
+
+	u32 range_count = (count + grain_size - 1) / grain_size;
+	if (range_count == 1) {
+		function(0, count, data);
+		return;
+	}
+
+	Job_Counter counter = { range_count };
+	for (u32 begin = 0; begin < count; begin += grain_size) {
+		u32 end = count - begin > grain_size ? begin + grain_size : count;
+		submit(null, function, data, begin, end, &counter);
+	}
+	wake_workers(range_count);
+	job_wait(&counter);
+}
+
+u32 job_get_worker_count(void) {
+	return job_system.worker_count;
+}
+
+u32 job_get_worker_index(void) {
+	return worker_index;
+}
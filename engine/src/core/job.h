@@ -0,0 +1,80 @@
+#pragma once
+
+#include "core/export.h"
+#include "core/types.h"
+
+/**
+ * Work-stealing job system.
+ *
+ * Every worker owns a lock-free Chase-Lev deque. Jobs are pushed to and popped from the bottom of the submitting
+ * worker's deque, so the newest and cache-warmest work runs first, and idle workers steal the oldest jobs from the top
+ * of the others. The main thread is worker zero.
+ *
+ * Jobs run on fibers. A job that waits on a counter parks its fiber and the worker carries on with other jobs on a
+ * fresh fiber from a shared pool, so a chain of jobs that each wait on the next is plain straight line code that never
+ * blocks a worker. A parked job resumes once its counter reaches zero, possibly on a different worker thread, so a job
+ * must not hold thread affine state like thread locals or a lock across a wait. The main thread always resumes on
+ * itself.
+ *
+ * Jobs may only be submitted from the main thread or from inside other jobs. Submitting from any other thread runs
+ * the jobs immediately on that thread.
+ */
+
+// Jobs each worker may have queued at once. Submitting more runs them right away on the submitting worker.
+#define JOB_POOL_SIZE 4096
+#define JOB_WORKER_MAX 64
+// Worker count for job_system_init that picks one worker per physical core
+#define JOB_WORKER_COUNT_AUTO 0
+
+typedef void (*Job_Function)(void* data);
+
+// Runs the items in [begin, end)
+typedef void (*Job_Range_Function)(u32 begin, u32 end, void* data);
+
+// Counts the unfinished jobs it was passed to. Zero initialized is done.
+typedef struct Job_Counter {
+	u32 value;
+} Job_Counter;
+
+typedef struct Job_Desc {
+	Job_Function function;
+	void* data;
+} Job_Desc;
+
+//
+// Lifecycle
+//
+
+// Starts the worker threads. The count includes the calling thread, which becomes worker zero. Pinning keeps every
+// worker on a core of its own, see platform_cpu.h.
+b8 job_system_init(u32 worker_count, b8 pin_threads);
+
+void job_system_shutdown(void);
+
+//
+// Jobs
+//
+
+// Queues the jobs on the calling worker. The counter, if any, is incremented by count and reaches zero once they all
+// finish.
+export void job_run(const Job_Desc* jobs, u32 count, Job_Counter* counter);
+
+// Returns once the counter reaches zero, running other jobs on the calling worker meanwhile
+export void job_wait(Job_Counter* counter);
+
+export b8 job_is_done(Job_Counter* counter);
+
+// Let work that runs outside the job system, like file I/O, hold a counter that jobs wait on. Every add has to be
+// matched by a done, which resumes the waiting jobs once the counter reaches zero.
+export void job_counter_add(Job_Counter* counter, u32 count);
+
+export void job_counter_done(Job_Counter* counter);
+
+// Splits [0, count) into ranges of grain_size items and runs them in parallel, returning once all are done. A grain
+// size of zero picks one that gives each worker a few ranges to balance with.
+export void job_parallel_for(u32 count, u32 grain_size, Job_Range_Function function, void* data);
+
+export u32 job_get_worker_count(void);
+
+// Index of the calling worker, or JOB_WORKER_MAX for threads outside the job system
+export u32 job_get_worker_index(void);
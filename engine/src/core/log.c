@@ -1,12 +1,84 @@
 #include "core/log.h"
 
+#include "core/atomic.h"
 #include "core/memory.h"
 #include "platform/platform.h"
+#include "platform/platform_thread.h"
 
 #include <stdio.h>
 #include <string.h>
 #include <stdarg.h>
 
+#define CACHE_LINE_SIZE 64
+// Messages that fit are formatted on the stack and copied into the ring. Longer ones are formatted a second time,
+// straight into the ring, once their length is known.
+#define LOG_STACK_MESSAGE_SIZE 512
+// Marks the skipped end of the ring when a message did not fit before the wrap
+#define LOG_RECORD_PADDING 0x80000000u
+// Backstop for a flush missing the logger thread's wake
+#define LOG_FLUSH_POLL_NS 10000000ull
+#define LOG_PATH_MAX 512
+// Level, timestamp and newline around the message
+#define LOG_LINE_EXTRA 64
+
+static_assert((LOG_RING_SIZE & (LOG_RING_SIZE - 1)) == 0, "Expected the log ring size to be a power of two");
+static_assert((LOG_MEMORY_SIZE & (LOG_MEMORY_SIZE - 1)) == 0, "Expected the log memory size to be a power of two");
+static_assert(LOG_MESSAGE_MAX < 65536, "Expected a message length to fit in a u16");
+
+// A message in the ring, followed by its text. The size is stored last, so a zero size is a message still being
+// written. The logger thread zeroes what it consumed, since later messages can start anywhere in it.
+typedef struct Log_Record {
+	// Including the header, a multiple of the header size
+	u32 size;
+	u16 length;
+	u8 level;
+	u8 reserved;
+	u64 time;
+} Log_Record;
+
+typedef struct Logger {
+	// Reserved by the logging threads
+	u64 head;
+	u8 head_padding[CACHE_LINE_SIZE - sizeof(u64)];
+	// Consumed by the logger thread
+	u64 tail;
+	u8 tail_padding[CACHE_LINE_SIZE - sizeof(u64)];
+
+	u8* ring;
+	u64 dropped;
+	// Logging threads may push while set
+	u32 running;
+	// Logging threads between checking running and finishing their push, so shutdown can wait them out
+	u32 writers;
+	// Set once the logger thread has a wake pending, so a burst of messages posts the semaphore once
+	u32 signalled;
+	u32 quit;
+	Semaphore wake;
+	Thread thread;
+
+	Mutex flush_mutex;
+	Condvar flushed;
+	u32 flush_waiters;
+
+	// Everything from here on is only touched with the sink mutex held
+	Mutex sink_mutex;
+	u32 sinks;
+	FILE* file;
+	char file_path[LOG_PATH_MAX];
+	u64 file_size;
+	char* memory;
+	// Bytes ever written to the memory sink
+	u64 memory_written;
+	u64 written_count;
+	u64 reported_dropped;
+	u64 ring_peak;
+	u64 start_time;
+	char text[LOG_MESSAGE_MAX];
+	char line[LOG_MESSAGE_MAX + LOG_LINE_EXTRA];
+} Logger;
+
+static Logger logger = { .sinks = LOG_SINK_CONSOLE | LOG_SINK_MEMORY };
+
 static const char* level_strings[LOG_LEVEL_COUNT] = {
 	"[FATAL] ",
 	"[ERROR] ",
@@ -29,26 +101,418 @@ void assert_handler(const char* expression, const char* message, const char* fil
 	log_output(LOG_LEVEL_FATAL, "Assertion failed: (%s), message: \"%s\", file: \"%s\", line: %d", expression, message, file, line);
 }
 
-void log_output(Log_Level level, const char* message, ...) {
-	b8 is_error = level <= LOG_LEVEL_ERROR;
+//
+// Sinks
+//
+
+// Moves path to path.1, path.1 to path.2 and so on, dropping the oldest, and starts a new file
+static void rotate_file(void) {
+	fclose(logger.file);
+
+	char from[LOG_PATH_MAX + 16];
+	char to[LOG_PATH_MAX + 16];
+	for (u32 i = LOG_FILE_KEEP_COUNT; i > 0; i--) {
+		if (i == 1) {
+			snprintf(from, sizeof(from), "%s", logger.file_path);
+		} else {
+			snprintf(from, sizeof(from), "%s.%u", logger.file_path, i - 1);
+		}
+		snprintf(to, sizeof(to), "%s.%u", logger.file_path, i);
+		// Windows will not rename over an existing file
+		remove(to);
+		rename(from, to);
+	}
+
+	logger.file = fopen(logger.file_path, "wb");
+	logger.file_size = 0;
+}
+
+static void write_memory(const char* line, u64 length) {
+	// Only the end of a line longer than the whole buffer can be kept
+	if (length > LOG_MEMORY_SIZE) {
+		line += length - LOG_MEMORY_SIZE;
+		length = LOG_MEMORY_SIZE;
+	}
+
+	u64 offset = logger.memory_written & (LOG_MEMORY_SIZE - 1);
+	u64 first = length < LOG_MEMORY_SIZE - offset ? length : LOG_MEMORY_SIZE - offset;
+	memory_copy(logger.memory + offset, line, first);
+	memory_copy(logger.memory, line + first, length - first);
+	logger.memory_written += length;
+}
+
+// Writes one message to every sink. The sink mutex must be held.
+static void write_message(Log_Level level, u64 time, const char* text, u32 length) {
+	// The file gets a timestamp, since the logger thread may write it well after the message was logged
+	u32 prefix = (u32)snprintf(logger.line, LOG_LINE_EXTRA, "%12.6f ", (f64)(time - logger.start_time) / 1000000000.0);
+	u32 level_length = (u32)strlen(level_strings[level]);
+	char* console_line = logger.line + prefix;
+	memory_copy(console_line, level_strings[level], level_length);
+	memory_copy(console_line + level_length, text, length);
+	console_line[level_length + length] = '\n';
+	console_line[level_length + length + 1] = '\0';
+	u32 console_length = level_length + length + 1;
+
+	if (logger.sinks & LOG_SINK_CONSOLE) {
+		if (level <= LOG_LEVEL_ERROR) {
+			platform_console_write_error(console_line, level_colors[level]);
+		} else {
+			platform_console_write(console_line, level_colors[level]);
+		}
+	}
+
+	if ((logger.sinks & LOG_SINK_FILE) && logger.file) {
+		u64 line_length = prefix + console_length;
+		fwrite(logger.line, 1, line_length, logger.file);
+		logger.file_size += line_length;
+		if (logger.file_size >= LOG_FILE_ROTATE_SIZE) {
+			rotate_file();
+		}
+	}
+
+	if ((logger.sinks & LOG_SINK_MEMORY) && logger.memory) {
+		write_memory(console_line, console_length);
+	}
+
+	logger.written_count++;
+}
+
+// Formats and writes a message on the calling thread
+static void write_now(Log_Level level, const char* message, va_list args) {
+	mutex_lock(&logger.sink_mutex);
+	i32 length = vsnprintf(logger.text, sizeof(logger.text), message, args);
+	length = length < 0 ? 0 : length >= (i32)sizeof(logger.text) ? (i32)sizeof(logger.text) - 1 : length;
+	write_message(level, platform_get_time_ns(), logger.text, (u32)length);
+	if (logger.file) {
+		fflush(logger.file);
+	}
+	mutex_unlock(&logger.sink_mutex);
+}
+
+//
+// Ring
+//
+
+static void wake_logger(void) {
+	if (!atomic_exchange_u32(&logger.signalled, 1, MEMORY_ORDER_SEQ_CST)) {
+		semaphore_post(&logger.wake, 1);
+	}
+}
+
+// Reserves space for a message, or returns null when the ring is full. A message never wraps around the end of the
+// ring, the rest of the ring is skipped with a padding record instead.
+static Log_Record* reserve(u32 size) {
+	u64 head = atomic_load_u64(&logger.head, MEMORY_ORDER_RELAXED);
+	u64 offset;
+	u64 total;
+	do {
+		offset = head & (LOG_RING_SIZE - 1);
+		u64 contiguous = LOG_RING_SIZE - offset;
+		total = size <= contiguous ? size : contiguous + size;
+		// Acquire so the logger thread has finished zeroing the space before it is written
+		u64 tail = atomic_load_u64(&logger.tail, MEMORY_ORDER_ACQUIRE);
+		if (head + total - tail > LOG_RING_SIZE) {
+			return null;
+		}
+	} while (!atomic_compare_exchange_u64(&logger.head, &head, head + total, MEMORY_ORDER_RELAXED, MEMORY_ORDER_RELAXED));
+
+	if (total != size) {
+		Log_Record* padding = (Log_Record*)(logger.ring + offset);
+		atomic_store_u32(&padding->size, (u32)(total - size) | LOG_RECORD_PADDING, MEMORY_ORDER_RELEASE);
+		offset = 0;
+	}
+	return (Log_Record*)(logger.ring + offset);
+}
+
+// Returns false when the message still has to be written, because the logger is not running or an error found the
+// ring full
+static b8 push(Log_Level level, const char* message, va_list args) {
+	atomic_fetch_add_u32(&logger.writers, 1, MEMORY_ORDER_SEQ_CST);
+	if (!atomic_load_u32(&logger.running, MEMORY_ORDER_SEQ_CST)) {
+		atomic_fetch_sub_u32(&logger.writers, 1, MEMORY_ORDER_RELEASE);
+		return false;
+	}
+
+	va_list retry;
+	va_copy(retry, args);
+	char stack[LOG_STACK_MESSAGE_SIZE];
+	i32 length = vsnprintf(stack, sizeof(stack), message, args);
+	length = length < 0 ? 0 : length >= LOG_MESSAGE_MAX ? LOG_MESSAGE_MAX - 1 : length;
+
+	// Room for the terminator vsnprintf writes
+	u32 size = (u32)(sizeof(Log_Record) + length + 1 + sizeof(Log_Record) - 1) & ~(u32)(sizeof(Log_Record) - 1);
+	Log_Record* record = reserve(size);
+	b8 handled = true;
+	if (record) {
+		record->length = (u16)length;
+		record->level = (u8)level;
+		record->time = platform_get_time_ns();
+		char* text = (char*)(record + 1);
+		if (length < (i32)sizeof(stack)) {
+			memory_copy(text, stack, (u64)length);
+		} else {
+			vsnprintf(text, (size_t)length + 1, message, retry);
+		}
+		atomic_store_u32(&record->size, size, MEMORY_ORDER_RELEASE);
+		wake_logger();
+	} else if (level <= LOG_LEVEL_ERROR) {
+		handled = false;
+	} else {
+		atomic_fetch_add_u64(&logger.dropped, 1, MEMORY_ORDER_RELAXED);
+	}
+	va_end(retry);
+
+	atomic_fetch_sub_u32(&logger.writers, 1, MEMORY_ORDER_RELEASE);
+	return handled;
+}
+
+// Writes out every message that is finished, in order, stopping at one still being written
+static void drain(void) {
+	u64 tail = atomic_load_u64(&logger.tail, MEMORY_ORDER_RELAXED);
+	u64 head = atomic_load_u64(&logger.head, MEMORY_ORDER_ACQUIRE);
+
+	mutex_lock(&logger.sink_mutex);
+	if (head - tail > logger.ring_peak) {
+		logger.ring_peak = head - tail;
+	}
+
+	while (tail != head) {
+		Log_Record* record = (Log_Record*)(logger.ring + (tail & (LOG_RING_SIZE - 1)));
+		u32 size = atomic_load_u32(&record->size, MEMORY_ORDER_ACQUIRE);
+		if (size == 0) {
+			// Its writer wakes the thread again once it is done
+			break;
+		}
+		if (!(size & LOG_RECORD_PADDING)) {
+			write_message((Log_Level)record->level, record->time, (const char*)(record + 1), record->length);
+		}
+		size &= ~LOG_RECORD_PADDING;
+		memory_zero(record, size);
+		tail += size;
+		atomic_store_u64(&logger.tail, tail, MEMORY_ORDER_SEQ_CST);
+	}
+
+	u64 dropped = atomic_load_u64(&logger.dropped, MEMORY_ORDER_RELAXED);
+	if (dropped != logger.reported_dropped) {
+		i32 length = snprintf(logger.text, sizeof(logger.text), "Log ring full, dropped %llu messages",
+			(unsigned long long)(dropped - logger.reported_dropped));
+		write_message(LOG_LEVEL_WARN, platform_get_time_ns(), logger.text, (u32)length);
+		logger.reported_dropped = dropped;
+	}
+
+	if (logger.file) {
+		fflush(logger.file);
+	}
+	mutex_unlock(&logger.sink_mutex);
 
-	const i32 buffer_size = 32768;
-	char buffer1[buffer_size];
-	// TODO: Use memory_zero
-	memset(buffer1, 0, sizeof(buffer1));
+	if (atomic_load_u32(&logger.flush_waiters, MEMORY_ORDER_SEQ_CST) > 0) {
+		mutex_lock(&logger.flush_mutex);
+		condvar_broadcast(&logger.flushed);
+		mutex_unlock(&logger.flush_mutex);
+	}
+}
+
+static i32 logger_main(void* data) {
+	for (;;) {
+		semaphore_wait(&logger.wake);
+		atomic_store_u32(&logger.signalled, 0, MEMORY_ORDER_SEQ_CST);
+		// Nothing is pushed once quit is set, so the drain after seeing it is the last one needed
+		b8 quit = atomic_load_u32(&logger.quit, MEMORY_ORDER_ACQUIRE);
+		drain();
+		if (quit) {
+			return 0;
+		}
+	}
+}
+
+//
+// Lifecycle
+//
+
+void log_init(void) {
+	mutex_lock(&logger.sink_mutex);
+	logger.start_time = platform_get_time_ns();
+	logger.memory = memory_alloc(LOG_MEMORY_SIZE, MEMORY_TAG_ENGINE);
+	logger.memory_written = 0;
+	mutex_unlock(&logger.sink_mutex);
+
+#if LOG_ASYNC_ENABLED
+	logger.ring = memory_alloc(LOG_RING_SIZE, MEMORY_TAG_ENGINE);
+	memory_zero(logger.ring, LOG_RING_SIZE);
+	logger.head = 0;
+	logger.tail = 0;
+	logger.quit = 0;
+	if (!thread_create(&logger.thread, "haunt-log", 0, logger_main, null)) {
+		log_error("Failed to start logger thread, logging on the calling thread");
+		memory_free(logger.ring, LOG_RING_SIZE, MEMORY_TAG_ENGINE);
+		logger.ring = null;
+		return;
+	}
+	atomic_store_u32(&logger.running, 1, MEMORY_ORDER_SEQ_CST);
+#endif
+}
+
+void log_shutdown(void) {
+	if (logger.ring) {
+		atomic_store_u32(&logger.running, 0, MEMORY_ORDER_SEQ_CST);
+		while (atomic_load_u32(&logger.writers, MEMORY_ORDER_ACQUIRE) > 0) {
+			thread_yield();
+		}
+
+		atomic_store_u32(&logger.quit, 1, MEMORY_ORDER_RELEASE);
+		semaphore_post(&logger.wake, 1);
+		thread_join(&logger.thread);
+
+		memory_free(logger.ring, LOG_RING_SIZE, MEMORY_TAG_ENGINE);
+		logger.ring = null;
+	}
 
+	mutex_lock(&logger.sink_mutex);
+	if (logger.file) {
+		fclose(logger.file);
+		logger.file = null;
+	}
+	if (logger.memory) {
+		memory_free(logger.memory, LOG_MEMORY_SIZE, MEMORY_TAG_ENGINE);
+		logger.memory = null;
+	}
+	mutex_unlock(&logger.sink_mutex);
+}
+
+//
+// Output
+//
+
+void log_output(Log_Level level, const char* message, ...) {
 	va_list args;
 	va_start(args, message);
-	vsnprintf(buffer1, sizeof(buffer1), message, args);
+	b8 queued = push(level, message, args);
 	va_end(args);
 
-	char buffer2[buffer_size];
-	sprintf(buffer2, "%s%s\n", level_strings[level], buffer1);
+	if (!queued) {
+		va_start(args, message);
+		write_now(level, message, args);
+		va_end(args);
+	}
+
+	if (level == LOG_LEVEL_FATAL) {
+		log_flush();
+	}
+}
 
-	Platform_Console_Color color = level_colors[level];
-	if (is_error) {
-		platform_console_write_error(buffer2, color);
-	} else {
-		platform_console_write(buffer2, color);
+void log_flush(void) {
+	if (!atomic_load_u32(&logger.running, MEMORY_ORDER_ACQUIRE)) {
+		mutex_lock(&logger.sink_mutex);
+		if (logger.file) {
+			fflush(logger.file);
+		}
+		mutex_unlock(&logger.sink_mutex);
+		return;
 	}
+
+	u64 target = atomic_load_u64(&logger.head, MEMORY_ORDER_ACQUIRE);
+	mutex_lock(&logger.flush_mutex);
+	atomic_fetch_add_u32(&logger.flush_waiters, 1, MEMORY_ORDER_SEQ_CST);
+	while (atomic_load_u64(&logger.tail, MEMORY_ORDER_SEQ_CST) < target) {
+		wake_logger();
+		condvar_wait_timeout(&logger.flushed, &logger.flush_mutex, LOG_FLUSH_POLL_NS);
+	}
+	atomic_fetch_sub_u32(&logger.flush_waiters, 1, MEMORY_ORDER_SEQ_CST);
+	mutex_unlock(&logger.flush_mutex);
+}
+
+//
+// Sinks
+//
+
+void log_set_sinks(u32 sinks) {
+	mutex_lock(&logger.sink_mutex);
+	logger.sinks = sinks;
+	mutex_unlock(&logger.sink_mutex);
+}
+
+u32 log_get_sinks(void) {
+	mutex_lock(&logger.sink_mutex);
+	u32 sinks = logger.sinks;
+	mutex_unlock(&logger.sink_mutex);
+	return sinks;
+}
+
+b8 log_open_file(const char* path) {
+	u64 length = strlen(path);
+	if (length >= LOG_PATH_MAX) {
+		log_error("Log file path too long: %s", path);
+		return false;
+	}
+
+	// Messages already queued go to the file they were logged under
+	log_flush();
+
+	mutex_lock(&logger.sink_mutex);
+	if (logger.file) {
+		fclose(logger.file);
+	}
+	logger.file = fopen(path, "ab");
+	b8 opened = logger.file != null;
+	if (opened) {
+		memory_copy(logger.file_path, path, length + 1);
+		fseek(logger.file, 0, SEEK_END);
+		logger.file_size = (u64)ftell(logger.file);
+		logger.sinks |= LOG_SINK_FILE;
+	}
+	mutex_unlock(&logger.sink_mutex);
+
+	if (!opened) {
+		log_error("Failed to open log file %s", path);
+	}
+	return opened;
+}
+
+void log_close_file(void) {
+	log_flush();
+
+	mutex_lock(&logger.sink_mutex);
+	if (logger.file) {
+		fclose(logger.file);
+		logger.file = null;
+	}
+	logger.sinks &= ~LOG_SINK_FILE;
+	mutex_unlock(&logger.sink_mutex);
+}
+
+u64 log_read_memory(char* out, u64 size) {
+	if (size == 0) {
+		return 0;
+	}
+
+	mutex_lock(&logger.sink_mutex);
+	u64 written = logger.memory ? logger.memory_written : 0;
+	u64 available = written < LOG_MEMORY_SIZE ? written : LOG_MEMORY_SIZE;
+	u64 length = available < size - 1 ? available : size - 1;
+
+	u64 start = written - length;
+	for (u64 i = 0; i < length; i++) {
+		out[i] = logger.memory[(start + i) & (LOG_MEMORY_SIZE - 1)];
+	}
+	mutex_unlock(&logger.sink_mutex);
+
+	// Skip the partial line at the start, unless it is all there is
+	u64 skip = 0;
+	if (length < written) {
+		while (skip < length && out[skip] != '\n') {
+			skip++;
+		}
+		skip = skip < length ? skip + 1 : 0;
+	}
+	memmove(out, out + skip, length - skip);
+	out[length - skip] = '\0';
+	return length - skip;
+}
+
+void log_get_stats(Log_Stats* out_stats) {
+	mutex_lock(&logger.sink_mutex);
+	out_stats->written_count = logger.written_count;
+	out_stats->ring_peak = logger.ring_peak;
+	mutex_unlock(&logger.sink_mutex);
+	out_stats->dropped_count = atomic_load_u64(&logger.dropped, MEMORY_ORDER_RELAXED);
 }
@@ -3,11 +3,35 @@
 #include "core/export.h"
 #include "core/types.h"
 
+/**
+ * Logging.
+ *
+ * Log calls format their message into a lock-free ring, and a logger thread writes the ring out to the sinks: the
+ * console, a rotating file and a buffer of recent lines in memory. A burst of logging costs the calling thread a format
+ * and a copy instead of terminal I/O. When the ring is full, messages are dropped and counted, except errors, which are
+ * written on the calling thread instead. A fatal message flushes everything logged before it and is written before
+ * log_fatal returns, so it survives a crash that follows.
+ *
+ * Before log_init and after log_shutdown, messages are written on the calling thread.
+ */
+
 #define LOG_WARN_ENABLED  1
 #define LOG_INFO_ENABLED  1
 #define LOG_DEBUG_ENABLED 1
 #define LOG_TRACE_ENABLED 1
 
+// Writes messages on a logger thread instead of the calling thread
+#define LOG_ASYNC_ENABLED 1
+// Bytes of messages waiting for the logger thread. Must be a power of two.
+#define LOG_RING_SIZE mib(1)
+// Longer messages are truncated
+#define LOG_MESSAGE_MAX kib(32)
+// Bytes of recent lines kept by the memory sink
+#define LOG_MEMORY_SIZE kib(64)
+// A full log file moves to path.1, path.1 to path.2 and so on, keeping this many old files
+#define LOG_FILE_ROTATE_SIZE mib(16)
+#define LOG_FILE_KEEP_COUNT 3
+
 typedef enum Log_Level {
 	LOG_LEVEL_FATAL,
 	LOG_LEVEL_ERROR,
@@ -18,8 +42,64 @@ typedef enum Log_Level {
 	LOG_LEVEL_COUNT,
 } Log_Level;
 
+typedef enum Log_Sink {
+	LOG_SINK_CONSOLE = 1 << 0,
+	// Only written while a file is open
+	LOG_SINK_FILE = 1 << 1,
+	LOG_SINK_MEMORY = 1 << 2,
+} Log_Sink;
+
+typedef struct Log_Stats {
+	// Messages written to the sinks
+	u64 written_count;
+	// Messages lost to a full ring
+	u64 dropped_count;
+	// Most bytes seen waiting in the ring
+	u64 ring_peak;
+} Log_Stats;
+
+//
+// Lifecycle
+//
+
+// Starts the logger thread
+void log_init(void);
+
+// Writes out everything still queued and stops the logger thread
+void log_shutdown(void);
+
+//
+// Output
+//
+
 export void log_output(Log_Level level, const char* message, ...);
 
+// Waits until every message logged before the call has been written to the sinks
+export void log_flush(void);
+
+//
+// Sinks
+//
+
+// Takes a mask of Log_Sink flags. Console and memory are on by default.
+export void log_set_sinks(u32 sinks);
+
+export u32 log_get_sinks(void);
+
+// Appends to the file and turns on the file sink, closing any file already open
+export b8 log_open_file(const char* path);
+
+export void log_close_file(void);
+
+// Copies the most recent whole lines from the memory sink, oldest first and null terminated. Returns the length.
+export u64 log_read_memory(char* out, u64 size);
+
+export void log_get_stats(Log_Stats* out_stats);
+
+//
+// Levels
+//
+
 #define log_fatal(message, ...) log_output(LOG_LEVEL_FATAL, message, ##__VA_ARGS__)
 
 #define log_error(message, ...) log_output(LOG_LEVEL_ERROR, message, ##__VA_ARGS__)
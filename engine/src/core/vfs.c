@@ -0,0 +1,1064 @@
+#include "core/vfs.h"
+
+#include "core/log.h"
+#include "core/memory.h"
+#include "platform/platform_io.h"
+#include "platform/platform_thread.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define VFS_ARCHIVE_MAGIC "HPAK"
+#define VFS_ARCHIVE_VERSION 1
+// File data in archives starts on this boundary so loaders can read it in place
+#define VFS_ARCHIVE_ALIGNMENT 16
+
+// Slots in the path cache when it is first used, it doubles when three quarters full
+#define VFS_CACHE_CAPACITY 256
+// Paths the cache holds before it drops entries, so looking up ever new paths doesn't grow it without bound
+#define VFS_CACHE_ENTRY_MAX 16384
+// Parent directories of the executable searched for the engine's assets
+#define VFS_ASSET_SEARCH_DEPTH 4
+
+typedef struct Vfs_Archive_Header {
+	char magic[4];
+	u32 version;
+	u32 entry_count;
+	u32 reserved;
+	// Null terminated names, after the entries
+	u64 names_offset;
+	u64 names_size;
+} Vfs_Archive_Header;
+
+// Follows the header, sorted by hash
+typedef struct Vfs_Archive_Entry {
+	u64 hash;
+	u64 offset;
+	u64 size;
+	u32 name_offset;
+	u32 name_length;
+} Vfs_Archive_Entry;
+
+typedef struct Vfs_Mount {
+	Vfs_Mount_Type type;
+	char point[VFS_PATH_MAX];
+	u32 point_length;
+
+	// Directory mounts
+	char directory[VFS_PATH_MAX];
+
+	// Archive mounts
+	File_Map archive;
+	const Vfs_Archive_Entry* entries;
+	const char* names;
+	u32 entry_count;
+	u64 modified_ns;
+
+	// Memory mounts
+	const Vfs_Memory_File* files;
+	u32 file_count;
+} Vfs_Mount;
+
+typedef struct Vfs_Child {
+	u32 name_offset;
+	b8 is_directory;
+} Vfs_Child;
+
+// Names of a directory's children, each null terminated in one buffer
+typedef struct Vfs_Listing {
+	Vfs_Child* children;
+	u32 count;
+	u32 capacity;
+	char* names;
+	u64 names_size;
+	u64 names_capacity;
+} Vfs_Listing;
+
+typedef struct Vfs_Entry {
+	// Zero marks an empty slot
+	u64 hash;
+	char* path;
+	u32 path_length;
+
+	// Cleared by invalidation, the slot stays so probing never needs tombstones
+	b8 resolved;
+	// Newest mount that has the path, or -1 if none does
+	i32 mount;
+	File_Stat stat;
+
+	// Filled on the first vfs_list of a directory
+	b8 listed;
+	Vfs_Listing listing;
+} Vfs_Entry;
+
+typedef struct Vfs_System {
+	Mutex lock;
+
+	// Oldest first, searched newest first
+	Vfs_Mount mounts[VFS_MOUNT_MAX];
+	u32 mount_count;
+
+	// Open addressed on the path hash
+	Vfs_Entry* entries;
+	u32 entry_count;
+	u32 capacity;
+} Vfs_System;
+
+static Vfs_System vfs = {0};
+
+//
+// Paths
+//
+
+// FNV-1a, never zero
+static u64 hash_path(const char* path, u32 length) {
+	u64 hash = 0xCBF29CE484222325ull;
+	for (u32 i = 0; i < length; i++) {
+		hash ^= (u8)path[i];
+		hash *= 0x100000001B3ull;
+	}
+	return hash ? hash : 1;
+}
+
+// Joins the components with single forward slashes, dropping empty and "." components
+static b8 normalize(const char* path, char* out_path, u32* out_length) {
+	u32 length = 0;
+	const char* c = path;
+	while (*c) {
+		while (*c == '/' || *c == '\\') {
+			c++;
+		}
+		const char* start = c;
+		while (*c && *c != '/' && *c != '\\') {
+			c++;
+		}
+
+		u32 component = (u32)(c - start);
+		if (component == 0 || (component == 1 && start[0] == '.')) {
+			continue;
+		}
+		if (component == 2 && start[0] == '.' && start[1] == '.') {
+			log_error("Virtual paths can't leave their mount: %s", path);
+			return false;
+		}
+		if (length + component + 2 > VFS_PATH_MAX) {
+			log_error("Virtual path is too long: %s", path);
+			return false;
+		}
+
+		if (length > 0) {
+			out_path[length++] = '/';
+		}
+		memcpy(out_path + length, start, component);
+		length += component;
+	}
+
+	out_path[length] = 0;
+	*out_length = length;
+	return true;
+}
+
+// The path inside the mount, or null if the mount doesn't cover it
+static const char* mount_relative(const Vfs_Mount* mount, const char* path, u32 length) {
+	if (mount->point_length == 0) {
+		return path;
+	}
+	if (length < mount->point_length || memcmp(path, mount->point, mount->point_length) != 0) {
+		return null;
+	}
+	if (length == mount->point_length) {
+		return path + length;
+	}
+	return path[mount->point_length] == '/' ? path + mount->point_length + 1 : null;
+}
+
+// Whether the path is a directory above the mount point, which exists only to reach the mount
+static b8 is_mount_parent(const Vfs_Mount* mount, const char* path, u32 length) {
+	if (length >= mount->point_length) {
+		return false;
+	}
+	return length == 0 || (memcmp(mount->point, path, length) == 0 && mount->point[length] == '/');
+}
+
+static b8 directory_path(const Vfs_Mount* mount, const char* relative, char* out_path, u64 size) {
+	i32 written = *relative ? snprintf(out_path, size, "%s/%s", mount->directory, relative) :
+		snprintf(out_path, size, "%s", mount->directory);
+	return written >= 0 && (u64)written < size;
+}
+
+//
+// Listings
+//
+
+static void* grow(void* block, u64 used, u64 capacity, u64 new_capacity) {
+	void* grown = memory_alloc(new_capacity, MEMORY_TAG_ENGINE);
+	if (block) {
+		memory_copy(grown, block, used);
+		memory_free(block, capacity, MEMORY_TAG_ENGINE);
+	}
+	return grown;
+}
+
+static void listing_append(Vfs_Listing* listing, const char* name, u32 length, b8 is_directory) {
+	if (listing->count == listing->capacity) {
+		u32 capacity = listing->capacity ? listing->capacity * 2 : 16;
+		u64 size = sizeof(Vfs_Child) * listing->capacity;
+		listing->children = grow(listing->children, size, size, sizeof(Vfs_Child) * capacity);
+		listing->capacity = capacity;
+	}
+	if (listing->names_size + length + 1 > listing->names_capacity) {
+		u64 capacity = listing->names_capacity ? listing->names_capacity * 2 : 256;
+		while (capacity < listing->names_size + length + 1) {
+			capacity *= 2;
+		}
+		listing->names = grow(listing->names, listing->names_size, listing->names_capacity, capacity);
+		listing->names_capacity = capacity;
+	}
+
+	Vfs_Child* child = &listing->children[listing->count++];
+	child->name_offset = (u32)listing->names_size;
+	child->is_directory = is_directory;
+	memcpy(listing->names + listing->names_size, name, length);
+	listing->names[listing->names_size + length] = 0;
+	listing->names_size += length + 1;
+}
+
+// Newer mounts list first, so the first of a name wins
+static void listing_add(Vfs_Listing* listing, const char* name, u32 length, b8 is_directory) {
+	for (u32 i = 0; i < listing->count; i++) {
+		const char* existing = listing->names + listing->children[i].name_offset;
+		if (strncmp(existing, name, length) == 0 && existing[length] == 0) {
+			return;
+		}
+	}
+	listing_append(listing, name, length, is_directory);
+}
+
+static void listing_free(Vfs_Listing* listing) {
+	if (listing->children) {
+		memory_free(listing->children, sizeof(Vfs_Child) * listing->capacity, MEMORY_TAG_ENGINE);
+	}
+	if (listing->names) {
+		memory_free(listing->names, listing->names_capacity, MEMORY_TAG_ENGINE);
+	}
+	memory_zero(listing, sizeof(Vfs_Listing));
+}
+
+static void list_platform_child(const char* name, b8 is_directory, void* data) {
+	listing_add((Vfs_Listing*)data, name, (u32)strlen(name), is_directory);
+}
+
+//
+// Mount contents
+//
+
+static u32 mount_file_count(const Vfs_Mount* mount) {
+	return mount->type == VFS_MOUNT_ARCHIVE ? mount->entry_count : mount->file_count;
+}
+
+static const char* mount_file_name(const Vfs_Mount* mount, u32 index) {
+	return mount->type == VFS_MOUNT_ARCHIVE ? mount->names + mount->entries[index].name_offset : mount->files[index].path;
+}
+
+static const Vfs_Archive_Entry* find_archive_entry(const Vfs_Mount* mount, const char* name) {
+	u32 length = (u32)strlen(name);
+	u64 hash = hash_path(name, length);
+
+	u32 low = 0;
+	u32 high = mount->entry_count;
+	while (low < high) {
+		u32 middle = low + (high - low) / 2;
+		if (mount->entries[middle].hash < hash) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+
+	for (u32 i = low; i < mount->entry_count && mount->entries[i].hash == hash; i++) {
+		const Vfs_Archive_Entry* entry = &mount->entries[i];
+		if (entry->name_length == length && memcmp(mount->names + entry->name_offset, name, length) == 0) {
+			return entry;
+		}
+	}
+	return null;
+}
+
+static const Vfs_Memory_File* find_memory_file(const Vfs_Mount* mount, const char* name) {
+	for (u32 i = 0; i < mount->file_count; i++) {
+		if (strcmp(mount->files[i].path, name) == 0) {
+			return &mount->files[i];
+		}
+	}
+	return null;
+}
+
+// Archives and memory only hold files, their directories are the prefixes of the file names
+static b8 has_directory(const Vfs_Mount* mount, const char* relative) {
+	u64 length = strlen(relative);
+	u32 count = mount_file_count(mount);
+	for (u32 i = 0; i < count; i++) {
+		const char* name = mount_file_name(mount, i);
+		if (strncmp(name, relative, length) == 0 && name[length] == '/') {
+			return true;
+		}
+	}
+	return false;
+}
+
+static b8 stat_in_mount(const Vfs_Mount* mount, const char* relative, File_Stat* out_stat) {
+	if (mount->type == VFS_MOUNT_DIRECTORY) {
+		char path[VFS_PATH_MAX];
+		return directory_path(mount, relative, path, sizeof(path)) && platform_file_stat(path, out_stat);
+	}
+
+	out_stat->modified_ns = mount->modified_ns;
+	out_stat->size = 0;
+	out_stat->is_directory = true;
+	if (*relative == 0) {
+		return true;
+	}
+
+	if (mount->type == VFS_MOUNT_ARCHIVE) {
+		const Vfs_Archive_Entry* entry = find_archive_entry(mount, relative);
+		if (entry) {
+			out_stat->size = entry->size;
+			out_stat->is_directory = false;
+			return true;
+		}
+	} else {
+		const Vfs_Memory_File* file = find_memory_file(mount, relative);
+		if (file) {
+			out_stat->size = file->size;
+			out_stat->is_directory = false;
+			return true;
+		}
+	}
+	return has_directory(mount, relative);
+}
+
+static void list_in_mount(const Vfs_Mount* mount, const char* relative, Vfs_Listing* listing) {
+	if (mount->type == VFS_MOUNT_DIRECTORY) {
+		char path[VFS_PATH_MAX];
+		if (directory_path(mount, relative, path, sizeof(path))) {
+			platform_file_list(path, list_platform_child, listing);
+		}
+		return;
+	}
+
+	u64 length = strlen(relative);
+	u32 count = mount_file_count(mount);
+	for (u32 i = 0; i < count; i++) {
+		const char* name = mount_file_name(mount, i);
+		if (length > 0) {
+			if (strncmp(name, relative, length) != 0 || name[length] != '/') {
+				continue;
+			}
+			name += length + 1;
+		}
+		const char* separator = strchr(name, '/');
+		u32 name_length = separator ? (u32)(separator - name) : (u32)strlen(name);
+		listing_add(listing, name, name_length, separator != null);
+	}
+}
+
+//
+// Cache
+//
+
+static void invalidate(Vfs_Entry* entry) {
+	entry->resolved = false;
+	if (entry->listed) {
+		listing_free(&entry->listing);
+		entry->listed = false;
+	}
+}
+
+static void invalidate_all(void) {
+	for (u32 i = 0; i < vfs.capacity; i++) {
+		if (vfs.entries[i].hash) {
+			invalidate(&vfs.entries[i]);
+		}
+	}
+}
+
+static void free_entry(Vfs_Entry* entry) {
+	invalidate(entry);
+	memory_free(entry->path, entry->path_length + 1, MEMORY_TAG_ENGINE);
+	memory_zero(entry, sizeof(Vfs_Entry));
+}
+
+static void clear_cache(void) {
+	for (u32 i = 0; i < vfs.capacity; i++) {
+		if (vfs.entries[i].hash) {
+			free_entry(&vfs.entries[i]);
+		}
+	}
+	vfs.entry_count = 0;
+}
+
+// Misses and invalidated entries are the cheapest to look up again
+static b8 worth_keeping(const Vfs_Entry* entry) {
+	return entry->listed || (entry->resolved && entry->mount >= 0);
+}
+
+// Rehashes the entries into a table of the given capacity, when pruning only those worth keeping
+static void rebuild_cache(u32 capacity, b8 prune) {
+	Vfs_Entry* old_entries = vfs.entries;
+	u32 old_capacity = vfs.capacity;
+
+	vfs.capacity = capacity;
+	vfs.entries = memory_alloc(sizeof(Vfs_Entry) * vfs.capacity, MEMORY_TAG_ENGINE);
+	memory_zero(vfs.entries, sizeof(Vfs_Entry) * vfs.capacity);
+
+	u32 mask = vfs.capacity - 1;
+	for (u32 i = 0; i < old_capacity; i++) {
+		if (!old_entries[i].hash) {
+			continue;
+		}
+		if (prune && !worth_keeping(&old_entries[i])) {
+			free_entry(&old_entries[i]);
+			vfs.entry_count--;
+			continue;
+		}
+		u32 slot = (u32)old_entries[i].hash & mask;
+		while (vfs.entries[slot].hash) {
+			slot = (slot + 1) & mask;
+		}
+		vfs.entries[slot] = old_entries[i];
+	}
+	if (old_entries) {
+		memory_free(old_entries, sizeof(Vfs_Entry) * old_capacity, MEMORY_TAG_ENGINE);
+	}
+}
+
+// Finds the path's entry, adding it when create is set. Called with the lock held.
+static Vfs_Entry* find_entry(const char* path, u32 length, b8 create) {
+	if (create && vfs.entry_count >= VFS_CACHE_ENTRY_MAX) {
+		// Misses go first, and everything if that isn't enough to make real room
+		rebuild_cache(vfs.capacity, true);
+		if (vfs.entry_count >= VFS_CACHE_ENTRY_MAX / 2) {
+			clear_cache();
+		}
+	}
+	if (create && (vfs.entry_count + 1) * 4 > vfs.capacity * 3) {
+		rebuild_cache(vfs.capacity ? vfs.capacity * 2 : VFS_CACHE_CAPACITY, false);
+	}
+	if (vfs.capacity == 0) {
+		return null;
+	}
+
+	u64 hash = hash_path(path, length);
+	u32 mask = vfs.capacity - 1;
+	for (u32 slot = (u32)hash & mask;; slot = (slot + 1) & mask) {
+		Vfs_Entry* entry = &vfs.entries[slot];
+		if (entry->hash == hash && entry->path_length == length && memcmp(entry->path, path, length) == 0) {
+			return entry;
+		}
+		if (entry->hash) {
+			continue;
+		}
+		if (!create) {
+			return null;
+		}
+
+		entry->hash = hash;
+		entry->path = memory_alloc(length + 1, MEMORY_TAG_ENGINE);
+		memcpy(entry->path, path, length + 1);
+		entry->path_length = length;
+		vfs.entry_count++;
+		return entry;
+	}
+}
+
+static void resolve(Vfs_Entry* entry) {
+	entry->mount = -1;
+	memory_zero(&entry->stat, sizeof(File_Stat));
+
+	for (i32 i = (i32)vfs.mount_count - 1; i >= 0; i--) {
+		const Vfs_Mount* mount = &vfs.mounts[i];
+		const char* relative = mount_relative(mount, entry->path, entry->path_length);
+		if (relative && stat_in_mount(mount, relative, &entry->stat)) {
+			entry->mount = i;
+			break;
+		}
+		if (!relative && is_mount_parent(mount, entry->path, entry->path_length)) {
+			entry->stat.is_directory = true;
+			entry->mount = i;
+			break;
+		}
+	}
+	entry->resolved = true;
+}
+
+// Called with the lock held
+static Vfs_Entry* lookup(const char* path, u32 length) {
+	Vfs_Entry* entry = find_entry(path, length, true);
+	if (!entry->resolved) {
+		resolve(entry);
+	}
+	return entry;
+}
+
+static void build_listing(Vfs_Entry* entry) {
+	for (i32 i = (i32)vfs.mount_count - 1; i >= 0; i--) {
+		const Vfs_Mount* mount = &vfs.mounts[i];
+		const char* relative = mount_relative(mount, entry->path, entry->path_length);
+		if (relative) {
+			list_in_mount(mount, relative, &entry->listing);
+		} else if (is_mount_parent(mount, entry->path, entry->path_length)) {
+			const char* name = mount->point + entry->path_length + (entry->path_length > 0);
+			const char* separator = strchr(name, '/');
+			listing_add(&entry->listing, name, separator ? (u32)(separator - name) : (u32)strlen(name), true);
+		}
+	}
+	entry->listed = true;
+}
+
+//
+// Lifecycle
+//
+
+void vfs_init(void) {
+	vfs_mount_directory("", ".");
+
+	// Builds put executables a level or two below the repository, so look upwards for the engine's assets
+	char directory[VFS_PATH_MAX];
+	if (!platform_get_executable_directory(directory, sizeof(directory))) {
+		return;
+	}
+	for (u32 depth = 0; depth < VFS_ASSET_SEARCH_DEPTH; depth++) {
+		char assets[VFS_PATH_MAX];
+		File_Stat stat;
+		i32 written = snprintf(assets, sizeof(assets), "%s/engine/assets", directory);
+		if (written > 0 && (u64)written < sizeof(assets) && platform_file_stat(assets, &stat) && stat.is_directory) {
+			vfs_mount_directory("engine/assets", assets);
+			return;
+		}
+
+		char* separator = strrchr(directory, '/');
+		char* backslash = strrchr(directory, '\\');
+		if (backslash > separator) {
+			separator = backslash;
+		}
+		if (!separator || separator == directory) {
+			return;
+		}
+		*separator = 0;
+	}
+}
+
+void vfs_shutdown(void) {
+	mutex_lock(&vfs.lock);
+	for (u32 i = 0; i < vfs.mount_count; i++) {
+		if (vfs.mounts[i].type == VFS_MOUNT_ARCHIVE) {
+			platform_file_unmap(&vfs.mounts[i].archive);
+		}
+	}
+	vfs.mount_count = 0;
+
+	clear_cache();
+	if (vfs.entries) {
+		memory_free(vfs.entries, sizeof(Vfs_Entry) * vfs.capacity, MEMORY_TAG_ENGINE);
+	}
+	vfs.entries = null;
+	vfs.capacity = 0;
+	mutex_unlock(&vfs.lock);
+}
+
+//
+// Mounts
+//
+
+// Called with the lock held. Every cached lookup may resolve differently afterwards.
+static Vfs_Mount* add_mount(const char* mount_point, Vfs_Mount_Type type) {
+	if (vfs.mount_count == VFS_MOUNT_MAX) {
+		log_error("Can't mount more than %u sources", VFS_MOUNT_MAX);
+		return null;
+	}
+
+	char point[VFS_PATH_MAX];
+	u32 point_length;
+	if (!normalize(mount_point, point, &point_length)) {
+		return null;
+	}
+
+	Vfs_Mount* mount = &vfs.mounts[vfs.mount_count++];
+	memory_zero(mount, sizeof(Vfs_Mount));
+	mount->type = type;
+	memcpy(mount->point, point, point_length + 1);
+	mount->point_length = point_length;
+
+	invalidate_all();
+	return mount;
+}
+
+b8 vfs_mount_directory(const char* mount_point, const char* directory) {
+	File_Stat stat;
+	if (!platform_file_stat(directory, &stat) || !stat.is_directory) {
+		log_error("Can't mount %s, it isn't a directory", directory);
+		return false;
+	}
+
+	u64 length = strlen(directory);
+	while (length > 1 && (directory[length - 1] == '/' || directory[length - 1] == '\\')) {
+		length--;
+	}
+	if (length >= VFS_PATH_MAX) {
+		log_error("Can't mount %s, the path is too long", directory);
+		return false;
+	}
+
+	mutex_lock(&vfs.lock);
+	Vfs_Mount* mount = add_mount(mount_point, VFS_MOUNT_DIRECTORY);
+	if (mount) {
+		memcpy(mount->directory, directory, length);
+		mount->directory[length] = 0;
+	}
+	mutex_unlock(&vfs.lock);
+
+	if (mount) {
+		log_debug("Mounted %s at /%s", directory, mount_point);
+	}
+	return mount != null;
+}
+
+b8 vfs_mount_archive(const char* mount_point, const char* archive_path) {
+	File_Map archive;
+	if (!platform_file_map(archive_path, FILE_MAP_READ_ONLY, &archive)) {
+		return false;
+	}
+
+	const Vfs_Archive_Header* header = (const Vfs_Archive_Header*)archive.data;
+	b8 valid = archive.size >= sizeof(Vfs_Archive_Header) && memcmp(header->magic, VFS_ARCHIVE_MAGIC, 4) == 0;
+	if (!valid || header->version != VFS_ARCHIVE_VERSION) {
+		log_error("%s is not a version %u archive", archive_path, VFS_ARCHIVE_VERSION);
+		platform_file_unmap(&archive);
+		return false;
+	}
+
+	// Offsets and sizes come from the file, so every bound is checked without adding them up where that could wrap
+	u64 entries_end = sizeof(Vfs_Archive_Header) + (u64)header->entry_count * sizeof(Vfs_Archive_Entry);
+	b8 fits = header->names_offset >= entries_end && header->names_offset <= archive.size &&
+		header->names_size <= archive.size - header->names_offset;
+	const Vfs_Archive_Entry* entries = (const Vfs_Archive_Entry*)(header + 1);
+	const char* names = (const char*)archive.data + header->names_offset;
+	for (u32 i = 0; fits && i < header->entry_count; i++) {
+		u64 name_end = (u64)entries[i].name_offset + entries[i].name_length;
+		fits = name_end < header->names_size && names[name_end] == 0 && entries[i].offset <= archive.size &&
+			entries[i].size <= archive.size - entries[i].offset;
+	}
+	if (!fits) {
+		log_error("%s is truncated or corrupt", archive_path);
+		platform_file_unmap(&archive);
+		return false;
+	}
+
+	File_Stat stat;
+	if (!platform_file_stat(archive_path, &stat)) {
+		stat.modified_ns = 0;
+	}
+
+	mutex_lock(&vfs.lock);
+	Vfs_Mount* mount = add_mount(mount_point, VFS_MOUNT_ARCHIVE);
+	if (mount) {
+		mount->archive = archive;
+		mount->entries = entries;
+		mount->names = names;
+		mount->entry_count = header->entry_count;
+		mount->modified_ns = stat.modified_ns;
+	}
+	mutex_unlock(&vfs.lock);
+
+	if (!mount) {
+		platform_file_unmap(&archive);
+		return false;
+	}
+	log_debug("Mounted %s with %u files at /%s", archive_path, header->entry_count, mount_point);
+	return true;
+}
+
+b8 vfs_mount_memory(const char* mount_point, const Vfs_Memory_File* files, u32 count) {
+	mutex_lock(&vfs.lock);
+	Vfs_Mount* mount = add_mount(mount_point, VFS_MOUNT_MEMORY);
+	if (mount) {
+		mount->files = files;
+		mount->file_count = count;
+	}
+	mutex_unlock(&vfs.lock);
+	return mount != null;
+}
+
+b8 vfs_unmount(const char* mount_point) {
+	char point[VFS_PATH_MAX];
+	u32 point_length;
+	if (!normalize(mount_point, point, &point_length)) {
+		return false;
+	}
+
+	mutex_lock(&vfs.lock);
+	i32 index = -1;
+	for (i32 i = (i32)vfs.mount_count - 1; i >= 0; i--) {
+		if (vfs.mounts[i].point_length == point_length && memcmp(vfs.mounts[i].point, point, point_length) == 0) {
+			index = i;
+			break;
+		}
+	}
+	if (index >= 0) {
+		if (vfs.mounts[index].type == VFS_MOUNT_ARCHIVE) {
+			platform_file_unmap(&vfs.mounts[index].archive);
+		}
+		for (u32 i = (u32)index; i + 1 < vfs.mount_count; i++) {
+			vfs.mounts[i] = vfs.mounts[i + 1];
+		}
+		vfs.mount_count--;
+		invalidate_all();
+	}
+	mutex_unlock(&vfs.lock);
+	return index >= 0;
+}
+
+//
+// Metadata
+//
+
+b8 vfs_exists(const char* path) {
+	return vfs_stat(path, null);
+}
+
+b8 vfs_stat(const char* path, File_Stat* out_stat) {
+	char normalized[VFS_PATH_MAX];
+	u32 length;
+	if (!normalize(path, normalized, &length)) {
+		return false;
+	}
+
+	mutex_lock(&vfs.lock);
+	Vfs_Entry* entry = lookup(normalized, length);
+	b8 found = entry->mount >= 0;
+	if (found && out_stat) {
+		*out_stat = entry->stat;
+	}
+	mutex_unlock(&vfs.lock);
+	return found;
+}
+
+b8 vfs_list(const char* directory, File_List_Callback callback, void* data) {
+	char normalized[VFS_PATH_MAX];
+	u32 length;
+	if (!normalize(directory, normalized, &length)) {
+		return false;
+	}
+
+	mutex_lock(&vfs.lock);
+	Vfs_Entry* entry = lookup(normalized, length);
+	if (entry->mount < 0 || !entry->stat.is_directory) {
+		mutex_unlock(&vfs.lock);
+		return false;
+	}
+	if (!entry->listed) {
+		build_listing(entry);
+	}
+
+	// Copied so the callback can use the VFS
+	Vfs_Listing listing = {0};
+	for (u32 i = 0; i < entry->listing.count; i++) {
+		const Vfs_Child* child = &entry->listing.children[i];
+		const char* name = entry->listing.names + child->name_offset;
+		listing_append(&listing, name, (u32)strlen(name), child->is_directory);
+	}
+	mutex_unlock(&vfs.lock);
+
+	for (u32 i = 0; i < listing.count; i++) {
+		callback(listing.names + listing.children[i].name_offset, listing.children[i].is_directory, data);
+	}
+	listing_free(&listing);
+	return true;
+}
+
+b8 vfs_resolve(const char* path, char* out_path, u64 size) {
+	char normalized[VFS_PATH_MAX];
+	u32 length;
+	if (!normalize(path, normalized, &length)) {
+		return false;
+	}
+
+	mutex_lock(&vfs.lock);
+	Vfs_Entry* entry = lookup(normalized, length);
+	b8 resolved = false;
+	if (entry->mount >= 0 && vfs.mounts[entry->mount].type == VFS_MOUNT_DIRECTORY) {
+		const Vfs_Mount* mount = &vfs.mounts[entry->mount];
+		const char* relative = mount_relative(mount, normalized, length);
+		resolved = relative && directory_path(mount, relative, out_path, size);
+	}
+	mutex_unlock(&vfs.lock);
+	return resolved;
+}
+
+void vfs_invalidate(const char* path) {
+	char normalized[VFS_PATH_MAX];
+	u32 length;
+	if (!normalize(path, normalized, &length)) {
+		return;
+	}
+
+	mutex_lock(&vfs.lock);
+	Vfs_Entry* entry = find_entry(normalized, length, false);
+	if (entry) {
+		invalidate(entry);
+	}
+
+	// The parent's listing gains or loses the name when the path is created or deleted
+	char* separator = strrchr(normalized, '/');
+	u32 parent_length = separator ? (u32)(separator - normalized) : 0;
+	if (length > 0) {
+		Vfs_Entry* parent = find_entry(normalized, parent_length, false);
+		if (parent) {
+			invalidate(parent);
+		}
+	}
+	mutex_unlock(&vfs.lock);
+}
+
+void vfs_invalidate_all(void) {
+	mutex_lock(&vfs.lock);
+	invalidate_all();
+	mutex_unlock(&vfs.lock);
+}
+
+//
+// Loading
+//
+
+typedef struct Vfs_Location {
+	Vfs_Mount_Type type;
+	u64 size;
+	// Directory mounts
+	char path[VFS_PATH_MAX];
+	// Archive and memory mounts
+	const void* data;
+} Vfs_Location;
+
+static b8 locate(const char* path, Vfs_Location* out_location) {
+	char normalized[VFS_PATH_MAX];
+	u32 length;
+	if (!normalize(path, normalized, &length)) {
+		return false;
+	}
+
+	mutex_lock(&vfs.lock);
+	Vfs_Entry* entry = lookup(normalized, length);
+	if (entry->mount < 0 || entry->stat.is_directory) {
+		mutex_unlock(&vfs.lock);
+		log_error(entry->mount < 0 ? "File not found: %s" : "Can't load %s, it is a directory", path);
+		return false;
+	}
+
+	const Vfs_Mount* mount = &vfs.mounts[entry->mount];
+	const char* relative = mount_relative(mount, normalized, length);
+	out_location->type = mount->type;
+	out_location->size = entry->stat.size;
+	out_location->data = null;
+	b8 located = true;
+	if (mount->type == VFS_MOUNT_DIRECTORY) {
+		located = directory_path(mount, relative, out_location->path, sizeof(out_location->path));
+	} else if (mount->type == VFS_MOUNT_ARCHIVE) {
+		out_location->data = (const u8*)mount->archive.data + find_archive_entry(mount, relative)->offset;
+	} else {
+		out_location->data = find_memory_file(mount, relative)->data;
+	}
+	mutex_unlock(&vfs.lock);
+	return located;
+}
+
+b8 vfs_map(const char* path, Vfs_File* out_file) {
+	memory_zero(out_file, sizeof(Vfs_File));
+
+	Vfs_Location location;
+	if (!locate(path, &location)) {
+		return false;
+	}
+
+	if (location.type == VFS_MOUNT_DIRECTORY) {
+		if (!platform_file_map(location.path, FILE_MAP_READ_ONLY, &out_file->map)) {
+			return false;
+		}
+		out_file->data = out_file->map.data;
+		out_file->size = out_file->map.size;
+		return true;
+	}
+
+	out_file->data = location.data;
+	out_file->size = location.size;
+	return true;
+}
+
+b8 vfs_read(const char* path, Vfs_File* out_file) {
+	memory_zero(out_file, sizeof(Vfs_File));
+
+	Vfs_Location location;
+	if (!locate(path, &location)) {
+		return false;
+	}
+
+	// Sized from the cached stat, so a file that grew since it was cached needs invalidating first
+	out_file->buffer_size = location.size + 1;
+	out_file->buffer = memory_alloc(out_file->buffer_size, MEMORY_TAG_ENGINE);
+	u64 size = location.size;
+	if (location.type == VFS_MOUNT_DIRECTORY) {
+		i64 result = platform_io_read_blocking(location.path, out_file->buffer, 0, location.size);
+		if (result < 0) {
+			log_error("Failed to read %s: %s", location.path, strerror((i32)-result));
+			vfs_release(out_file);
+			return false;
+		}
+		size = (u64)result;
+	} else {
+		memory_copy(out_file->buffer, location.data, location.size);
+	}
+
+	((char*)out_file->buffer)[size] = 0;
+	out_file->data = out_file->buffer;
+	out_file->size = size;
+	return true;
+}
+
+void vfs_release(Vfs_File* file) {
+	if (file->map.data) {
+		platform_file_unmap(&file->map);
+	}
+	if (file->buffer) {
+		memory_free(file->buffer, file->buffer_size, MEMORY_TAG_ENGINE);
+	}
+	memory_zero(file, sizeof(Vfs_File));
+}
+
+//
+// Archives
+//
+
+typedef struct Vfs_Pack {
+	const char* root;
+	// Relative path of the directory being walked
+	char relative[VFS_PATH_MAX];
+	u32 relative_length;
+	Vfs_Listing files;
+	b8 failed;
+} Vfs_Pack;
+
+static void pack_visit(const char* name, b8 is_directory, void* data) {
+	Vfs_Pack* pack = (Vfs_Pack*)data;
+	u32 saved_length = pack->relative_length;
+	u32 length = (u32)strlen(name);
+	if (saved_length + length + 2 > VFS_PATH_MAX) {
+		log_error("Path is too long to pack: %s/%s", pack->relative, name);
+		pack->failed = true;
+		return;
+	}
+
+	if (saved_length > 0) {
+		pack->relative[pack->relative_length++] = '/';
+	}
+	memcpy(pack->relative + pack->relative_length, name, length + 1);
+	pack->relative_length += length;
+
+	if (is_directory) {
+		char path[VFS_PATH_MAX * 2];
+		snprintf(path, sizeof(path), "%s/%s", pack->root, pack->relative);
+		platform_file_list(path, pack_visit, pack);
+	} else {
+		listing_append(&pack->files, pack->relative, pack->relative_length, false);
+	}
+
+	pack->relative_length = saved_length;
+	pack->relative[saved_length] = 0;
+}
+
+static int compare_entries(const void* a, const void* b) {
+	u64 x = ((const Vfs_Archive_Entry*)a)->hash;
+	u64 y = ((const Vfs_Archive_Entry*)b)->hash;
+	return x < y ? -1 : x > y;
+}
+
+static u64 align_offset(u64 offset) {
+	return (offset + VFS_ARCHIVE_ALIGNMENT - 1) & ~(u64)(VFS_ARCHIVE_ALIGNMENT - 1);
+}
+
+b8 vfs_pack_directory(const char* directory, const char* archive_path) {
+	Vfs_Pack pack = {0};
+	pack.root = directory;
+	if (!platform_file_list(directory, pack_visit, &pack) || pack.failed) {
+		log_error("Failed to list %s for packing", directory);
+		listing_free(&pack.files);
+		return false;
+	}
+
+	u32 count = pack.files.count;
+	u64 entries_size = sizeof(Vfs_Archive_Entry) * (count ? count : 1);
+	Vfs_Archive_Entry* entries = memory_alloc(entries_size, MEMORY_TAG_ENGINE);
+	char path[VFS_PATH_MAX * 2];
+	b8 success = true;
+	for (u32 i = 0; i < count && success; i++) {
+		const char* name = pack.files.names + pack.files.children[i].name_offset;
+		File_Stat stat;
+		snprintf(path, sizeof(path), "%s/%s", directory, name);
+		success = platform_file_stat(path, &stat);
+		entries[i].name_offset = pack.files.children[i].name_offset;
+		entries[i].name_length = (u32)strlen(name);
+		entries[i].hash = hash_path(name, entries[i].name_length);
+		entries[i].size = stat.size;
+	}
+	qsort(entries, count, sizeof(Vfs_Archive_Entry), compare_entries);
+
+	Vfs_Archive_Header header = {0};
+	memcpy(header.magic, VFS_ARCHIVE_MAGIC, 4);
+	header.version = VFS_ARCHIVE_VERSION;
+	header.entry_count = count;
+	header.names_offset = sizeof(Vfs_Archive_Header) + sizeof(Vfs_Archive_Entry) * count;
+	header.names_size = pack.files.names_size;
+	u64 offset = header.names_offset + header.names_size;
+	for (u32 i = 0; i < count; i++) {
+		offset = align_offset(offset);
+		entries[i].offset = offset;
+		offset += entries[i].size;
+	}
+
+	FILE* file = success ? fopen(archive_path, "wb") : null;
+	if (!file) {
+		log_error("Failed to create archive %s", archive_path);
+		success = false;
+	} else {
+		fwrite(&header, sizeof(header), 1, file);
+		fwrite(entries, sizeof(Vfs_Archive_Entry), count, file);
+		fwrite(pack.files.names, 1, pack.files.names_size, file);
+
+		static const u8 padding[VFS_ARCHIVE_ALIGNMENT] = {0};
+		u64 written = header.names_offset + header.names_size;
+		for (u32 i = 0; i < count && success; i++) {
+			fwrite(padding, 1, entries[i].offset - written, file);
+			snprintf(path, sizeof(path), "%s/%s", directory, pack.files.names + entries[i].name_offset);
+			File_Map map;
+			success = platform_file_map(path, FILE_MAP_READ_ONLY, &map) && map.size == entries[i].size;
+			if (success) {
+				success = fwrite(map.data, 1, map.size, file) == map.size;
+			}
+			if (map.data) {
+				platform_file_unmap(&map);
+			}
+			written = entries[i].offset + entries[i].size;
+		}
+		success = fclose(file) == 0 && success;
+		if (!success) {
+			log_error("Failed to write archive %s", archive_path);
+			remove(archive_path);
+		}
+	}
+
+	memory_free(entries, entries_size, MEMORY_TAG_ENGINE);
+	listing_free(&pack.files);
+	if (success) {
+		log_info("Packed %u files from %s into %s", count, directory, archive_path);
+	}
+	return success;
+}
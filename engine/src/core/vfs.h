@@ -0,0 +1,113 @@
+#pragma once
+
+#include "core/export.h"
+#include "core/types.h"
+#include "platform/platform_file.h"
+
+/**
+ * Virtual file system.
+ *
+ * Loaders name files by virtual paths like "engine/assets/shaders/basic.vert", which resolve through an ordered list
+ * of mounts rather than the working directory. A mount serves a directory on disk, a packed archive or a table of
+ * files in memory under a mount point. Later mounts shadow earlier ones, so a patch archive mounted last overrides the
+ * base assets.
+ *
+ * Lookups are cached in a table keyed by the hash of the normalized path, holding the mount that has the path and its
+ * stat data, misses included. Directory listings are merged across mounts and cached on the same entries. Repeated
+ * existence checks cost a hash lookup and no syscalls, so files changing on disk need a vfs_invalidate. The cache holds
+ * a bounded number of paths, and once full drops its misses first.
+ *
+ * Virtual paths are relative, may use either slash and may not contain "..". Mounts should not change while loads
+ * from them are in flight on other threads.
+ */
+
+#define VFS_MOUNT_MAX 16
+#define VFS_PATH_MAX 512
+
+typedef enum Vfs_Mount_Type {
+	VFS_MOUNT_DIRECTORY,
+	// Written by vfs_pack_directory and mapped whole
+	VFS_MOUNT_ARCHIVE,
+	VFS_MOUNT_MEMORY,
+} Vfs_Mount_Type;
+
+typedef struct Vfs_Memory_File {
+	// Relative to the mount point, with forward slashes
+	const char* path;
+	const void* data;
+	u64 size;
+} Vfs_Memory_File;
+
+typedef struct Vfs_File {
+	const void* data;
+	u64 size;
+
+	// Whatever has to be released with the file
+	File_Map map;
+	void* buffer;
+	u64 buffer_size;
+} Vfs_File;
+
+//
+// Lifecycle
+//
+
+// Mounts the working directory, and the engine's assets found from the executable so apps run from anywhere
+void vfs_init(void);
+
+void vfs_shutdown(void);
+
+//
+// Mounts
+//
+
+// An empty mount point mounts at the root
+export b8 vfs_mount_directory(const char* mount_point, const char* directory);
+
+export b8 vfs_mount_archive(const char* mount_point, const char* archive_path);
+
+// The table, its paths and the data must outlive the mount
+export b8 vfs_mount_memory(const char* mount_point, const Vfs_Memory_File* files, u32 count);
+
+// Removes the newest mount at the mount point
+export b8 vfs_unmount(const char* mount_point);
+
+//
+// Metadata
+//
+
+export b8 vfs_exists(const char* path);
+
+export b8 vfs_stat(const char* path, File_Stat* out_stat);
+
+// Lists a directory merged across every mount that has it, each name once
+export b8 vfs_list(const char* directory, File_List_Callback callback, void* data);
+
+// Writes the OS path of a file served from a directory mount, for APIs that need a real path. Fails for archives and
+// memory.
+export b8 vfs_resolve(const char* path, char* out_path, u64 size);
+
+// Drops the cached metadata of a path and the listing of its parent, after it changed on disk
+export void vfs_invalidate(const char* path);
+
+export void vfs_invalidate_all(void);
+
+//
+// Loading
+//
+
+// Maps the file from its directory or archive, or points at it in memory. The data is not null terminated.
+export b8 vfs_map(const char* path, Vfs_File* out_file);
+
+// Copies the file into a buffer with a null terminator after the data
+export b8 vfs_read(const char* path, Vfs_File* out_file);
+
+// Releases a file from vfs_map or vfs_read
+export void vfs_release(Vfs_File* file);
+
+//
+// Archives
+//
+
+// Packs every file under a directory into an archive for vfs_mount_archive
+export b8 vfs_pack_directory(const char* directory, const char* archive_path);
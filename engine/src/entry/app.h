@@ -12,6 +12,13 @@ typedef struct Window_Config {
 typedef struct App_Config {
 	const char* name;
 	Window_Config window;
+	// Frames per second the main loop is limited to, zero for unlimited
+	f32 target_frame_rate;
+	// Runs with no window or GL context. Also enabled by setting HAUNT_HEADLESS=1 in the environment.
+	b8 headless;
+	// Renders into an offscreen framebuffer the size of the window, with no window. Also enabled by setting
+	// HAUNT_OFFSCREEN=1 in the environment.
+	b8 offscreen;
 } App_Config;
 
 typedef enum App_Result {
@@ -20,14 +27,39 @@ typedef enum App_Result {
 	APP_RESULT_CONTINUE,
 } App_Result;
 
-extern App_Config app_config(void);
+// Apps built as a module with APP_MODULE export their functions for the engine to look up
+#if defined(APP_MODULE) && defined(_MSC_VER)
+#	define app_export __declspec(dllexport)
+#else
+#	define app_export
+#endif
 
-extern App_Result app_start(void** state, int argc, char** argv);
+app_export extern App_Config app_config(void);
 
-extern App_Result app_update(void* state);
+app_export extern App_Result app_start(void** state, int argc, char** argv);
 
-extern App_Result app_render(void* state);
+app_export extern App_Result app_update(void* state);
 
-extern App_Result app_on_resize(void* state);
+app_export extern App_Result app_render(void* state);
 
-extern App_Result app_shutdown(void* state);
+app_export extern App_Result app_on_resize(void* state);
+
+app_export extern App_Result app_shutdown(void* state);
+
+// Optional, only looked up in app modules. Called with the state before the module is unloaded for a reload, and
+// after the new build is loaded, to drop and restore anything pointing into the module's code, like event handlers.
+app_export extern void app_on_unload(void* state);
+
+app_export extern void app_on_reload(void* state);
+
+typedef struct App_Functions {
+	App_Config (*config)(void);
+	App_Result (*start)(void** state, int argc, char** argv);
+	App_Result (*update)(void* state);
+	App_Result (*render)(void* state);
+	App_Result (*on_resize)(void* state);
+	App_Result (*shutdown)(void* state);
+	// Null when the app doesn't have them
+	void (*on_unload)(void* state);
+	void (*on_reload)(void* state);
+} App_Functions;
@@ -0,0 +1,140 @@
+#include "entry/app_module.h"
+
+#include "core/log.h"
+#include "core/memory.h"
+#include "platform/platform.h"
+#include "platform/platform_file.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Copies the build so the original can be overwritten while the copy is loaded
+static b8 copy_build(const char* from, const char* to) {
+	File_Map map;
+	if (!platform_file_map(from, FILE_MAP_READ_ONLY, &map)) {
+		return false;
+	}
+
+	FILE* file = fopen(to, "wb");
+	b8 success = file && fwrite(map.data, 1, map.size, file) == map.size;
+	if (file) {
+		success = fclose(file) == 0 && success;
+	}
+	platform_file_unmap(&map);
+
+	if (!success) {
+		log_error("Failed to copy %s to %s", from, to);
+		remove(to);
+	}
+	return success;
+}
+
+// Loads the current build into library, functions and loaded_path without touching the module
+static b8 load_build(App_Module* module, u32 version, Library* out_library, App_Functions* out_functions, char* out_path) {
+	snprintf(out_path, APP_MODULE_PATH_MAX, "%s.%u.live", module->path, version);
+	if (!copy_build(module->path, out_path)) {
+		return false;
+	}
+	if (!platform_library_load(out_path, out_library)) {
+		remove(out_path);
+		return false;
+	}
+
+	out_functions->config = (App_Config(*)(void))platform_library_symbol(out_library, "app_config");
+	out_functions->start = (App_Result(*)(void**, int, char**))platform_library_symbol(out_library, "app_start");
+	out_functions->update = (App_Result(*)(void*))platform_library_symbol(out_library, "app_update");
+	out_functions->render = (App_Result(*)(void*))platform_library_symbol(out_library, "app_render");
+	out_functions->on_resize = (App_Result(*)(void*))platform_library_symbol(out_library, "app_on_resize");
+	out_functions->shutdown = (App_Result(*)(void*))platform_library_symbol(out_library, "app_shutdown");
+	out_functions->on_unload = (void (*)(void*))platform_library_symbol(out_library, "app_on_unload");
+	out_functions->on_reload = (void (*)(void*))platform_library_symbol(out_library, "app_on_reload");
+
+	if (!out_functions->config || !out_functions->start || !out_functions->update || !out_functions->render ||
+		!out_functions->on_resize || !out_functions->shutdown) {
+		log_error("%s is missing app functions", module->path);
+		platform_library_unload(out_library);
+		remove(out_path);
+		return false;
+	}
+	return true;
+}
+
+b8 app_module_load(App_Module* module, const char* path) {
+	memory_zero(module, sizeof(App_Module));
+	if (strlen(path) + 16 >= APP_MODULE_PATH_MAX) {
+		log_error("App module path is too long: %s", path);
+		return false;
+	}
+	strcpy(module->path, path);
+
+	File_Stat stat;
+	if (!platform_file_stat(path, &stat)) {
+		log_error("App module not found: %s", path);
+		return false;
+	}
+	if (!load_build(module, module->version, &module->library, &module->functions, module->loaded_path)) {
+		return false;
+	}
+
+	module->modified_ns = stat.modified_ns;
+	module->pending_modified_ns = stat.modified_ns;
+	module->next_poll_ns = platform_get_time_ns() + APP_MODULE_POLL_MS * 1000000ull;
+	log_info("Loaded app module %s", path);
+	return true;
+}
+
+b8 app_module_update(App_Module* module, void* state) {
+	u64 now = platform_get_time_ns();
+	if (!module->library.handle || now < module->next_poll_ns) {
+		return false;
+	}
+	module->next_poll_ns = now + APP_MODULE_POLL_MS * 1000000ull;
+
+	// Linkers write the library in pieces, so wait for a poll where it didn't change
+	File_Stat stat;
+	if (!platform_file_stat(module->path, &stat) || stat.modified_ns == module->modified_ns) {
+		return false;
+	}
+	if (stat.modified_ns != module->pending_modified_ns) {
+		module->pending_modified_ns = stat.modified_ns;
+		return false;
+	}
+
+	u64 start = platform_get_time_ns();
+	// Not retried until the library changes again
+	module->modified_ns = stat.modified_ns;
+
+	Library library;
+	App_Functions functions;
+	char loaded_path[APP_MODULE_PATH_MAX];
+	if (!load_build(module, module->version + 1, &library, &functions, loaded_path)) {
+		log_error("Keeping the running build of %s", module->path);
+		return false;
+	}
+
+	if (module->functions.on_unload) {
+		module->functions.on_unload(state);
+	}
+	platform_library_unload(&module->library);
+	remove(module->loaded_path);
+
+	module->library = library;
+	module->functions = functions;
+	strcpy(module->loaded_path, loaded_path);
+	module->version++;
+	if (module->functions.on_reload) {
+		module->functions.on_reload(state);
+	}
+
+	log_info("Reloaded app module %s in %.2f ms", module->path, (f64)(platform_get_time_ns() - start) / 1000000.0);
+	return true;
+}
+
+void app_module_unload(App_Module* module) {
+	if (!module->library.handle) {
+		return;
+	}
+	platform_library_unload(&module->library);
+	remove(module->loaded_path);
+	module->loaded_path[0] = 0;
+}
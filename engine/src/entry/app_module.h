@@ -0,0 +1,46 @@
+#pragma once
+
+#include "core/export.h"
+#include "core/types.h"
+#include "entry/app.h"
+#include "platform/platform_library.h"
+
+/**
+ * Apps loaded from a shared library that reload when it is rebuilt.
+ *
+ * Running an app with --app-module <path> takes its functions from the library at path instead of the ones linked
+ * into the executable. The library is polled for a newer build every APP_MODULE_POLL_MS, and once the file has stopped
+ * changing the new build is loaded and its functions swapped in between frames. The state from app_start is kept, so
+ * a reload must not change the state's layout, and the module's globals start over.
+ *
+ * Each build is loaded from a copy beside the library, so the build can overwrite the library while it is loaded and
+ * the loader never hands back the old build for the same path.
+ */
+
+// Lets apps run from a module with --app-module
+#define APP_MODULE_ENABLED 1
+
+#define APP_MODULE_POLL_MS 250
+#define APP_MODULE_PATH_MAX 512
+
+typedef struct App_Module {
+	char path[APP_MODULE_PATH_MAX];
+	// Copy of the build that is loaded
+	char loaded_path[APP_MODULE_PATH_MAX];
+	Library library;
+	App_Functions functions;
+	u32 version;
+
+	// Write time of the loaded build, and of the newer build while waiting for it to settle
+	u64 modified_ns;
+	u64 pending_modified_ns;
+	u64 next_poll_ns;
+} App_Module;
+
+export b8 app_module_load(App_Module* module, const char* path);
+
+// Reloads the module if it was rebuilt, returning true if its functions changed. A build that fails to load is
+// skipped and the current one keeps running.
+export b8 app_module_update(App_Module* module, void* state);
+
+export void app_module_unload(App_Module* module);
@@ -2,15 +2,29 @@
 
 #include "core/log.h"
 #include "core/memory.h"
+#include "core/action.h"
+#include "core/asset_watch.h"
 #include "core/event.h"
+#include "core/event_record.h"
+#include "core/frame_pacer.h"
+#include "core/job.h"
 #include "core/input.h"
+#include "core/vfs.h"
 #include "math/linalg.h"
 #include "platform/platform.h"
+#include "platform/platform_cpu.h"
+#include "platform/platform_io.h"
+#include "graphics/frame_latency.h"
 #include "graphics/renderer.h"
 
+#include <stdlib.h>
+#include <string.h>
+
 typedef struct Engine {
 	b8 running;
 	b8 suspended;
+	b8 suspend_enabled;
+	u64 suspend_timeout_ms;
 	Platform platform;
 	i32 width;
 	i32 height;
@@ -32,9 +46,53 @@ static b8 handle_window_resize(Event_Code code, Event_Context* context, void* se
 	return false;
 }
 
+static b8 is_env_enabled(const char* name) {
+	const char* value = getenv(name);
+	return value && strcmp(value, "0") != 0;
+}
+
+static void update_suspended(void) {
+	Platform_Window_State state = platform_get_window_state(&engine.platform);
+	b8 suspended = engine.suspend_enabled
+		&& !event_replay_is_active()
+		&& (state.minimized || !state.visible || (ENGINE_SUSPEND_UNFOCUSED && !state.focused));
+	if (suspended == engine.suspended) {
+		return;
+	}
+
+	engine.suspended = suspended;
+	log_debug(suspended ? "Suspended, window is in the background" : "Resumed");
+	event_fire(suspended ? EVENT_TYPE_APP_SUSPEND : EVENT_TYPE_APP_RESUME, (Event_Context){0}, null);
+}
+
+static Platform_Backend select_backend(const App_Config* config) {
+	if (PLATFORM_HEADLESS_ENABLED || config->headless || is_env_enabled("HAUNT_HEADLESS")) {
+		return PLATFORM_BACKEND_HEADLESS;
+	}
+	if (config->offscreen || is_env_enabled("HAUNT_OFFSCREEN")) {
+		return PLATFORM_BACKEND_OFFSCREEN;
+	}
+	return PLATFORM_BACKEND_NATIVE;
+}
+
 b8 _engine_init(const App_Config* config) {
+	log_init();
+
+	// HAUNT_LOG_FILE also writes the log to a file, rotated as it grows
+	const char* log_file = getenv("HAUNT_LOG_FILE");
+	if (log_file) {
+		log_open_file(log_file);
+	}
+
 	engine.running = true;
 	engine.suspended = false;
+	engine.platform.backend = select_backend(config);
+
+	// HAUNT_SUSPEND=0 keeps rendering in the background, e.g. while measuring latency from another window
+	const char* suspend = getenv("HAUNT_SUSPEND");
+	const char* suspend_timeout = getenv("HAUNT_SUSPEND_TIMEOUT_MS");
+	engine.suspend_enabled = suspend ? strcmp(suspend, "0") != 0 : ENGINE_SUSPEND_ENABLED;
+	engine.suspend_timeout_ms = suspend_timeout ? (u64)atoll(suspend_timeout) : ENGINE_SUSPEND_TIMEOUT_MS;
 
 	event_register(EVENT_TYPE_WINDOW_CLOSE, null, handle_window_close);
 	event_register(EVENT_TYPE_WINDOW_RESIZE, null, handle_window_resize);
@@ -50,24 +108,87 @@ b8 _engine_init(const App_Config* config) {
 		return false;
 	}
 
-	renderer_init();
+	renderer_init(engine.platform.backend == PLATFORM_BACKEND_HEADLESS ? RENDERER_BACKEND_NULL : RENDERER_BACKEND_OPENGL);
+
+	frame_pacer_init(config->target_frame_rate);
+
+	platform_log_cpu_topology();
+
+	// HAUNT_IO_URING=0 forces the thread pool, to compare against io_uring or work around a broken kernel
+	const char* io_uring = getenv("HAUNT_IO_URING");
+	if (!platform_io_start(io_uring ? strcmp(io_uring, "0") != 0 : true)) {
+		log_fatal("Failed to start file I/O");
+		return false;
+	}
+
+	// Started after the other engine threads, which would otherwise inherit the pinned main thread's core. HAUNT_WORKERS
+	// overrides the worker count, e.g. to run many server instances on one machine.
+	const char* workers = getenv("HAUNT_WORKERS");
+	const char* pin_threads = getenv("HAUNT_PIN_THREADS");
+	if (!job_system_init(
+			workers ? (u32)atoi(workers) : JOB_WORKER_COUNT_AUTO,
+			pin_threads ? strcmp(pin_threads, "0") != 0 : PLATFORM_THREAD_AFFINITY_ENABLED)) {
+		log_fatal("Failed to start job system");
+		return false;
+	}
+
+	vfs_init();
+
+	asset_watch_init();
+
+	event_record_init(&engine.platform);
 
 	log_debug("Engine initialized");
 	return true;
 }
 
 b8 _engine_update(void) {
+	// Wait before pumping so the frame starts with the freshest input. A suspended frame waits on the window instead, so
+	// it wakes as soon as the window comes back.
+	if (engine.suspended) {
+		platform_wait_for_events(&engine.platform, engine.suspend_timeout_ms);
+	} else {
+		frame_pacer_wait();
+	}
+
+	event_stats_end_frame();
+
+	// Events the input system fires come from the previous frame's input, which is recorded at the source
 	input_update();
 
-	if (!platform_pump_messages(&engine.platform)) {
+	if (!event_record_begin_frame()) {
 		engine.running = false;
 	}
 
+	// Replayed events stand in for the platform's input
+	if (!event_replay_is_active() && !platform_pump_messages(&engine.platform)) {
+		engine.running = false;
+	}
+
+	update_suspended();
+
+	frame_latency_mark(FRAME_LATENCY_STAGE_PUMP);
+
+	event_record_end_frame();
+
+	action_update();
+
+	// Reloads land before the app's update so it never sees a half replaced asset
+	asset_watch_update();
+
 	// log_trace("Engine updated");
 	return true;
 }
 
-b8 _engine_render(void) {
+void _engine_latch_input(void) {
+	frame_latency_mark(FRAME_LATENCY_STAGE_UPDATE);
+
+	if (!event_replay_is_active()) {
+		platform_latch_input(&engine.platform);
+	}
+}
+
+void _engine_begin_render(void) {
 	f64 time = platform_get_time(&engine.platform);
 	Color color = color_rgb(
 		sin(time) * 2.0 / 2.0,
@@ -75,11 +196,29 @@ b8 _engine_render(void) {
 		sin(time - 4.0 * pi / 3.0) * 2.0 / 2.0);
 	set_clear_color(color);
 	clear_screen();
-	return platform_swap_buffers(&engine.platform);
+}
+
+b8 _engine_render(void) {
+	frame_latency_mark(FRAME_LATENCY_STAGE_RENDER);
+
+	if (!platform_swap_buffers(&engine.platform)) {
+		return false;
+	}
+
+	frame_latency_end_frame();
+	return true;
 }
 
 void _engine_shutdown(void) {
+	asset_watch_shutdown();
+	vfs_shutdown();
+	platform_io_shutdown();
+	job_system_shutdown();
+	event_record_shutdown();
+	frame_latency_shutdown();
 	platform_shutdown(&engine.platform);
+	// Messages from here on are written on the calling thread
+	log_shutdown();
 	memory_report_allocations();
 
 	log_debug("Engine shutdown");
@@ -88,3 +227,7 @@ void _engine_shutdown(void) {
 b8 _engine_is_running(void) {
 	return engine.running;
 }
+
+b8 _engine_is_suspended(void) {
+	return engine.suspended;
+}
@@ -5,12 +5,29 @@
 
 #define ENGINE_VERSION "0.1.0"
 
+// Stops rendering while the window is minimized or hidden, blocking on window events instead. HAUNT_SUSPEND=0 turns
+// it off.
+#define ENGINE_SUSPEND_ENABLED 1
+// Also suspends while the window is unfocused. Off by default, since an unfocused window is often still in plain view,
+// like a game next to the editor it is being changed in.
+#define ENGINE_SUSPEND_UNFOCUSED 0
+// Longest a suspended frame blocks, so updates and asset reloads still tick over. HAUNT_SUSPEND_TIMEOUT_MS overrides it.
+#define ENGINE_SUSPEND_TIMEOUT_MS 250
+
 export b8 _engine_init(const App_Config* config);
 
 export b8 _engine_update(void);
 
+export void _engine_latch_input(void);
+
+// Clears the frame, so the app's render draws on top of it
+export void _engine_begin_render(void);
+
 export b8 _engine_render(void);
 
 export void _engine_shutdown(void);
 
 export b8 _engine_is_running(void);
+
+// Suspended frames update the app but do not render
+export b8 _engine_is_suspended(void);
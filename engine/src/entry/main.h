@@ -2,21 +2,58 @@
 
 #include "core/log.h"
 #include "entry/app.h"
+#include "entry/app_module.h"
 #include "entry/engine.h"
 
+#include <string.h>
+
+// App modules are shared libraries and have no main of their own
+#ifndef APP_MODULE
+
 int main(int argc, char** argv) {
-	App_Config config = app_config();
+	App_Functions app = {
+		app_config,
+		app_start,
+		app_update,
+		app_render,
+		app_on_resize,
+		app_shutdown,
+		null,
+		null,
+	};
+
+#if APP_MODULE_ENABLED
+	// Runs the app from a library that reloads when rebuilt, instead of the one linked in
+	App_Module module = {0};
+	for (int i = 1; i + 1 < argc; i++) {
+		if (strcmp(argv[i], "--app-module") == 0) {
+			if (!app_module_load(&module, argv[i + 1])) {
+				return APP_RESULT_FAILURE;
+			}
+			app = module.functions;
+			break;
+		}
+	}
+#endif
+
+	App_Config config = app.config();
 
 	if (!_engine_init(&config)) {
 		log_fatal("Engine intialization failed");
+#if APP_MODULE_ENABLED
+		app_module_unload(&module);
+#endif
 		return APP_RESULT_FAILURE;
 	}
 
 	void* state = null;
-	App_Result result = app_start(&state, argc, argv);
+	App_Result result = app.start(&state, argc, argv);
 	if (result != APP_RESULT_CONTINUE) {
 		log_info("App start returned %d", result);
 		_engine_shutdown();
+#if APP_MODULE_ENABLED
+		app_module_unload(&module);
+#endif
 		return result;
 	}
 
@@ -26,13 +63,26 @@ int main(int argc, char** argv) {
 			break;
 		}
 
-		App_Result result = app_update(state);
+#if APP_MODULE_ENABLED
+		if (app_module_update(&module, state)) {
+			app = module.functions;
+		}
+#endif
+
+		App_Result result = app.update(state);
 		if (result != APP_RESULT_CONTINUE) {
 			log_info("App update returned %d", result);
 			break;
 		}
 
-		result = app_render(state);
+		if (_engine_is_suspended()) {
+			continue;
+		}
+
+		_engine_latch_input();
+
+		_engine_begin_render();
+		result = app.render(state);
 		if (result != APP_RESULT_CONTINUE) {
 			log_info("App render returned %d", result);
 			break;
@@ -44,7 +94,7 @@ int main(int argc, char** argv) {
 		}
 	}
 
-	result = app_shutdown(state);
+	result = app.shutdown(state);
 	if (result == APP_RESULT_CONTINUE) {
 		log_warn("Engine shutdown returned APP_RESULT_CONTINUE, ignoring");
 		result = APP_RESULT_SUCCESS;
@@ -52,5 +102,11 @@ int main(int argc, char** argv) {
 
 	_engine_shutdown();
 
+#if APP_MODULE_ENABLED
+	app_module_unload(&module);
+#endif
+
 	return result;
 }
+
+#endif // APP_MODULE
@@ -0,0 +1,274 @@
+#include "graphics/frame_latency.h"
+#include "graphics/renderer_opengl.h"
+
+#include "core/input.h"
+#include "core/log.h"
+#include "core/memory.h"
+#include "platform/platform.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define FRAME_LATENCY_IN_FLIGHT_MAX 8
+#define FRAME_LATENCY_FRAME_EVENT_MAX 64
+#define FRAME_LATENCY_WAIT_TIMEOUT 1000000000ull
+
+static const char* stage_names[FRAME_LATENCY_STAGE_COUNT] = {
+	"pump",
+	"update",
+	"render",
+	"swap",
+	"complete",
+};
+
+typedef struct Frame_Record {
+	u64 frame;
+	u64 stage_times[FRAME_LATENCY_STAGE_COUNT];
+	u64 event_times[FRAME_LATENCY_FRAME_EVENT_MAX];
+	u32 event_count;
+	GLsync fence;
+	b8 in_flight;
+} Frame_Record;
+
+typedef struct Frame_Latency {
+	b8 enabled;
+	b8 wait_for_gpu;
+	u64 frame;
+	Frame_Record frames[FRAME_LATENCY_IN_FLIGHT_MAX];
+	u64 oldest_in_flight;
+
+	// Latency from each input event to each stage, in nanoseconds
+	u64* samples[FRAME_LATENCY_STAGE_COUNT];
+	u32 sample_count;
+	u64 dropped;
+
+	FILE* output;
+} Frame_Latency;
+
+static Frame_Latency latency = {0};
+
+static Frame_Record* current_record(void) {
+	return &latency.frames[latency.frame % FRAME_LATENCY_IN_FLIGHT_MAX];
+}
+
+static void complete_frame(Frame_Record* record, u64 time) {
+	record->stage_times[FRAME_LATENCY_STAGE_COMPLETE] = time;
+	if (record->fence) {
+		glDeleteSync(record->fence);
+		record->fence = null;
+	}
+	record->in_flight = false;
+
+	u64 min_latency = ~0ull;
+	u64 max_latency = 0;
+	for (u32 i = 0; i < record->event_count; i++) {
+		u64 event_time = record->event_times[i];
+		u64 complete_latency = time > event_time ? time - event_time : 0;
+		min_latency = complete_latency < min_latency ? complete_latency : min_latency;
+		max_latency = complete_latency > max_latency ? complete_latency : max_latency;
+
+		if (latency.sample_count >= FRAME_LATENCY_SAMPLE_MAX) {
+			latency.dropped++;
+			continue;
+		}
+		for (u32 stage = 0; stage < FRAME_LATENCY_STAGE_COUNT; stage++) {
+			u64 stage_time = record->stage_times[stage];
+			latency.samples[stage][latency.sample_count] = stage_time > event_time ? stage_time - event_time : 0;
+		}
+		latency.sample_count++;
+	}
+
+	if (latency.output) {
+		const u64* t = record->stage_times;
+		fprintf(
+			latency.output,
+			"%llu,%u,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f\n",
+			record->frame,
+			record->event_count,
+			record->event_count ? (f64)min_latency / 1000.0 : 0.0,
+			record->event_count ? (f64)max_latency / 1000.0 : 0.0,
+			(f64)(t[FRAME_LATENCY_STAGE_UPDATE] - t[FRAME_LATENCY_STAGE_PUMP]) / 1000.0,
+			(f64)(t[FRAME_LATENCY_STAGE_RENDER] - t[FRAME_LATENCY_STAGE_UPDATE]) / 1000.0,
+			(f64)(t[FRAME_LATENCY_STAGE_SWAP] - t[FRAME_LATENCY_STAGE_RENDER]) / 1000.0,
+			(f64)(t[FRAME_LATENCY_STAGE_COMPLETE] - t[FRAME_LATENCY_STAGE_SWAP]) / 1000.0);
+	}
+}
+
+static void wait_frame(Frame_Record* record) {
+	GLenum result = glClientWaitSync(record->fence, GL_SYNC_FLUSH_COMMANDS_BIT, FRAME_LATENCY_WAIT_TIMEOUT);
+	if (result == GL_TIMEOUT_EXPIRED || result == GL_WAIT_FAILED) {
+		log_warn("Timed out waiting for frame %llu to complete", record->frame);
+	}
+	complete_frame(record, platform_get_time_ns());
+}
+
+// Completes finished frames in order, stopping at the first the GPU is still working on
+static void poll_frames(void) {
+	while (latency.oldest_in_flight < latency.frame) {
+		Frame_Record* record = &latency.frames[latency.oldest_in_flight % FRAME_LATENCY_IN_FLIGHT_MAX];
+		if (record->in_flight) {
+			GLenum result = glClientWaitSync(record->fence, 0, 0);
+			if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED) {
+				break;
+			}
+			complete_frame(record, platform_get_time_ns());
+		}
+		latency.oldest_in_flight++;
+	}
+}
+
+void frame_latency_mark(Frame_Latency_Stage stage) {
+	if (!latency.enabled) {
+		return;
+	}
+
+	Frame_Record* record = current_record();
+	u64 now = platform_get_time_ns();
+
+	if (stage == FRAME_LATENCY_STAGE_PUMP) {
+		// The ring is full of unfinished frames, so this frame's slot has to wait
+		if (record->in_flight) {
+			wait_frame(record);
+			latency.oldest_in_flight = latency.frame - FRAME_LATENCY_IN_FLIGHT_MAX + 1;
+		}
+
+		record->frame = latency.frame;
+		record->event_count = 0;
+
+		u32 event_count;
+		const Input_Event* events = input_get_events(&event_count);
+		for (u32 i = 0; i < event_count && record->event_count < FRAME_LATENCY_FRAME_EVENT_MAX; i++) {
+			if (events[i].time) {
+				record->event_times[record->event_count++] = events[i].time;
+			}
+		}
+	}
+
+	record->stage_times[stage] = now;
+}
+
+void frame_latency_end_frame(void) {
+	if (!latency.enabled) {
+		return;
+	}
+
+	frame_latency_mark(FRAME_LATENCY_STAGE_SWAP);
+
+	Frame_Record* record = current_record();
+	latency.frame++;
+
+	// Nothing is sent to a GPU, so the frame is complete once it is swapped
+	if (renderer_get_backend() == RENDERER_BACKEND_NULL) {
+		complete_frame(record, record->stage_times[FRAME_LATENCY_STAGE_SWAP]);
+		latency.oldest_in_flight = latency.frame;
+		return;
+	}
+
+	record->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	record->in_flight = true;
+
+	if (latency.wait_for_gpu) {
+		wait_frame(record);
+		latency.oldest_in_flight = latency.frame;
+	} else {
+		poll_frames();
+	}
+}
+
+void frame_latency_shutdown(void) {
+	frame_latency_disable();
+}
+
+b8 frame_latency_enable(b8 wait_for_gpu) {
+	if (latency.enabled) {
+		return true;
+	}
+
+	for (u32 stage = 0; stage < FRAME_LATENCY_STAGE_COUNT; stage++) {
+		latency.samples[stage] = memory_alloc(FRAME_LATENCY_SAMPLE_MAX * sizeof(u64), MEMORY_TAG_RENDER);
+	}
+	latency.sample_count = 0;
+	latency.dropped = 0;
+	latency.wait_for_gpu = wait_for_gpu;
+	latency.oldest_in_flight = latency.frame;
+	latency.enabled = true;
+	return true;
+}
+
+void frame_latency_disable(void) {
+	if (!latency.enabled) {
+		return;
+	}
+
+	for (u32 i = 0; i < FRAME_LATENCY_IN_FLIGHT_MAX; i++) {
+		Frame_Record* record = &latency.frames[i];
+		if (record->in_flight) {
+			glDeleteSync(record->fence);
+			record->fence = null;
+			record->in_flight = false;
+		}
+	}
+
+	for (u32 stage = 0; stage < FRAME_LATENCY_STAGE_COUNT; stage++) {
+		memory_free(latency.samples[stage], FRAME_LATENCY_SAMPLE_MAX * sizeof(u64), MEMORY_TAG_RENDER);
+		latency.samples[stage] = null;
+	}
+
+	if (latency.output) {
+		fclose(latency.output);
+		latency.output = null;
+	}
+
+	latency.enabled = false;
+}
+
+b8 frame_latency_set_output(const char* path) {
+	if (latency.output) {
+		fclose(latency.output);
+	}
+
+	latency.output = fopen(path, "w");
+	if (!latency.output) {
+		log_error("Failed to open frame latency output: %s", path);
+		return false;
+	}
+
+	fprintf(latency.output, "frame,events,min_us,max_us,update_us,render_us,swap_us,gpu_us\n");
+	return true;
+}
+
+static int compare_u64(const void* a, const void* b) {
+	u64 x = *(const u64*)a;
+	u64 y = *(const u64*)b;
+	return (x > y) - (x < y);
+}
+
+static f64 percentile(const u64* sorted, u32 count, f64 p) {
+	u32 index = (u32)(p * (f64)(count - 1) + 0.5);
+	return (f64)sorted[index] / 1000.0;
+}
+
+void frame_latency_report(void) {
+	if (!latency.enabled || latency.sample_count == 0) {
+		log_info("No input latency samples");
+		return;
+	}
+
+	log_info("Input latency over %u events (us)", latency.sample_count);
+	log_info("%10s %10s %10s %10s %10s", "stage", "p50", "p90", "p99", "max");
+	for (u32 stage = 0; stage < FRAME_LATENCY_STAGE_COUNT; stage++) {
+		u64* samples = latency.samples[stage];
+		qsort(samples, latency.sample_count, sizeof(u64), compare_u64);
+		log_info(
+			"%10s %10.1f %10.1f %10.1f %10.1f",
+			stage_names[stage],
+			percentile(samples, latency.sample_count, 0.50),
+			percentile(samples, latency.sample_count, 0.90),
+			percentile(samples, latency.sample_count, 0.99),
+			(f64)samples[latency.sample_count - 1] / 1000.0);
+	}
+
+	if (latency.dropped > 0) {
+		log_warn("Dropped %llu latency samples, increase FRAME_LATENCY_SAMPLE_MAX", latency.dropped);
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "core/export.h"
+#include "core/types.h"
+
+/**
+ * Measures input to present latency. Every input event read in a frame is followed through the frame's stages until a
+ * GL fence inserted after the swap signals that the GPU has finished the frame.
+ */
+
+#define FRAME_LATENCY_SAMPLE_MAX 16384
+
+typedef enum Frame_Latency_Stage {
+	// Input read from the platform
+	FRAME_LATENCY_STAGE_PUMP,
+	// app_update done
+	FRAME_LATENCY_STAGE_UPDATE,
+	// app_render done
+	FRAME_LATENCY_STAGE_RENDER,
+	// Swap buffers returned
+	FRAME_LATENCY_STAGE_SWAP,
+	// GPU finished the frame
+	FRAME_LATENCY_STAGE_COMPLETE,
+	FRAME_LATENCY_STAGE_COUNT,
+} Frame_Latency_Stage;
+
+//
+// Lifecycle
+//
+
+void frame_latency_mark(Frame_Latency_Stage stage);
+
+// Inserts the frame's fence and collects any earlier frames the GPU has finished. Called after the swap.
+void frame_latency_end_frame(void);
+
+void frame_latency_shutdown(void);
+
+//
+// Measurement
+//
+
+// Starts measuring. Waiting for the GPU after every swap gives exact completion times but stops the CPU running ahead,
+// otherwise fences are polled once per frame.
+export b8 frame_latency_enable(b8 wait_for_gpu);
+
+export void frame_latency_disable(void);
+
+// Writes one CSV line per completed frame with its input latencies in microseconds.
+export b8 frame_latency_set_output(const char* path);
+
+// Logs latency percentiles for each stage over every measured input event.
+export void frame_latency_report(void);
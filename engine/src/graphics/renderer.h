@@ -1,5 +1,6 @@
 #pragma once
 
+#include "core/export.h"
 #include "core/types.h"
 #include "graphics/color.h"
 
@@ -7,10 +8,21 @@
 #define RENDER_SRGB_ENABLED  1
 #define RENDER_MSAA_ENABLED  1
 
-void renderer_init(void);
+typedef enum Renderer_Backend {
+	RENDERER_BACKEND_OPENGL,
+	// Accepts every call and draws nothing, for platforms without a GL context
+	RENDERER_BACKEND_NULL,
+} Renderer_Backend;
+
+void renderer_init(Renderer_Backend backend);
+
+Renderer_Backend renderer_get_backend(void);
 
 void renderer_resize(i32 width, i32 height);
 
 void set_clear_color(Color color);
 
 void clear_screen(void);
+
+// Copies RGBA8 pixels from the current render target, bottom row first. Used for golden image checks.
+export b8 renderer_read_pixels(i32 x, i32 y, i32 width, i32 height, u8* out_pixels);
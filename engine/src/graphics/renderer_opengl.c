@@ -23,22 +23,57 @@ static void gl_debug_callback(GLenum source, GLenum type, GLuint id, GLenum seve
 }
 #endif
 
-void renderer_init(void) {
+typedef struct Renderer {
+	Renderer_Backend backend;
+} Renderer;
+
+static Renderer renderer = {0};
+
+void renderer_init(Renderer_Backend backend) {
+	renderer.backend = backend;
+	if (backend == RENDERER_BACKEND_NULL) {
+		log_info("Using the null renderer");
+		return;
+	}
+
 #if GL_DEBUG_ENABLED
 	glDebugMessageCallback(&gl_debug_callback, NULL);
 	glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
 #endif
 }
 
+Renderer_Backend renderer_get_backend(void) {
+	return renderer.backend;
+}
+
 void renderer_resize(i32 width, i32 height) {
+	if (renderer.backend == RENDERER_BACKEND_NULL) {
+		return;
+	}
 	glViewport(0, 0, width, height);
 }
 
 void set_clear_color(Color color) {
+	if (renderer.backend == RENDERER_BACKEND_NULL) {
+		return;
+	}
 	glClearColor(color.r, color.g, color.b, color.a);
 }
 
 // TODO: Pass other clear bits?
 void clear_screen(void) {
+	if (renderer.backend == RENDERER_BACKEND_NULL) {
+		return;
+	}
 	glClear(GL_COLOR_BUFFER_BIT);
 }
+
+b8 renderer_read_pixels(i32 x, i32 y, i32 width, i32 height, u8* out_pixels) {
+	if (renderer.backend == RENDERER_BACKEND_NULL) {
+		return false;
+	}
+
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, out_pixels);
+	return glGetError() == GL_NO_ERROR;
+}
@@ -1,17 +1,37 @@
 #include "graphics/shader.h"
 #include "graphics/renderer_opengl.h"
+#include "core/asset_watch.h"
+#include "core/event.h"
 #include "core/log.h"
-#include "core/memory.h"
 #include "core/types.h"
+#include "core/vfs.h"
 
 #include <glad/glad.h>
-#include <stdio.h>
-#include <stdlib.h>
+
 #include <string.h>
 
-static b8 compile_shader(u32* out_id, const char* source, GLenum type) {
+// Shaders loaded from files that can be reloaded at once
+#define SHADER_RELOAD_MAX 64
+
+typedef struct Shader_Source {
+    Shader* shader;
+    char vertex_path[VFS_PATH_MAX];
+    char fragment_path[VFS_PATH_MAX];
+} Shader_Source;
+
+// Shaders recompiled in place when their files change
+typedef struct Shader_Reload {
+    Shader_Source sources[SHADER_RELOAD_MAX];
+    u32 source_count;
+    Event_Handle handle;
+} Shader_Reload;
+
+static Shader_Reload reload = {0};
+
+// A negative length reads the source up to its null terminator
+static b8 compile_shader(u32* out_id, const char* source, i32 length, GLenum type) {
     *out_id = glCreateShader(type);
-    glShaderSource(*out_id, 1, &source, NULL);
+    glShaderSource(*out_id, 1, &source, &length);
     glCompileShader(*out_id);
 
     // Check compilation status
@@ -21,58 +41,39 @@ static b8 compile_shader(u32* out_id, const char* source, GLenum type) {
         char info_log[512];
         glGetShaderInfoLog(*out_id, 512, NULL, info_log);
         log_error("Shader compilation failed: %s", info_log);
+        // Failed reloads would otherwise leak a shader object each
+        glDeleteShader(*out_id);
         return false;
     }
 
     return true;
 }
 
-static char* read_file(const char* path) {
-    FILE* file = fopen(path, "rb");
-    if (!file) {
-        log_error("Failed to open shader file: %s", path);
-        return null;
-    }
-
-    // Get file size
-    fseek(file, 0, SEEK_END);
-    size_t size = ftell(file);
-    fseek(file, 0, SEEK_SET);
-
-    // Allocate buffer for file content plus null terminator
-    char* buffer = memory_alloc(size + 1, MEMORY_TAG_SHADER);
-    if (!buffer) {
-        log_error("Failed to allocate memory for shader file: %s", path);
-        fclose(file);
-        return null;
-    }
-
-    // Read file content
-    size_t read = fread(buffer, 1, size, file);
-    fclose(file);
+static b8 create_program(
+    Shader* out_shader,
+    const char* vertex_source,
+    i32 vertex_length,
+    const char* fragment_source,
+    i32 fragment_length) {
+    out_shader->is_valid = false;
 
-    if (read != size) {
-        log_error("Failed to read shader file: %s", path);
-        memory_free(buffer, size + 1, MEMORY_TAG_SHADER);
-        return null;
+    // Nothing to compile against, but the shader is still usable by callers
+    if (renderer_get_backend() == RENDERER_BACKEND_NULL) {
+        out_shader->program_id = 0;
+        out_shader->vertex_id = 0;
+        out_shader->fragment_id = 0;
+        out_shader->is_valid = true;
+        return true;
     }
 
-    // Null terminate the string
-    buffer[size] = '\0';
-    return buffer;
-}
-
-b8 shader_create(Shader* out_shader, const char* vertex_source, const char* fragment_source) {
-    out_shader->is_valid = false;
-
     // Compile vertex shader
-    if (!compile_shader(&out_shader->vertex_id, vertex_source, GL_VERTEX_SHADER)) {
+    if (!compile_shader(&out_shader->vertex_id, vertex_source, vertex_length, GL_VERTEX_SHADER)) {
         log_error("Failed to compile vertex shader");
         return false;
     }
 
     // Compile fragment shader
-    if (!compile_shader(&out_shader->fragment_id, fragment_source, GL_FRAGMENT_SHADER)) {
+    if (!compile_shader(&out_shader->fragment_id, fragment_source, fragment_length, GL_FRAGMENT_SHADER)) {
         log_error("Failed to compile fragment shader");
         glDeleteShader(out_shader->vertex_id);
         return false;
@@ -105,31 +106,113 @@ b8 shader_create(Shader* out_shader, const char* vertex_source, const char* frag
     return true;
 }
 
-b8 shader_create_from_files(Shader* out_shader, const char* vertex_path, const char* fragment_path) {
-    // Read vertex shader
-    char* vertex_source = read_file(vertex_path);
-    if (!vertex_source) {
+b8 shader_create(Shader* out_shader, const char* vertex_source, const char* fragment_source) {
+    return create_program(out_shader, vertex_source, -1, fragment_source, -1);
+}
+
+static b8 load_program(Shader* out_shader, const char* vertex_path, const char* fragment_path) {
+    // Map the sources and compile straight from the page cache, GL copies them anyway
+    Vfs_File vertex_file;
+    if (!vfs_map(vertex_path, &vertex_file)) {
         return false;
     }
 
-    // Read fragment shader
-    char* fragment_source = read_file(fragment_path);
-    if (!fragment_source) {
-        memory_free(vertex_source, strlen(vertex_source) + 1, MEMORY_TAG_SHADER);
+    Vfs_File fragment_file;
+    if (!vfs_map(fragment_path, &fragment_file)) {
+        vfs_release(&vertex_file);
         return false;
     }
 
-    // Create shader from sources
-    b8 result = shader_create(out_shader, vertex_source, fragment_source);
-
-    // Clean up
-    memory_free(vertex_source, strlen(vertex_source) + 1, MEMORY_TAG_SHADER);
-    memory_free(fragment_source, strlen(fragment_source) + 1, MEMORY_TAG_SHADER);
+    b8 result = create_program(
+        out_shader,
+        (const char*)vertex_file.data,
+        (i32)vertex_file.size,
+        (const char*)fragment_file.data,
+        (i32)fragment_file.size);
 
+    vfs_release(&vertex_file);
+    vfs_release(&fragment_file);
     return result;
 }
 
+static b8 handle_asset_changed(Event_Code code, Event_Context* context, void* sender, void* listener) {
+    const char* path = (const char*)sender;
+    for (u32 i = 0; i < reload.source_count; i++) {
+        Shader_Source* source = &reload.sources[i];
+        if (strcmp(source->vertex_path, path) != 0 && strcmp(source->fragment_path, path) != 0) {
+            continue;
+        }
+
+        // Compile beside the old program so a broken edit leaves it running
+        Shader shader;
+        if (!load_program(&shader, source->vertex_path, source->fragment_path)) {
+            log_error("Keeping the previous shader for %s and %s", source->vertex_path, source->fragment_path);
+            continue;
+        }
+        if (source->shader->program_id) {
+            glDeleteProgram(source->shader->program_id);
+        }
+        *source->shader = shader;
+        log_info("Reloaded shader %s and %s", source->vertex_path, source->fragment_path);
+    }
+
+    // Other listeners may reload the same file
+    return false;
+}
+
+static void watch_source(Shader* shader, const char* vertex_path, const char* fragment_path) {
+    if (reload.source_count == SHADER_RELOAD_MAX || strlen(vertex_path) >= VFS_PATH_MAX ||
+        strlen(fragment_path) >= VFS_PATH_MAX) {
+        log_warn("Shader %s and %s won't reload when they change", vertex_path, fragment_path);
+        return;
+    }
+
+    Shader_Source* source = &reload.sources[reload.source_count++];
+    source->shader = shader;
+    strcpy(source->vertex_path, vertex_path);
+    strcpy(source->fragment_path, fragment_path);
+    asset_watch_add(vertex_path);
+    asset_watch_add(fragment_path);
+
+    if (reload.handle == EVENT_HANDLE_INVALID) {
+        reload.handle = event_register(EVENT_TYPE_ASSET_CHANGED, null, handle_asset_changed);
+    }
+}
+
+static void unwatch_source(Shader* shader) {
+    for (u32 i = 0; i < reload.source_count; i++) {
+        Shader_Source* source = &reload.sources[i];
+        if (source->shader != shader) {
+            continue;
+        }
+
+        asset_watch_remove(source->vertex_path);
+        asset_watch_remove(source->fragment_path);
+        *source = reload.sources[--reload.source_count];
+        break;
+    }
+
+    if (reload.source_count == 0 && reload.handle != EVENT_HANDLE_INVALID) {
+        event_unregister(reload.handle);
+        reload.handle = EVENT_HANDLE_INVALID;
+    }
+}
+
+b8 shader_create_from_files(Shader* out_shader, const char* vertex_path, const char* fragment_path) {
+    if (!load_program(out_shader, vertex_path, fragment_path)) {
+        return false;
+    }
+
+    if (ASSET_HOT_RELOAD_ENABLED) {
+        watch_source(out_shader, vertex_path, fragment_path);
+    }
+    return true;
+}
+
 void shader_destroy(Shader* shader) {
+    if (ASSET_HOT_RELOAD_ENABLED) {
+        unwatch_source(shader);
+    }
     if (shader->program_id) {
         glDeleteProgram(shader->program_id);
     }
@@ -140,12 +223,15 @@ void shader_destroy(Shader* shader) {
 }
 
 void shader_bind(Shader* shader) {
-    if (shader && shader->is_valid) {
+    if (shader && shader->is_valid && shader->program_id) {
         glUseProgram(shader->program_id);
     }
 }
 
 void shader_unbind(void) {
+    if (renderer_get_backend() == RENDERER_BACKEND_NULL) {
+        return;
+    }
     glUseProgram(0);
 }
 
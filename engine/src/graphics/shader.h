@@ -27,7 +27,8 @@ void shader_unbind(void);
 // Check if a shader is valid
 b8 shader_is_valid(Shader* shader);
 
-// Add this new function declaration
+// Create and compile a shader from files, found through the VFS. With hot reload enabled the shader is recompiled in
+// place when either file changes, so it must stay at the same address until shader_destroy.
 b8 shader_create_from_files(
     Shader* out_shader,
     const char* vertex_path,
@@ -3,6 +3,17 @@
 #include "core/log.h"
 #include "core/memory.h"
 #include "core/event.h"
+#include "core/event_record.h"
 #include "core/input.h"
+#include "core/action.h"
+#include "core/frame_pacer.h"
+#include "core/atomic.h"
+#include "core/job.h"
+#include "core/vfs.h"
+#include "core/asset_watch.h"
+#include "graphics/frame_latency.h"
+#include "platform/platform_thread.h"
+#include "platform/platform_fiber.h"
+#include "platform/platform_io.h"
 #include "math/linalg.h"
 #include "entry/main.h"
@@ -2,10 +2,38 @@
 
 #include "core/types.h"
 
+// Reads input on a dedicated thread so it is timestamped on arrival and not held up by rendering (Linux only)
+#define PLATFORM_INPUT_THREAD_ENABLED 0
+
+// Reads X events through XCB, which drains a frame's events without round trips, instead of Xlib (Linux only). Off until
+// haunt-bench-x11 has numbers from a real X server to back it.
+#define PLATFORM_XCB_ENABLED 0
+
+// Runs every app without a window or GL context, regardless of App_Config
+#define PLATFORM_HEADLESS_ENABLED 0
+
+typedef enum Platform_Backend {
+	// A window and GL context from the OS
+	PLATFORM_BACKEND_NATIVE,
+	// No display. Input only arrives through replays or the input_process functions.
+	PLATFORM_BACKEND_HEADLESS,
+	// Headless, with a GL context rendering into a framebuffer object (Linux only)
+	PLATFORM_BACKEND_OFFSCREEN,
+} Platform_Backend;
+
 typedef struct Platform {
+	// Set before platform_start
+	Platform_Backend backend;
 	void* internal;
 } Platform;
 
+typedef struct Platform_Window_State {
+	b8 focused;
+	// Some of the window can be seen. Compositing window managers report covered windows as visible.
+	b8 visible;
+	b8 minimized;
+} Platform_Window_State;
+
 typedef enum Platform_Console_Color {
 	PLATFORM_CONSOLE_COLOR_WHITE,
 	PLATFORM_CONSOLE_COLOR_RED,
@@ -22,8 +50,18 @@ void platform_shutdown(Platform* platform);
 
 b8 platform_pump_messages(Platform* platform);
 
+// Samples the newest pointer state right before rendering. Only has an effect with the input thread enabled.
+void platform_latch_input(Platform* platform);
+
 b8 platform_swap_buffers(Platform* platform);
 
+// The window's state as of the last pump. Headless and offscreen backends are always focused and visible.
+Platform_Window_State platform_get_window_state(Platform* platform);
+
+// Blocks until the window has events to pump or timeout_ms passes, without using the CPU. Returns false on timeout.
+// Backends without a window sleep for the timeout.
+b8 platform_wait_for_events(Platform* platform, u64 timeout_ms);
+
 // TODO: Separate this into platform reserve and commit
 void* platform_memory_alloc(u64 size, b8 aligned);
 
@@ -40,6 +78,29 @@ void platform_console_write_error(const char* message, Platform_Console_Color co
 
 f64 platform_get_time(Platform* platform);
 
+// Monotonic time in nanoseconds, usable before the platform is started
+export u64 platform_get_time_ns(void);
+
+// Measures the cycle counter's frequency against the monotonic clock. Called by platform_start, and by
+// platform_get_cycle_frequency when the platform has not been started.
+void platform_calibrate_cycles(void);
+
+// Reads the CPU's invariant timestamp counter, or the monotonic clock in nanoseconds where there is none. Only
+// meaningful after calibration.
+export u64 platform_get_cycles(void);
+
+// Cycles per second
+export u64 platform_get_cycle_frequency(void);
+
+export u64 platform_cycles_to_ns(u64 cycles);
+
 void platform_sleep(u64 ms);
 
+// Sleeps until the monotonic clock reaches deadline_ns. The OS sleep wakes spin_ns early and the rest is spun, since
+// the scheduler may oversleep by up to a timer slice.
+void platform_sleep_until_ns(u64 deadline_ns, u64 spin_ns);
+
 b8 platform_is_debugging(void);
+
+// Logical processors the process can run on
+export u32 platform_get_processor_count(void);
@@ -0,0 +1,196 @@
+#include "platform/platform_cpu.h"
+
+#include "core/log.h"
+#include "core/memory.h"
+#include "platform/platform.h"
+
+// Cores reserved for the latency critical roles, by index from the fastest
+#define CPU_CORE_MAIN   0
+#define CPU_CORE_RENDER 1
+#define CPU_CORE_AUDIO  2
+#define CPU_CORE_RESERVED 3
+
+typedef struct Cpu_State {
+	b8 detected;
+	Cpu_Topology topology;
+} Cpu_State;
+
+static Cpu_State cpu = {0};
+
+//
+// Processor sets
+//
+
+void cpu_set_clear(Cpu_Set* set) {
+	memory_zero(set, sizeof(Cpu_Set));
+}
+
+void cpu_set_add(Cpu_Set* set, u32 processor) {
+	if (processor < CPU_PROCESSOR_MAX) {
+		set->bits[processor / 64] |= 1ull << (processor % 64);
+	}
+}
+
+b8 cpu_set_contains(const Cpu_Set* set, u32 processor) {
+	return processor < CPU_PROCESSOR_MAX && (set->bits[processor / 64] & (1ull << (processor % 64))) != 0;
+}
+
+u32 cpu_set_count(const Cpu_Set* set) {
+	u32 count = 0;
+	for (u32 i = 0; i < CPU_PROCESSOR_MAX / 64; i++) {
+		count += (u32)__builtin_popcountll(set->bits[i]);
+	}
+	return count;
+}
+
+//
+// Topology
+//
+
+// One core per logical processor, for when the OS doesn't say more
+static void fallback_topology(Cpu_Topology* topology) {
+	memory_zero(topology, sizeof(Cpu_Topology));
+	u32 count = platform_get_processor_count();
+	if (count > CPU_PROCESSOR_MAX) {
+		count = CPU_PROCESSOR_MAX;
+	}
+	for (u32 i = 0; i < count; i++) {
+		Cpu_Core* core = &topology->cores[i];
+		cpu_set_add(&core->processors, i);
+		core->processor_count = 1;
+		core->first_processor = i;
+	}
+	topology->processor_count = count;
+	topology->core_count = count;
+	topology->package_count = 1;
+}
+
+// Drops the processors the process may not run on, and cores left without any. Leaves the topology alone if nothing
+// would be left, since then the affinity is not worth trusting.
+static void restrict_topology(Cpu_Topology* topology, const Cpu_Set* allowed) {
+	u32 allowed_cores = 0;
+	for (u32 i = 0; i < topology->core_count; i++) {
+		for (u32 j = 0; j < CPU_PROCESSOR_MAX / 64; j++) {
+			if (topology->cores[i].processors.bits[j] & allowed->bits[j]) {
+				allowed_cores++;
+				break;
+			}
+		}
+	}
+	if (allowed_cores == 0) {
+		return;
+	}
+
+	u32 core_count = 0;
+	topology->processor_count = 0;
+	for (u32 i = 0; i < topology->core_count; i++) {
+		Cpu_Core core = topology->cores[i];
+		for (u32 j = 0; j < CPU_PROCESSOR_MAX / 64; j++) {
+			core.processors.bits[j] &= allowed->bits[j];
+		}
+		core.processor_count = cpu_set_count(&core.processors);
+		if (core.processor_count == 0) {
+			continue;
+		}
+		for (u32 processor = 0; processor < CPU_PROCESSOR_MAX; processor++) {
+			if (cpu_set_contains(&core.processors, processor)) {
+				core.first_processor = processor;
+				break;
+			}
+		}
+		topology->cores[core_count++] = core;
+		topology->processor_count += core.processor_count;
+	}
+	topology->core_count = core_count;
+}
+
+// Sorts the cores fastest first and marks everything slower than the fastest as efficiency cores
+static void classify_cores(Cpu_Topology* topology) {
+	// Insertion sort, keeping cores of the same class in processor order
+	for (u32 i = 1; i < topology->core_count; i++) {
+		Cpu_Core core = topology->cores[i];
+		u32 j = i;
+		while (j > 0 && topology->cores[j - 1].performance_class < core.performance_class) {
+			topology->cores[j] = topology->cores[j - 1];
+			j--;
+		}
+		topology->cores[j] = core;
+	}
+
+	topology->efficient_core_count = 0;
+	u32 fastest = topology->core_count > 0 ? topology->cores[0].performance_class : 0;
+	for (u32 i = 0; i < topology->core_count; i++) {
+		Cpu_Core* core = &topology->cores[i];
+		core->efficient = core->performance_class < fastest;
+		topology->efficient_core_count += core->efficient;
+	}
+}
+
+const Cpu_Topology* platform_get_cpu_topology(void) {
+	if (!cpu.detected) {
+		if (!platform_detect_cpu_topology(&cpu.topology) || cpu.topology.core_count == 0) {
+			log_warn("Failed to detect the CPU topology, assuming one core per logical processor");
+			fallback_topology(&cpu.topology);
+		}
+		Cpu_Set allowed;
+		if (platform_get_process_affinity(&allowed)) {
+			restrict_topology(&cpu.topology, &allowed);
+		}
+		classify_cores(&cpu.topology);
+		cpu.detected = true;
+	}
+	return &cpu.topology;
+}
+
+void platform_log_cpu_topology(void) {
+	const Cpu_Topology* topology = platform_get_cpu_topology();
+	log_info("CPU: %u packages, %u cores (%u efficiency), %u logical processors", topology->package_count,
+		topology->core_count, topology->efficient_core_count, topology->processor_count);
+	for (u32 i = 0; i < CPU_CACHE_LEVEL_MAX; i++) {
+		const Cpu_Cache* cache = &topology->caches[i];
+		if (cache->size > 0) {
+			log_info("CPU: L%u %llu KiB, %u byte lines, shared by %u logical processors", i + 1, cache->size / 1024,
+				cache->line_size, cache->shared_processor_count);
+		}
+	}
+}
+
+//
+// Affinity
+//
+
+void platform_get_role_affinity(Thread_Role role, u32 index, Cpu_Set* out_processors) {
+	const Cpu_Topology* topology = platform_get_cpu_topology();
+	cpu_set_clear(out_processors);
+
+	// Worker zero is the main thread
+	if (role == THREAD_ROLE_WORKER && index == 0) {
+		role = THREAD_ROLE_MAIN;
+	}
+
+	if (role != THREAD_ROLE_WORKER) {
+		u32 core = role == THREAD_ROLE_MAIN ? CPU_CORE_MAIN : role == THREAD_ROLE_RENDER ? CPU_CORE_RENDER : CPU_CORE_AUDIO;
+		*out_processors = topology->cores[core % topology->core_count].processors;
+		return;
+	}
+
+	// Worker one takes the slowest core and each further worker the next faster one, stopping short of the reserved cores
+	u32 free_cores = topology->core_count > CPU_CORE_RESERVED ? topology->core_count - CPU_CORE_RESERVED : 0;
+	if (index <= free_cores) {
+		cpu_set_add(out_processors, topology->cores[topology->core_count - index].first_processor);
+		return;
+	}
+
+	// More workers than free cores, let the OS place the rest
+	for (u32 i = 0; i < topology->core_count; i++) {
+		for (u32 j = 0; j < CPU_PROCESSOR_MAX / 64; j++) {
+			out_processors->bits[j] |= topology->cores[i].processors.bits[j];
+		}
+	}
+}
+
+b8 platform_pin_thread(Thread_Role role, u32 index) {
+	Cpu_Set processors;
+	platform_get_role_affinity(role, index, &processors);
+	return platform_set_thread_affinity(&processors);
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "core/export.h"
+#include "core/types.h"
+
+/**
+ * CPU topology and thread affinity.
+ *
+ * The topology groups logical processors into physical cores, so SMT siblings that share one core's execution units
+ * can be told apart from real parallelism, and marks the efficiency cores of hybrid CPUs. Linux reads it from
+ * /sys/devices/system/cpu, Windows from GetLogicalProcessorInformationEx. Only the processors the process may run on
+ * are included, so a container or a taskset limited to a few cores sees just those.
+ *
+ * Pinning by role keeps latency critical threads on cores of their own. The main, render and audio threads each get
+ * a whole performance core, in that order from the fastest. Workers take the first logical processor of the remaining
+ * cores starting from the slowest, so no worker shares a core with a hyperthread sibling that is doing real work. With
+ * one worker per core that leaves the last few workers without a core of their own, and they may run on any core. The
+ * main thread is also worker zero.
+ */
+
+// Pins the main thread and the job workers by role. Off by default since it only pays off on a machine the game has
+// mostly to itself. HAUNT_PIN_THREADS=1 or 0 in the environment overrides it.
+#define PLATFORM_THREAD_AFFINITY_ENABLED 0
+
+#define CPU_PROCESSOR_MAX 256
+// L1 data, L2 and L3
+#define CPU_CACHE_LEVEL_MAX 3
+
+// Logical processors by OS processor number
+typedef struct Cpu_Set {
+	u64 bits[CPU_PROCESSOR_MAX / 64];
+} Cpu_Set;
+
+typedef struct Cpu_Core {
+	// SMT siblings sharing the core
+	Cpu_Set processors;
+	u32 processor_count;
+	u32 first_processor;
+	u32 package;
+	// Relative performance, higher is faster. The same for every core on CPUs without hybrid cores.
+	u32 performance_class;
+	// Efficiency core of a hybrid CPU
+	b8 efficient;
+} Cpu_Core;
+
+typedef struct Cpu_Cache {
+	u64 size;
+	u32 line_size;
+	// Logical processors sharing one instance of the cache
+	u32 shared_processor_count;
+} Cpu_Cache;
+
+typedef struct Cpu_Topology {
+	u32 processor_count;
+	u32 core_count;
+	u32 package_count;
+	u32 efficient_core_count;
+	// Fastest first, so performance cores come before efficiency cores
+	Cpu_Core cores[CPU_PROCESSOR_MAX];
+	// Data or unified caches by level starting at L1, zero sized where there is none
+	Cpu_Cache caches[CPU_CACHE_LEVEL_MAX];
+} Cpu_Topology;
+
+typedef enum Thread_Role {
+	THREAD_ROLE_MAIN,
+	THREAD_ROLE_RENDER,
+	THREAD_ROLE_AUDIO,
+	THREAD_ROLE_WORKER,
+} Thread_Role;
+
+//
+// Processor sets
+//
+
+export void cpu_set_clear(Cpu_Set* set);
+
+export void cpu_set_add(Cpu_Set* set, u32 processor);
+
+export b8 cpu_set_contains(const Cpu_Set* set, u32 processor);
+
+export u32 cpu_set_count(const Cpu_Set* set);
+
+//
+// Topology
+//
+
+// Detected on the first call. Falls back to one core per logical processor where the OS reports nothing.
+export const Cpu_Topology* platform_get_cpu_topology(void);
+
+b8 platform_detect_cpu_topology(Cpu_Topology* out_topology);
+
+// Processors the process may run on. Returns false where that is unknown or unrestricted.
+b8 platform_get_process_affinity(Cpu_Set* out_processors);
+
+export void platform_log_cpu_topology(void);
+
+//
+// Affinity
+//
+
+// Restricts the calling thread to the given processors. Threads it creates afterwards inherit the restriction on
+// Linux.
+export b8 platform_set_thread_affinity(const Cpu_Set* processors);
+
+// Processors a thread with the given role should run on. The index picks between workers and is ignored otherwise.
+export void platform_get_role_affinity(Thread_Role role, u32 index, Cpu_Set* out_processors);
+
+// Pins the calling thread to the processors for its role
+export b8 platform_pin_thread(Thread_Role role, u32 index);
@@ -0,0 +1,281 @@
+#include "platform/platform_cpu.h"
+
+#include "core/context.h"
+#include "core/log.h"
+#include "core/memory.h"
+
+#ifdef PLATFORM_LINUX
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define CPU_SYSFS_PATH "/sys/devices/system/cpu"
+// Logical processors of the efficiency cores on Intel hybrid CPUs
+#define CPU_ATOM_PATH "/sys/devices/cpu_atom/cpus"
+#define CPU_CACHE_INDEX_MAX 8
+#define CPU_CGROUP_PATH "/sys/fs/cgroup"
+
+//
+// Sysfs
+//
+
+// Reads a small text file, without the trailing newline
+static b8 read_sys_file(const char* path, char* buffer, u32 size) {
+	i32 fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	ssize_t length = read(fd, buffer, size - 1);
+	close(fd);
+	if (length <= 0) {
+		return false;
+	}
+	while (length > 0 && (buffer[length - 1] == '\n' || buffer[length - 1] == ' ')) {
+		length--;
+	}
+	buffer[length] = '\0';
+	return true;
+}
+
+static b8 read_sys_u32(const char* path, u32* out_value) {
+	char buffer[32];
+	if (!read_sys_file(path, buffer, sizeof(buffer))) {
+		return false;
+	}
+	*out_value = (u32)strtoul(buffer, null, 10);
+	return true;
+}
+
+// Parses a processor list like "0-3,8,10-11"
+static b8 read_sys_cpu_list(const char* path, Cpu_Set* out_set) {
+	char buffer[1024];
+	if (!read_sys_file(path, buffer, sizeof(buffer))) {
+		return false;
+	}
+
+	cpu_set_clear(out_set);
+	char* cursor = buffer;
+	while (*cursor) {
+		u32 first = (u32)strtoul(cursor, &cursor, 10);
+		u32 last = first;
+		if (*cursor == '-') {
+			last = (u32)strtoul(cursor + 1, &cursor, 10);
+		}
+		for (u32 i = first; i <= last && i < CPU_PROCESSOR_MAX; i++) {
+			cpu_set_add(out_set, i);
+		}
+		if (*cursor != ',') {
+			break;
+		}
+		cursor++;
+	}
+	return true;
+}
+
+// Parses a size like "48K" or "32M"
+static b8 read_sys_size(const char* path, u64* out_size) {
+	char buffer[32];
+	if (!read_sys_file(path, buffer, sizeof(buffer))) {
+		return false;
+	}
+	char* suffix;
+	u64 size = strtoull(buffer, &suffix, 10);
+	if (*suffix == 'K') {
+		size *= 1024;
+	} else if (*suffix == 'M') {
+		size *= 1024 * 1024;
+	} else if (*suffix == 'G') {
+		size *= 1024 * 1024 * 1024;
+	}
+	*out_size = size;
+	return true;
+}
+
+static void detect_caches(Cpu_Topology* topology, u32 processor) {
+	char path[256];
+	for (u32 i = 0; i < CPU_CACHE_INDEX_MAX; i++) {
+		u32 level;
+		snprintf(path, sizeof(path), CPU_SYSFS_PATH "/cpu%u/cache/index%u/level", processor, i);
+		if (!read_sys_u32(path, &level)) {
+			break;
+		}
+
+		char type[32];
+		snprintf(path, sizeof(path), CPU_SYSFS_PATH "/cpu%u/cache/index%u/type", processor, i);
+		if (level < 1 || level > CPU_CACHE_LEVEL_MAX || !read_sys_file(path, type, sizeof(type)) || strcmp(type, "Instruction") == 0) {
+			continue;
+		}
+
+		Cpu_Cache* cache = &topology->caches[level - 1];
+		snprintf(path, sizeof(path), CPU_SYSFS_PATH "/cpu%u/cache/index%u/size", processor, i);
+		read_sys_size(path, &cache->size);
+		snprintf(path, sizeof(path), CPU_SYSFS_PATH "/cpu%u/cache/index%u/coherency_line_size", processor, i);
+		read_sys_u32(path, &cache->line_size);
+		Cpu_Set shared;
+		snprintf(path, sizeof(path), CPU_SYSFS_PATH "/cpu%u/cache/index%u/shared_cpu_list", processor, i);
+		cache->shared_processor_count = read_sys_cpu_list(path, &shared) ? cpu_set_count(&shared) : 1;
+	}
+}
+
+//
+// Topology
+//
+
+b8 platform_detect_cpu_topology(Cpu_Topology* out_topology) {
+	memory_zero(out_topology, sizeof(Cpu_Topology));
+
+	Cpu_Set online;
+	if (!read_sys_cpu_list(CPU_SYSFS_PATH "/online", &online)) {
+		return false;
+	}
+
+	Cpu_Set atom;
+	b8 hybrid = read_sys_cpu_list(CPU_ATOM_PATH, &atom);
+
+	Cpu_Set assigned;
+	Cpu_Set packages;
+	cpu_set_clear(&assigned);
+	cpu_set_clear(&packages);
+	char path[256];
+
+	for (u32 processor = 0; processor < CPU_PROCESSOR_MAX; processor++) {
+		if (!cpu_set_contains(&online, processor) || cpu_set_contains(&assigned, processor)) {
+			continue;
+		}
+
+		Cpu_Core* core = &out_topology->cores[out_topology->core_count++];
+		snprintf(path, sizeof(path), CPU_SYSFS_PATH "/cpu%u/topology/thread_siblings_list", processor);
+		Cpu_Set siblings;
+		if (!read_sys_cpu_list(path, &siblings)) {
+			cpu_set_clear(&siblings);
+			cpu_set_add(&siblings, processor);
+		}
+
+		// Siblings are only counted once and only while online
+		cpu_set_clear(&core->processors);
+		for (u32 i = processor; i < CPU_PROCESSOR_MAX; i++) {
+			if (cpu_set_contains(&siblings, i) && cpu_set_contains(&online, i)) {
+				cpu_set_add(&core->processors, i);
+				cpu_set_add(&assigned, i);
+			}
+		}
+		core->processor_count = cpu_set_count(&core->processors);
+		core->first_processor = processor;
+
+		snprintf(path, sizeof(path), CPU_SYSFS_PATH "/cpu%u/topology/physical_package_id", processor);
+		if (!read_sys_u32(path, &core->package)) {
+			core->package = 0;
+		}
+		cpu_set_add(&packages, core->package);
+
+		// Capacity is scaled so the fastest core is 1024, and only exposed on hybrid ARM and newer x86 kernels
+		snprintf(path, sizeof(path), CPU_SYSFS_PATH "/cpu%u/cpu_capacity", processor);
+		if (hybrid) {
+			core->performance_class = cpu_set_contains(&atom, processor) ? 0 : 1;
+		} else if (!read_sys_u32(path, &core->performance_class)) {
+			core->performance_class = 0;
+		}
+
+		out_topology->processor_count += core->processor_count;
+	}
+
+	out_topology->package_count = cpu_set_count(&packages);
+	if (out_topology->core_count > 0) {
+		detect_caches(out_topology, out_topology->cores[0].first_processor);
+	}
+	return true;
+}
+
+//
+// Affinity
+//
+
+// Processors the cgroup's cpuset allows, from the unified hierarchy or the v1 cpuset controller. Each line of
+// /proc/self/cgroup is "hierarchy:controllers:path", and the unified one has hierarchy zero and no controllers.
+static b8 read_cgroup_cpuset(Cpu_Set* out_set) {
+	char buffer[4096];
+	if (!read_sys_file("/proc/self/cgroup", buffer, sizeof(buffer))) {
+		return false;
+	}
+
+	char* line = buffer;
+	while (line) {
+		char* next = strchr(line, '\n');
+		if (next) {
+			*next++ = '\0';
+		}
+		char* controllers = strchr(line, ':');
+		char* path = controllers ? strchr(controllers + 1, ':') : null;
+		if (path) {
+			controllers++;
+			*path++ = '\0';
+
+			char file[512];
+			file[0] = '\0';
+			if (strncmp(line, "0:", 2) == 0 && controllers[0] == '\0') {
+				snprintf(file, sizeof(file), CPU_CGROUP_PATH "%s/cpuset.cpus.effective", path);
+			} else {
+				char* saved;
+				for (char* name = strtok_r(controllers, ",", &saved); name; name = strtok_r(null, ",", &saved)) {
+					if (strcmp(name, "cpuset") == 0) {
+						snprintf(file, sizeof(file), CPU_CGROUP_PATH "/cpuset%s/cpuset.effective_cpus", path);
+						break;
+					}
+				}
+			}
+			if (file[0] && read_sys_cpu_list(file, out_set)) {
+				return true;
+			}
+		}
+		line = next;
+	}
+	return false;
+}
+
+b8 platform_get_process_affinity(Cpu_Set* out_processors) {
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+		return false;
+	}
+
+	cpu_set_clear(out_processors);
+	for (u32 i = 0; i < CPU_PROCESSOR_MAX && i < CPU_SETSIZE; i++) {
+		if (CPU_ISSET(i, &set)) {
+			cpu_set_add(out_processors, i);
+		}
+	}
+
+	// The kernel normally applies the cpuset to the affinity already, this covers the setups where it does not
+	Cpu_Set cpuset;
+	if (read_cgroup_cpuset(&cpuset)) {
+		for (u32 i = 0; i < CPU_PROCESSOR_MAX / 64; i++) {
+			out_processors->bits[i] &= cpuset.bits[i];
+		}
+	}
+	return true;
+}
+
+b8 platform_set_thread_affinity(const Cpu_Set* processors) {
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (u32 i = 0; i < CPU_PROCESSOR_MAX; i++) {
+		if (cpu_set_contains(processors, i)) {
+			CPU_SET(i, &set);
+		}
+	}
+
+	i32 result = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+	if (result != 0) {
+		log_error("Failed to set thread affinity: %s", strerror(result));
+		return false;
+	}
+	return true;
+}
+
+#endif // PLATFORM_LINUX
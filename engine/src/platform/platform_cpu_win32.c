@@ -0,0 +1,162 @@
+#include "platform/platform_cpu.h"
+
+#include "core/context.h"
+#include "core/log.h"
+#include "core/memory.h"
+
+#ifdef PLATFORM_WINDOWS
+
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+
+// Processor numbers are the group times 64 plus the bit in the group's mask
+static void add_group_mask(Cpu_Set* set, const GROUP_AFFINITY* affinity) {
+	for (u32 bit = 0; bit < 64; bit++) {
+		if (affinity->Mask & ((KAFFINITY)1 << bit)) {
+			cpu_set_add(set, (u32)affinity->Group * 64 + bit);
+		}
+	}
+}
+
+//
+// Topology
+//
+
+b8 platform_detect_cpu_topology(Cpu_Topology* out_topology) {
+	memory_zero(out_topology, sizeof(Cpu_Topology));
+
+	DWORD length = 0;
+	GetLogicalProcessorInformationEx(RelationAll, null, &length);
+	if (GetLastError() != ERROR_INSUFFICIENT_BUFFER) {
+		log_error("Failed to query processor information: %lu", GetLastError());
+		return false;
+	}
+	u8* buffer = memory_alloc(length, MEMORY_TAG_PLATFORM);
+	if (!GetLogicalProcessorInformationEx(RelationAll, (PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX)buffer, &length)) {
+		log_error("Failed to query processor information: %lu", GetLastError());
+		memory_free(buffer, length, MEMORY_TAG_PLATFORM);
+		return false;
+	}
+
+	// Cores on packages past the last one tracked report package zero
+	Cpu_Set package_sets[CPU_PROCESSOR_MAX / 64];
+	u32 package_count = 0;
+
+	for (DWORD offset = 0; offset < length;) {
+		PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX info = (PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX)(buffer + offset);
+		offset += info->Size;
+
+		switch (info->Relationship) {
+			case RelationProcessorCore: {
+				if (out_topology->core_count == CPU_PROCESSOR_MAX) {
+					break;
+				}
+				Cpu_Core* core = &out_topology->cores[out_topology->core_count++];
+				for (WORD i = 0; i < info->Processor.GroupCount; i++) {
+					add_group_mask(&core->processors, &info->Processor.GroupMask[i]);
+				}
+				core->processor_count = cpu_set_count(&core->processors);
+				for (u32 i = 0; i < CPU_PROCESSOR_MAX; i++) {
+					if (cpu_set_contains(&core->processors, i)) {
+						core->first_processor = i;
+						break;
+					}
+				}
+				// Higher efficiency classes are the faster cores, all zero on CPUs without hybrid cores
+				core->performance_class = info->Processor.EfficiencyClass;
+				out_topology->processor_count += core->processor_count;
+			} break;
+
+			case RelationProcessorPackage: {
+				if (package_count == CPU_PROCESSOR_MAX / 64) {
+					break;
+				}
+				Cpu_Set* package = &package_sets[package_count++];
+				cpu_set_clear(package);
+				for (WORD i = 0; i < info->Processor.GroupCount; i++) {
+					add_group_mask(package, &info->Processor.GroupMask[i]);
+				}
+			} break;
+
+			case RelationCache: {
+				CACHE_RELATIONSHIP* relation = &info->Cache;
+				if (relation->Level < 1 || relation->Level > CPU_CACHE_LEVEL_MAX || relation->Type == CacheInstruction) {
+					break;
+				}
+				// The first one reported for each level is the one of the first core
+				Cpu_Cache* cache = &out_topology->caches[relation->Level - 1];
+				if (cache->size == 0) {
+					Cpu_Set shared;
+					cpu_set_clear(&shared);
+					add_group_mask(&shared, &relation->GroupMask);
+					cache->size = relation->CacheSize;
+					cache->line_size = relation->LineSize;
+					cache->shared_processor_count = cpu_set_count(&shared);
+				}
+			} break;
+
+			default:
+				break;
+		}
+	}
+
+	out_topology->package_count = package_count > 0 ? package_count : 1;
+	for (u32 i = 0; i < out_topology->core_count; i++) {
+		Cpu_Core* core = &out_topology->cores[i];
+		for (u32 package = 0; package < package_count; package++) {
+			if (cpu_set_contains(&package_sets[package], core->first_processor)) {
+				core->package = package;
+				break;
+			}
+		}
+	}
+
+	memory_free(buffer, length, MEMORY_TAG_PLATFORM);
+	return true;
+}
+
+//
+// Affinity
+//
+
+b8 platform_get_process_affinity(Cpu_Set* out_processors) {
+	// Only a process confined to one processor group has a mask, one spanning several can run anywhere
+	USHORT group = 0;
+	USHORT group_count = 1;
+	DWORD_PTR process_mask = 0;
+	DWORD_PTR system_mask = 0;
+	if (!GetProcessGroupAffinity(GetCurrentProcess(), &group_count, &group) ||
+		!GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask) || process_mask == 0) {
+		return false;
+	}
+
+	GROUP_AFFINITY affinity = {0};
+	affinity.Group = group;
+	affinity.Mask = (KAFFINITY)process_mask;
+	cpu_set_clear(out_processors);
+	add_group_mask(out_processors, &affinity);
+	return true;
+}
+
+b8 platform_set_thread_affinity(const Cpu_Set* processors) {
+	// A thread can only be restricted to processors of one group, so the group of the first one is used
+	GROUP_AFFINITY affinity = {0};
+	for (u32 i = 0; i < CPU_PROCESSOR_MAX / 64; i++) {
+		if (processors->bits[i]) {
+			affinity.Group = (WORD)i;
+			affinity.Mask = (KAFFINITY)processors->bits[i];
+			break;
+		}
+	}
+	if (affinity.Mask == 0) {
+		return false;
+	}
+
+	if (!SetThreadGroupAffinity(GetCurrentThread(), &affinity, null)) {
+		log_error("Failed to set thread affinity: %lu", GetLastError());
+		return false;
+	}
+	return true;
+}
+
+#endif // PLATFORM_WINDOWS
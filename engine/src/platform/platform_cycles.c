@@ -0,0 +1,107 @@
+#include "platform/platform.h"
+
+#include "core/log.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#	define CYCLES_RDTSC 1
+#	include <cpuid.h>
+#	include <x86intrin.h>
+#elif defined(__aarch64__)
+#	define CYCLES_CNTVCT 1
+#endif
+
+// Length of the busy wait the TSC is measured over
+#define CYCLES_CALIBRATION_NS 10000000ull
+
+typedef enum Cycle_Source {
+	// Monotonic clock, one cycle per nanosecond
+	CYCLE_SOURCE_CLOCK,
+	CYCLE_SOURCE_RDTSC,
+	CYCLE_SOURCE_CNTVCT,
+} Cycle_Source;
+
+typedef struct Cycle_Counter {
+	b8 calibrated;
+	Cycle_Source source;
+	u64 frequency;
+} Cycle_Counter;
+
+static Cycle_Counter counter = {0};
+
+#if CYCLES_RDTSC
+// Only a TSC that ticks at a constant rate through frequency and power state changes can be used as a clock
+static b8 has_invariant_tsc(void) {
+	u32 eax, ebx, ecx, edx;
+	if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) || eax < 0x80000007) {
+		return false;
+	}
+	__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+	return (edx >> 8) & 1;
+}
+#endif
+
+u64 platform_get_cycles(void) {
+#if CYCLES_RDTSC
+	if (counter.source == CYCLE_SOURCE_RDTSC) {
+		return __rdtsc();
+	}
+#elif CYCLES_CNTVCT
+	if (counter.source == CYCLE_SOURCE_CNTVCT) {
+		u64 value;
+		__asm__ volatile("isb; mrs %0, cntvct_el0" : "=r"(value));
+		return value;
+	}
+#endif
+	return platform_get_time_ns();
+}
+
+void platform_calibrate_cycles(void) {
+	if (counter.calibrated) {
+		return;
+	}
+
+	counter.source = CYCLE_SOURCE_CLOCK;
+	counter.frequency = 1000000000ull;
+
+#if CYCLES_RDTSC
+	if (has_invariant_tsc()) {
+		// Measure the TSC against the monotonic clock over a short busy wait
+		u64 start_ns = platform_get_time_ns();
+		u64 start_cycles = __rdtsc();
+		u64 end_ns;
+		do {
+			end_ns = platform_get_time_ns();
+		} while (end_ns - start_ns < CYCLES_CALIBRATION_NS);
+		u64 end_cycles = __rdtsc();
+
+		counter.source = CYCLE_SOURCE_RDTSC;
+		counter.frequency = (u64)((f64)(end_cycles - start_cycles) * 1e9 / (f64)(end_ns - start_ns));
+	} else {
+		log_warn("TSC is not invariant, falling back to the monotonic clock for cycle counts");
+	}
+#elif CYCLES_CNTVCT
+	// The generic timer reports its own fixed frequency
+	u64 frequency;
+	__asm__ volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+	if (frequency) {
+		counter.source = CYCLE_SOURCE_CNTVCT;
+		counter.frequency = frequency;
+	}
+#endif
+
+	counter.calibrated = true;
+	log_debug("Cycle counter running at %llu Hz", counter.frequency);
+}
+
+u64 platform_get_cycle_frequency(void) {
+	platform_calibrate_cycles();
+	return counter.frequency;
+}
+
+u64 platform_cycles_to_ns(u64 cycles) {
+	u64 frequency = platform_get_cycle_frequency();
+	// Split to avoid overflowing the multiply
+	u64 seconds = cycles / frequency;
+	u64 remainder = cycles % frequency;
+	return seconds * 1000000000ull + remainder * 1000000000ull / frequency;
+}
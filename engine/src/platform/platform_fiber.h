@@ -0,0 +1,47 @@
+#pragma once
+
+#include "core/export.h"
+#include "core/types.h"
+
+/**
+ * Cooperative fibers.
+ *
+ * A fiber is a stack and a saved register set that threads switch to and from explicitly. On x86-64 Linux the switch is
+ * a few instructions that save the callee saved registers on the old stack and load them from the new one. Other Linux
+ * targets fall back to ucontext, which also saves the signal mask and so costs a system call. Windows uses its native
+ * fibers.
+ *
+ * Fiber stacks are mapped with an inaccessible guard page below them, so an overflow faults instead of silently
+ * corrupting the neighbouring memory. A thread has to be converted into a fiber before it can switch to one.
+ */
+
+#define FIBER_STACK_SIZE_DEFAULT (64 * 1024)
+
+// Must never return. Switch to another fiber instead.
+typedef void (*Fiber_Function)(void* data);
+
+// Must stay at the same address while the fiber is alive
+typedef struct Fiber {
+	// Saved stack pointer, ucontext or OS fiber handle
+	void* context;
+	// Mapping including the guard page, null for converted threads
+	void* stack;
+	u64 stack_size;
+	Fiber_Function function;
+	void* data;
+} Fiber;
+
+// The stack size is rounded up to whole pages, zero uses FIBER_STACK_SIZE_DEFAULT
+export b8 fiber_create(Fiber* out_fiber, u64 stack_size, Fiber_Function function, void* data);
+
+// The fiber must not be running
+export void fiber_destroy(Fiber* fiber);
+
+// Makes the calling thread a fiber that other fibers can switch back to
+export b8 fiber_convert_thread(Fiber* out_fiber);
+
+// Undoes fiber_convert_thread. Must be called on the converted thread while it runs its own fiber.
+export void fiber_convert_back(Fiber* fiber);
+
+// Saves the calling fiber into from and continues running to
+export void fiber_switch(Fiber* from, Fiber* to);
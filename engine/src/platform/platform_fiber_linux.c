@@ -0,0 +1,194 @@
+#include "platform/platform_fiber.h"
+
+#include "core/context.h"
+#include "core/log.h"
+#include "core/memory.h"
+
+#ifdef PLATFORM_LINUX
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef __x86_64__
+#	define FIBER_ASSEMBLY_ENABLED 1
+#else
+#	define FIBER_ASSEMBLY_ENABLED 0
+#	include <ucontext.h>
+#endif
+
+static void fiber_main(Fiber* fiber) {
+	fiber->function(fiber->data);
+	log_fatal("Fiber function returned");
+	abort();
+}
+
+//
+// Context switch
+//
+
+#if FIBER_ASSEMBLY_ENABLED
+
+// Saves the System V callee saved registers, MXCSR and the x87 control word on the current stack, stores the stack
+// pointer in *from and restores the same set from the to stack. A new fiber's stack is laid out as if it had switched
+// away at its first instruction, returning into fiber_start with the fiber in r12 and fiber_main in r13.
+__attribute__((visibility("hidden"))) void fiber_switch_context(void** from, void* to);
+__attribute__((visibility("hidden"))) void fiber_start(void);
+
+__asm__(
+	".text\n"
+	".globl fiber_switch_context\n"
+	".hidden fiber_switch_context\n"
+	".type fiber_switch_context, @function\n"
+	"fiber_switch_context:\n"
+	"	pushq %rbp\n"
+	"	pushq %rbx\n"
+	"	pushq %r12\n"
+	"	pushq %r13\n"
+	"	pushq %r14\n"
+	"	pushq %r15\n"
+	"	subq $8, %rsp\n"
+	"	stmxcsr (%rsp)\n"
+	"	fnstcw 4(%rsp)\n"
+	"	movq %rsp, (%rdi)\n"
+	"	movq %rsi, %rsp\n"
+	"	ldmxcsr (%rsp)\n"
+	"	fldcw 4(%rsp)\n"
+	"	addq $8, %rsp\n"
+	"	popq %r15\n"
+	"	popq %r14\n"
+	"	popq %r13\n"
+	"	popq %r12\n"
+	"	popq %rbx\n"
+	"	popq %rbp\n"
+	"	ret\n"
+	".size fiber_switch_context, .-fiber_switch_context\n"
+	"\n"
+	".globl fiber_start\n"
+	".hidden fiber_start\n"
+	".type fiber_start, @function\n"
+	"fiber_start:\n"
+	"	movq %r12, %rdi\n"
+	"	callq *%r13\n"
+	"	ud2\n"
+	".size fiber_start, .-fiber_start\n"
+);
+
+// Register slots pushed by fiber_switch_context, from the stack pointer up
+typedef struct Fiber_Frame {
+	u32 mxcsr;
+	u16 x87_control;
+	u16 padding;
+	u64 r15;
+	u64 r14;
+	u64 r13;
+	u64 r12;
+	u64 rbx;
+	u64 rbp;
+	u64 return_address;
+} Fiber_Frame;
+
+static void init_context(Fiber* fiber, u8* stack) {
+	u8* stack_top = stack + fiber->stack_size;
+	// Leaves the stack 16 byte aligned once fiber_start has been returned into, as the ABI expects before a call
+	Fiber_Frame* frame = (Fiber_Frame*)(stack_top - 16 - sizeof(Fiber_Frame));
+	memory_zero(frame, sizeof(Fiber_Frame));
+	frame->mxcsr = 0x1F80;
+	frame->x87_control = 0x037F;
+	frame->r12 = (u64)fiber;
+	frame->r13 = (u64)fiber_main;
+	frame->return_address = (u64)fiber_start;
+	fiber->context = frame;
+}
+
+#else
+
+// makecontext only passes int arguments, so the fiber pointer is split in two
+static void fiber_main_ucontext(u32 high, u32 low) {
+	fiber_main((Fiber*)(((u64)high << 32) | (u64)low));
+}
+
+static void init_context(Fiber* fiber, u8* stack) {
+	ucontext_t* context = memory_alloc(sizeof(ucontext_t), MEMORY_TAG_PLATFORM);
+	getcontext(context);
+	context->uc_stack.ss_sp = stack;
+	context->uc_stack.ss_size = fiber->stack_size;
+	context->uc_link = null;
+	u64 address = (u64)fiber;
+	makecontext(context, (void (*)(void))fiber_main_ucontext, 2, (u32)(address >> 32), (u32)address);
+	fiber->context = context;
+}
+
+#endif
+
+//
+// Fibers
+//
+
+b8 fiber_create(Fiber* out_fiber, u64 stack_size, Fiber_Function function, void* data) {
+	u64 page_size = (u64)sysconf(_SC_PAGESIZE);
+	if (stack_size == 0) {
+		stack_size = FIBER_STACK_SIZE_DEFAULT;
+	}
+	stack_size = (stack_size + page_size - 1) & ~(page_size - 1);
+
+	// Stacks grow down, so the guard page goes at the start of the mapping
+	u8* mapping = mmap(null, stack_size + page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+	if (mapping == MAP_FAILED) {
+		log_error("Failed to map a %llu byte fiber stack: %s", stack_size, strerror(errno));
+		return false;
+	}
+	if (mprotect(mapping, page_size, PROT_NONE) != 0) {
+		log_error("Failed to protect the fiber stack guard page: %s", strerror(errno));
+		munmap(mapping, stack_size + page_size);
+		return false;
+	}
+
+	out_fiber->stack = mapping;
+	out_fiber->stack_size = stack_size;
+	out_fiber->function = function;
+	out_fiber->data = data;
+	init_context(out_fiber, mapping + page_size);
+	return true;
+}
+
+void fiber_destroy(Fiber* fiber) {
+#if !FIBER_ASSEMBLY_ENABLED
+	memory_free(fiber->context, sizeof(ucontext_t), MEMORY_TAG_PLATFORM);
+#endif
+	if (fiber->stack) {
+		munmap(fiber->stack, fiber->stack_size + (u64)sysconf(_SC_PAGESIZE));
+	}
+	fiber->context = null;
+	fiber->stack = null;
+}
+
+b8 fiber_convert_thread(Fiber* out_fiber) {
+	out_fiber->stack = null;
+	out_fiber->stack_size = 0;
+	out_fiber->function = null;
+	out_fiber->data = null;
+#if FIBER_ASSEMBLY_ENABLED
+	// The stack pointer is saved by the first switch away
+	out_fiber->context = null;
+#else
+	out_fiber->context = memory_alloc(sizeof(ucontext_t), MEMORY_TAG_PLATFORM);
+#endif
+	return true;
+}
+
+void fiber_convert_back(Fiber* fiber) {
+	fiber_destroy(fiber);
+}
+
+void fiber_switch(Fiber* from, Fiber* to) {
+#if FIBER_ASSEMBLY_ENABLED
+	fiber_switch_context(&from->context, to->context);
+#else
+	swapcontext((ucontext_t*)from->context, (ucontext_t*)to->context);
+#endif
+}
+
+#endif // PLATFORM_LINUX
@@ -0,0 +1,75 @@
+#include "platform/platform_fiber.h"
+
+#include "core/context.h"
+#include "core/log.h"
+
+#ifdef PLATFORM_WINDOWS
+
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <stdlib.h>
+
+static VOID WINAPI fiber_main(LPVOID arg) {
+	Fiber* fiber = (Fiber*)arg;
+	fiber->function(fiber->data);
+	log_fatal("Fiber function returned");
+	abort();
+}
+
+//
+// Fibers
+//
+
+b8 fiber_create(Fiber* out_fiber, u64 stack_size, Fiber_Function function, void* data) {
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	u64 page_size = (u64)info.dwPageSize;
+	if (stack_size == 0) {
+		stack_size = FIBER_STACK_SIZE_DEFAULT;
+	}
+	stack_size = (stack_size + page_size - 1) & ~(page_size - 1);
+
+	out_fiber->stack = null;
+	out_fiber->stack_size = stack_size;
+	out_fiber->function = function;
+	out_fiber->data = data;
+
+	// Windows reserves the stack with its own guard page and commits pages as the fiber touches them
+	out_fiber->context = CreateFiberEx(page_size, (SIZE_T)stack_size, FIBER_FLAG_FLOAT_SWITCH, fiber_main, out_fiber);
+	if (!out_fiber->context) {
+		log_error("Failed to create fiber: %lu", GetLastError());
+		return false;
+	}
+	return true;
+}
+
+void fiber_destroy(Fiber* fiber) {
+	if (fiber->context) {
+		DeleteFiber(fiber->context);
+	}
+	fiber->context = null;
+}
+
+b8 fiber_convert_thread(Fiber* out_fiber) {
+	out_fiber->stack = null;
+	out_fiber->stack_size = 0;
+	out_fiber->function = null;
+	out_fiber->data = null;
+	out_fiber->context = ConvertThreadToFiberEx(null, FIBER_FLAG_FLOAT_SWITCH);
+	if (!out_fiber->context) {
+		log_error("Failed to convert thread to a fiber: %lu", GetLastError());
+		return false;
+	}
+	return true;
+}
+
+void fiber_convert_back(Fiber* fiber) {
+	ConvertFiberToThread();
+	fiber->context = null;
+}
+
+void fiber_switch(Fiber* from, Fiber* to) {
+	SwitchToFiber(to->context);
+}
+
+#endif // PLATFORM_WINDOWS
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "core/export.h"
+#include "core/types.h"
+
+/**
+ * Memory mapped files.
+ *
+ * Mapping a file makes its contents readable straight from the OS page cache, so loaders can parse in place with no
+ * read call, allocation or copy. Pages are faulted in as they are first touched. The advise hints steer the kernel's
+ * readahead (madvise on Linux, PrefetchVirtualMemory and VirtualUnlock on Windows) and are free to ignore.
+ *
+ * Mapped data is not null terminated.
+ *
+ * Also stats and lists files, which the VFS caches so loaders don't repeat the syscalls.
+ */
+
+typedef enum File_Map_Mode {
+	// Writing to the data faults
+	FILE_MAP_READ_ONLY,
+	// Writes go to private copies of the touched pages and never reach the file
+	FILE_MAP_COPY_ON_WRITE,
+} File_Map_Mode;
+
+typedef enum File_Map_Advice {
+	FILE_MAP_ADVICE_NORMAL,
+	// Read ahead aggressively and drop pages soon after they are read
+	FILE_MAP_ADVICE_SEQUENTIAL,
+	// Don't read ahead
+	FILE_MAP_ADVICE_RANDOM,
+	// Start reading the range in now
+	FILE_MAP_ADVICE_WILLNEED,
+	// The range won't be touched again soon, its pages can be reclaimed
+	FILE_MAP_ADVICE_DONTNEED,
+} File_Map_Advice;
+
+typedef struct File_Stat {
+	u64 size;
+	// Last write time in nanoseconds since the Unix epoch
+	u64 modified_ns;
+	b8 is_directory;
+} File_Stat;
+
+// Called once per entry, not including "." and ".."
+typedef void (*File_List_Callback)(const char* name, b8 is_directory, void* data);
+
+typedef struct File_Map {
+	void* data;
+	u64 size;
+	// OS file and mapping handles where the mapping needs them kept open
+	u64 file;
+	u64 mapping;
+} File_Map;
+
+// An empty file maps to a valid pointer with a size of zero
+export b8 platform_file_map(const char* path, File_Map_Mode mode, File_Map* out_map);
+
+export void platform_file_unmap(File_Map* map);
+
+// Hints how a byte range of the mapping will be used. The range is widened to whole pages.
+export void platform_file_advise(File_Map* map, u64 offset, u64 size, File_Map_Advice advice);
+
+//
+// Metadata
+//
+
+// Returns false without logging if the path doesn't exist
+export b8 platform_file_stat(const char* path, File_Stat* out_stat);
+
+export b8 platform_file_list(const char* directory, File_List_Callback callback, void* data);
+
+// Directory of the running executable, without a trailing separator
+export b8 platform_get_executable_directory(char* out_path, u64 size);
@@ -0,0 +1,150 @@
+#include "platform/platform_file.h"
+
+#include "core/context.h"
+#include "core/log.h"
+
+#ifdef PLATFORM_LINUX
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Mapping zero bytes fails, so empty files all share this
+static char empty_file[1] = { 0 };
+
+static const i32 advice_flags[] = {
+	MADV_NORMAL,
+	MADV_SEQUENTIAL,
+	MADV_RANDOM,
+	MADV_WILLNEED,
+	MADV_DONTNEED,
+};
+
+//
+// Mapping
+//
+
+b8 platform_file_map(const char* path, File_Map_Mode mode, File_Map* out_map) {
+	out_map->data = null;
+	out_map->size = 0;
+	out_map->file = 0;
+	out_map->mapping = 0;
+
+	i32 fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		log_error("Failed to open %s: %s", path, strerror(errno));
+		return false;
+	}
+
+	struct stat status;
+	if (fstat(fd, &status) != 0) {
+		log_error("Failed to stat %s: %s", path, strerror(errno));
+		close(fd);
+		return false;
+	}
+
+	if (status.st_size == 0) {
+		close(fd);
+		out_map->data = empty_file;
+		return true;
+	}
+
+	i32 protection = mode == FILE_MAP_COPY_ON_WRITE ? PROT_READ | PROT_WRITE : PROT_READ;
+	i32 flags = mode == FILE_MAP_COPY_ON_WRITE ? MAP_PRIVATE : MAP_SHARED;
+	void* data = mmap(null, (size_t)status.st_size, protection, flags, fd, 0);
+	// The mapping keeps its own reference to the file
+	close(fd);
+	if (data == MAP_FAILED) {
+		log_error("Failed to map %s: %s", path, strerror(errno));
+		return false;
+	}
+
+	out_map->data = data;
+	out_map->size = (u64)status.st_size;
+	return true;
+}
+
+void platform_file_unmap(File_Map* map) {
+	if (map->data && map->data != empty_file) {
+		munmap(map->data, map->size);
+	}
+	map->data = null;
+	map->size = 0;
+}
+
+void platform_file_advise(File_Map* map, u64 offset, u64 size, File_Map_Advice advice) {
+	if (map->size == 0 || offset >= map->size) {
+		return;
+	}
+	if (size > map->size - offset) {
+		size = map->size - offset;
+	}
+
+	u64 page_size = (u64)sysconf(_SC_PAGESIZE);
+	u64 begin = offset & ~(page_size - 1);
+	u64 end = offset + size;
+	if (madvise((u8*)map->data + begin, end - begin, advice_flags[advice]) != 0) {
+		log_warn("Failed to advise mapping: %s", strerror(errno));
+	}
+}
+
+//
+// Metadata
+//
+
+b8 platform_file_stat(const char* path, File_Stat* out_stat) {
+	struct stat status;
+	if (stat(path, &status) != 0) {
+		return false;
+	}
+	out_stat->size = (u64)status.st_size;
+	out_stat->modified_ns = (u64)status.st_mtim.tv_sec * 1000000000ull + (u64)status.st_mtim.tv_nsec;
+	out_stat->is_directory = S_ISDIR(status.st_mode);
+	return true;
+}
+
+b8 platform_file_list(const char* directory, File_List_Callback callback, void* data) {
+	DIR* dir = opendir(directory);
+	if (!dir) {
+		return false;
+	}
+
+	struct dirent* entry;
+	while ((entry = readdir(dir))) {
+		const char* name = entry->d_name;
+		if (name[0] == '.' && (name[1] == 0 || (name[1] == '.' && name[2] == 0))) {
+			continue;
+		}
+
+		b8 is_directory = entry->d_type == DT_DIR;
+		// Some file systems don't fill in the type, and links need following
+		if (entry->d_type == DT_UNKNOWN || entry->d_type == DT_LNK) {
+			struct stat status;
+			is_directory = fstatat(dirfd(dir), name, &status, 0) == 0 && S_ISDIR(status.st_mode);
+		}
+		callback(name, is_directory, data);
+	}
+	closedir(dir);
+	return true;
+}
+
+b8 platform_get_executable_directory(char* out_path, u64 size) {
+	ssize_t length = readlink("/proc/self/exe", out_path, size - 1);
+	if (length <= 0) {
+		return false;
+	}
+	out_path[length] = 0;
+
+	char* separator = strrchr(out_path, '/');
+	if (!separator) {
+		return false;
+	}
+	*(separator == out_path ? separator + 1 : separator) = 0;
+	return true;
+}
+
+#endif // PLATFORM_LINUX
@@ -0,0 +1,166 @@
+#include "platform/platform_file.h"
+
+#include "core/context.h"
+#include "core/log.h"
+
+#ifdef PLATFORM_WINDOWS
+
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+
+#include <stdio.h>
+#include <string.h>
+
+// Mapping zero bytes fails, so empty files all share this
+static char empty_file[1] = { 0 };
+
+//
+// Mapping
+//
+
+b8 platform_file_map(const char* path, File_Map_Mode mode, File_Map* out_map) {
+	out_map->data = null;
+	out_map->size = 0;
+	out_map->file = 0;
+	out_map->mapping = 0;
+
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, null, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, null);
+	if (file == INVALID_HANDLE_VALUE) {
+		log_error("Failed to open %s: %lu", path, GetLastError());
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size)) {
+		log_error("Failed to get the size of %s: %lu", path, GetLastError());
+		CloseHandle(file);
+		return false;
+	}
+
+	if (size.QuadPart == 0) {
+		CloseHandle(file);
+		out_map->data = empty_file;
+		return true;
+	}
+
+	DWORD protection = mode == FILE_MAP_COPY_ON_WRITE ? PAGE_WRITECOPY : PAGE_READONLY;
+	HANDLE mapping = CreateFileMappingA(file, null, protection, 0, 0, null);
+	if (!mapping) {
+		log_error("Failed to create a mapping of %s: %lu", path, GetLastError());
+		CloseHandle(file);
+		return false;
+	}
+
+	DWORD access = mode == FILE_MAP_COPY_ON_WRITE ? FILE_MAP_COPY : FILE_MAP_READ;
+	void* data = MapViewOfFile(mapping, access, 0, 0, 0);
+	if (!data) {
+		log_error("Failed to map %s: %lu", path, GetLastError());
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	out_map->data = data;
+	out_map->size = (u64)size.QuadPart;
+	out_map->file = (u64)file;
+	out_map->mapping = (u64)mapping;
+	return true;
+}
+
+void platform_file_unmap(File_Map* map) {
+	if (map->data && map->data != empty_file) {
+		UnmapViewOfFile(map->data);
+		CloseHandle((HANDLE)map->mapping);
+		CloseHandle((HANDLE)map->file);
+	}
+	map->data = null;
+	map->size = 0;
+	map->file = 0;
+	map->mapping = 0;
+}
+
+void platform_file_advise(File_Map* map, u64 offset, u64 size, File_Map_Advice advice) {
+	if (map->size == 0 || offset >= map->size) {
+		return;
+	}
+	if (size > map->size - offset) {
+		size = map->size - offset;
+	}
+
+	WIN32_MEMORY_RANGE_ENTRY range = { (u8*)map->data + offset, (SIZE_T)size };
+	switch (advice) {
+		case FILE_MAP_ADVICE_WILLNEED: {
+			if (!PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0)) {
+				log_warn("Failed to prefetch mapping: %lu", GetLastError());
+			}
+		} break;
+
+		case FILE_MAP_ADVICE_DONTNEED: {
+			// Unlocking pages that aren't locked fails, but still trims them from the working set
+			VirtualUnlock(range.VirtualAddress, range.NumberOfBytes);
+		} break;
+
+		default:
+			// Views have no readahead hints, the cache manager detects sequential access by itself
+			break;
+	}
+}
+
+//
+// Metadata
+//
+
+// FILETIME counts 100 nanosecond intervals since 1601
+static u64 filetime_to_unix_ns(FILETIME time) {
+	u64 ticks = ((u64)time.dwHighDateTime << 32) | time.dwLowDateTime;
+	return (ticks - 116444736000000000ull) * 100;
+}
+
+b8 platform_file_stat(const char* path, File_Stat* out_stat) {
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+	if (!GetFileAttributesExA(path, GetFileExInfoStandard, &attributes)) {
+		return false;
+	}
+	out_stat->size = ((u64)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow;
+	out_stat->modified_ns = filetime_to_unix_ns(attributes.ftLastWriteTime);
+	out_stat->is_directory = (attributes.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+	return true;
+}
+
+b8 platform_file_list(const char* directory, File_List_Callback callback, void* data) {
+	char pattern[MAX_PATH];
+	if (snprintf(pattern, sizeof(pattern), "%s\\*", directory) >= (i32)sizeof(pattern)) {
+		return false;
+	}
+
+	WIN32_FIND_DATAA entry;
+	HANDLE find = FindFirstFileExA(pattern, FindExInfoBasic, &entry, FindExSearchNameMatch, null, FIND_FIRST_EX_LARGE_FETCH);
+	if (find == INVALID_HANDLE_VALUE) {
+		return GetLastError() == ERROR_FILE_NOT_FOUND;
+	}
+	do {
+		const char* name = entry.cFileName;
+		if (name[0] == '.' && (name[1] == 0 || (name[1] == '.' && name[2] == 0))) {
+			continue;
+		}
+		callback(name, (entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0, data);
+	} while (FindNextFileA(find, &entry));
+	FindClose(find);
+	return true;
+}
+
+b8 platform_get_executable_directory(char* out_path, u64 size) {
+	DWORD length = GetModuleFileNameA(null, out_path, (DWORD)size);
+	if (length == 0 || length >= size) {
+		return false;
+	}
+
+	char* separator = strrchr(out_path, '\\');
+	if (!separator) {
+		return false;
+	}
+	*separator = 0;
+	return true;
+}
+
+#endif // PLATFORM_WINDOWS
@@ -0,0 +1,61 @@
+#include "platform/platform_headless.h"
+
+#include "core/context.h"
+#include "core/log.h"
+
+#if PLATFORM_LINUX
+#	include <signal.h>
+#elif PLATFORM_WINDOWS
+#	define WIN32_LEAN_AND_MEAN
+#	include <Windows.h>
+#endif
+
+// Set from a signal handler, so it can only be a plain flag
+static volatile i32 quit_requested = 0;
+
+#if PLATFORM_LINUX
+static void handle_quit_signal(int signal) {
+	quit_requested = 1;
+}
+#elif PLATFORM_WINDOWS
+static BOOL WINAPI handle_console_control(DWORD type) {
+	quit_requested = 1;
+	return TRUE;
+}
+#endif
+
+b8 platform_headless_start(Platform* platform, const char* app_name) {
+	log_info("Platform start (headless) for %s", app_name);
+	platform_calibrate_cycles();
+	platform->internal = null;
+	quit_requested = 0;
+
+#if PLATFORM_LINUX
+	struct sigaction action = {0};
+	action.sa_handler = handle_quit_signal;
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGINT, &action, null);
+	sigaction(SIGTERM, &action, null);
+#elif PLATFORM_WINDOWS
+	SetConsoleCtrlHandler(handle_console_control, TRUE);
+#endif
+
+	return true;
+}
+
+void platform_headless_shutdown(Platform* platform) {
+#if PLATFORM_LINUX
+	signal(SIGINT, SIG_DFL);
+	signal(SIGTERM, SIG_DFL);
+#elif PLATFORM_WINDOWS
+	SetConsoleCtrlHandler(handle_console_control, FALSE);
+#endif
+}
+
+b8 platform_headless_pump_messages(Platform* platform) {
+	if (quit_requested) {
+		log_info("Quit requested");
+		return false;
+	}
+	return true;
+}
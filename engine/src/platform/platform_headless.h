@@ -0,0 +1,15 @@
+#pragma once
+
+#include "platform/platform.h"
+
+/**
+ * The headless backend, shared by every OS. The OS platform functions forward here when the platform's backend is
+ * PLATFORM_BACKEND_HEADLESS.
+ */
+
+b8 platform_headless_start(Platform* platform, const char* app_name);
+
+void platform_headless_shutdown(Platform* platform);
+
+// Returns false once the process is asked to stop by SIGINT, SIGTERM or a console close
+b8 platform_headless_pump_messages(Platform* platform);
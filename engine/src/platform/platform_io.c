@@ -0,0 +1,194 @@
+#include "platform/platform_io.h"
+
+#include "core/atomic.h"
+#include "core/log.h"
+#include "platform/platform_thread.h"
+
+#include <stdio.h>
+
+typedef struct Io_System {
+	Io_Backend backend;
+	b8 running;
+
+	// Queued requests, oldest first
+	Mutex lock;
+	Condvar queued;
+	Io_Request* head;
+	Io_Request* tail;
+
+	Thread threads[PLATFORM_IO_THREAD_COUNT];
+	u32 thread_count;
+} Io_System;
+
+static Io_System io = {0};
+
+//
+// Queue
+//
+
+Io_Request* platform_io_take(void) {
+	mutex_lock(&io.lock);
+	Io_Request* request = io.head;
+	if (request) {
+		io.head = request->next;
+		if (!io.head) {
+			io.tail = null;
+		}
+		request->next = null;
+	}
+	mutex_unlock(&io.lock);
+	return request;
+}
+
+void platform_io_complete(Io_Request* request, i64 result) {
+	// Read before the request is published as done, since the caller may reuse it straight away
+	Io_Callback callback = request->callback;
+	void* data = request->data;
+	Job_Counter* counter = request->counter;
+
+	request->result = result;
+	if (callback) {
+		callback(request, data);
+	}
+	atomic_store_u32(&request->done, 1, MEMORY_ORDER_RELEASE);
+	if (counter) {
+		job_counter_done(counter);
+	}
+}
+
+//
+// Threads
+//
+
+static i32 io_thread_main(void* data) {
+	for (;;) {
+		mutex_lock(&io.lock);
+		while (!io.head && io.running) {
+			condvar_wait(&io.queued, &io.lock);
+		}
+		if (!io.head) {
+			mutex_unlock(&io.lock);
+			return 0;
+		}
+		Io_Request* request = io.head;
+		io.head = request->next;
+		if (!io.head) {
+			io.tail = null;
+		}
+		mutex_unlock(&io.lock);
+
+		request->next = null;
+		platform_io_complete(request, platform_io_read_blocking(request->path, request->buffer, request->offset, request->size));
+	}
+}
+
+static b8 start_threads(void) {
+	for (u32 i = 0; i < PLATFORM_IO_THREAD_COUNT; i++) {
+		char name[THREAD_NAME_MAX];
+		snprintf(name, sizeof(name), "haunt-io-%u", i);
+		if (!thread_create(&io.threads[i], name, 0, io_thread_main, null)) {
+			break;
+		}
+		io.thread_count++;
+	}
+	return io.thread_count > 0;
+}
+
+//
+// Lifecycle
+//
+
+b8 platform_io_start(b8 allow_uring) {
+	io.running = true;
+	io.head = null;
+	io.tail = null;
+
+	if (PLATFORM_IO_URING_ENABLED && allow_uring && platform_io_native_start()) {
+		io.backend = IO_BACKEND_URING;
+		log_info("File I/O through io_uring");
+		return true;
+	}
+
+	if (!start_threads()) {
+		log_error("Failed to start any I/O threads");
+		io.running = false;
+		return false;
+	}
+	io.backend = IO_BACKEND_THREADS;
+	log_info("File I/O through %u threads", io.thread_count);
+	return true;
+}
+
+// Requests still queued are finished before this returns
+void platform_io_shutdown(void) {
+	mutex_lock(&io.lock);
+	io.running = false;
+	condvar_broadcast(&io.queued);
+	mutex_unlock(&io.lock);
+
+	if (io.backend == IO_BACKEND_URING) {
+		platform_io_native_shutdown();
+	}
+	for (u32 i = 0; i < io.thread_count; i++) {
+		thread_join(&io.threads[i]);
+	}
+	io.thread_count = 0;
+	io.backend = IO_BACKEND_NONE;
+}
+
+Io_Backend platform_io_get_backend(void) {
+	return io.backend;
+}
+
+//
+// Reads
+//
+
+void platform_io_read(Io_Request* requests, u32 count) {
+	if (count == 0) {
+		return;
+	}
+
+	for (u32 i = 0; i < count; i++) {
+		Io_Request* request = &requests[i];
+		request->result = 0;
+		request->done = 0;
+		request->next = i + 1 < count ? &requests[i + 1] : null;
+		request->handle = -1;
+		request->completed = 0;
+		if (request->counter) {
+			job_counter_add(request->counter, 1);
+		}
+	}
+
+	if (io.backend == IO_BACKEND_NONE) {
+		// Not started, read on the calling thread
+		for (u32 i = 0; i < count; i++) {
+			requests[i].next = null;
+			platform_io_complete(&requests[i], platform_io_read_blocking(requests[i].path, requests[i].buffer, requests[i].offset, requests[i].size));
+		}
+		return;
+	}
+
+	mutex_lock(&io.lock);
+	if (io.tail) {
+		io.tail->next = &requests[0];
+	} else {
+		io.head = &requests[0];
+	}
+	io.tail = &requests[count - 1];
+	if (count == 1) {
+		condvar_signal(&io.queued);
+	} else {
+		condvar_broadcast(&io.queued);
+	}
+	mutex_unlock(&io.lock);
+
+	if (io.backend == IO_BACKEND_URING) {
+		platform_io_native_wake();
+	}
+}
+
+b8 platform_io_is_done(Io_Request* request) {
+	return atomic_load_u32(&request->done, MEMORY_ORDER_ACQUIRE) != 0;
+}
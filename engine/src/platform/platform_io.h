@@ -0,0 +1,96 @@
+#pragma once
+
+#include "core/export.h"
+#include "core/job.h"
+#include "core/types.h"
+
+/**
+ * Asynchronous file reads.
+ *
+ * Any number of reads can be queued in one call and complete in any order. On Linux they go through io_uring, driven by
+ * a single I/O thread that keeps up to PLATFORM_IO_QUEUE_DEPTH reads in flight so the device queue stays full. Where
+ * io_uring is missing or blocked, as on older kernels or in some sandboxes, and on Windows, a small pool of threads does
+ * blocking reads instead.
+ *
+ * A finished request calls its callback on the I/O thread, then finishes its counter so jobs waiting on it resume.
+ */
+
+// Uses io_uring on Linux when the kernel allows it. Also disabled by setting HAUNT_IO_URING=0 in the environment.
+#define PLATFORM_IO_URING_ENABLED 1
+
+// Reads io_uring keeps in flight at once
+#define PLATFORM_IO_QUEUE_DEPTH 256
+// Threads doing blocking reads when io_uring is not used
+#define PLATFORM_IO_THREAD_COUNT 4
+
+typedef struct Io_Request Io_Request;
+
+// Runs on an I/O thread, so it should only hand the data on
+typedef void (*Io_Callback)(Io_Request* request, void* data);
+
+typedef enum Io_Backend {
+	IO_BACKEND_NONE,
+	IO_BACKEND_URING,
+	IO_BACKEND_THREADS,
+} Io_Backend;
+
+// Must stay at the same address until it completes
+struct Io_Request {
+	// Set by the caller
+	const char* path;
+	void* buffer;
+	u64 offset;
+	u64 size;
+	Io_Callback callback;
+	void* data;
+	// Has job_counter_add called for the request when queued, optional
+	Job_Counter* counter;
+
+	// Bytes read, which is less than size if the file ended first, or a negative error code
+	i64 result;
+	u32 done;
+
+	// Owned by the backend while queued
+	Io_Request* next;
+	i64 handle;
+	u64 completed;
+};
+
+//
+// Lifecycle
+//
+
+b8 platform_io_start(b8 allow_uring);
+
+void platform_io_shutdown(void);
+
+export Io_Backend platform_io_get_backend(void);
+
+//
+// Reads
+//
+
+// Queues the reads and returns straight away
+export void platform_io_read(Io_Request* requests, u32 count);
+
+export b8 platform_io_is_done(Io_Request* request);
+
+//
+// Backends
+//
+
+// io_uring on Linux. Takes queued requests with platform_io_take and finishes them with platform_io_complete.
+b8 platform_io_native_start(void);
+
+void platform_io_native_shutdown(void);
+
+// Tells the native backend that requests were queued
+void platform_io_native_wake(void);
+
+// Opens, reads and closes the file on the calling thread, returning the bytes read or a negative error code
+i64 platform_io_read_blocking(const char* path, void* buffer, u64 offset, u64 size);
+
+// Takes the oldest queued request, or null if there is none
+Io_Request* platform_io_take(void);
+
+void platform_io_complete(Io_Request* request, i64 result);
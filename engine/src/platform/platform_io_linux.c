@@ -0,0 +1,394 @@
+#include "platform/platform_io.h"
+
+#include "core/context.h"
+#include "core/atomic.h"
+#include "core/log.h"
+#include "core/memory.h"
+#include "platform/platform_thread.h"
+
+#ifdef PLATFORM_LINUX
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Completion tag of the eventfd read that wakes the I/O thread when requests are queued. Reads are tagged with their
+// slot plus one.
+#define IO_WAKE_TAG 0
+// Operations the probe can report on, far more than the kernel knows
+#define IO_PROBE_OP_COUNT 256
+
+typedef struct Io_Uring {
+	i32 fd;
+	Thread thread;
+	u32 running;
+
+	// Submission ring, shared with the kernel
+	u8* sq_ring;
+	u64 sq_ring_size;
+	u32* sq_head;
+	u32* sq_tail;
+	u32 sq_mask;
+	u32* sq_array;
+	struct io_uring_sqe* sqes;
+	u64 sqes_size;
+	u32 to_submit;
+
+	// Completion ring, may be the same mapping as the submission ring
+	u8* cq_ring;
+	u64 cq_ring_size;
+	u32* cq_head;
+	u32* cq_tail;
+	u32 cq_mask;
+	struct io_uring_cqe* cqes;
+
+	// Reads in flight by slot, not counting the wake read, so they can still be finished if the ring breaks
+	u32 in_flight;
+	Io_Request* requests[PLATFORM_IO_QUEUE_DEPTH];
+	u32 free_slots[PLATFORM_IO_QUEUE_DEPTH];
+	u32 free_count;
+	i32 wake_fd;
+	u64 wake_value;
+} Io_Uring;
+
+static Io_Uring uring = {0};
+
+//
+// Blocking reads
+//
+
+i64 platform_io_read_blocking(const char* path, void* buffer, u64 offset, u64 size) {
+	i32 fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		return -errno;
+	}
+
+	u64 completed = 0;
+	while (completed < size) {
+		ssize_t result = pread(fd, (u8*)buffer + completed, size - completed, (off_t)(offset + completed));
+		if (result < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			completed = 0;
+			close(fd);
+			return -errno;
+		}
+		if (result == 0) {
+			break;
+		}
+		completed += (u64)result;
+	}
+	close(fd);
+	return (i64)completed;
+}
+
+//
+// Ring
+//
+
+static i32 uring_setup(u32 entries, struct io_uring_params* params) {
+	return (i32)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static i32 uring_enter(u32 to_submit, u32 min_complete, u32 flags) {
+	return (i32)syscall(__NR_io_uring_enter, uring.fd, to_submit, min_complete, flags, null, 0);
+}
+
+static i32 uring_register(u32 opcode, void* arg, u32 arg_count) {
+	return (i32)syscall(__NR_io_uring_register, uring.fd, opcode, arg, arg_count);
+}
+
+// Plain reads only arrived in 5.6, a kernel from 5.1 up sets up a ring but fails every read with EINVAL. The probe came
+// in the same release, so a kernel without it has no reads either.
+static b8 supports_read(void) {
+	u8 buffer[sizeof(struct io_uring_probe) + IO_PROBE_OP_COUNT * sizeof(struct io_uring_probe_op)];
+	memory_zero(buffer, sizeof(buffer));
+	struct io_uring_probe* probe = (struct io_uring_probe*)buffer;
+	if (uring_register(IORING_REGISTER_PROBE, probe, IO_PROBE_OP_COUNT) < 0) {
+		return false;
+	}
+	return probe->last_op >= IORING_OP_READ && (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED) != 0;
+}
+
+static struct io_uring_sqe* get_sqe(void) {
+	u32 tail = *uring.sq_tail;
+	u32 head = atomic_load_u32(uring.sq_head, MEMORY_ORDER_ACQUIRE);
+	if (tail - head > uring.sq_mask) {
+		return null;
+	}
+
+	u32 index = tail & uring.sq_mask;
+	struct io_uring_sqe* sqe = &uring.sqes[index];
+	memory_zero(sqe, sizeof(struct io_uring_sqe));
+	uring.sq_array[index] = index;
+	atomic_store_u32(uring.sq_tail, tail + 1, MEMORY_ORDER_RELEASE);
+	uring.to_submit++;
+	return sqe;
+}
+
+static void queue_wake_read(void) {
+	struct io_uring_sqe* sqe = get_sqe();
+	sqe->opcode = IORING_OP_READ;
+	sqe->fd = uring.wake_fd;
+	sqe->addr = (u64)&uring.wake_value;
+	sqe->len = sizeof(uring.wake_value);
+	sqe->user_data = IO_WAKE_TAG;
+}
+
+// Reads the rest of the slot's request, after any short reads
+static void queue_read(u32 slot) {
+	Io_Request* request = uring.requests[slot];
+	struct io_uring_sqe* sqe = get_sqe();
+	sqe->opcode = IORING_OP_READ;
+	sqe->fd = (i32)request->handle;
+	sqe->addr = (u64)((u8*)request->buffer + request->completed);
+	sqe->len = (u32)(request->size - request->completed);
+	sqe->off = request->offset + request->completed;
+	sqe->user_data = (u64)slot + 1;
+}
+
+static void finish(Io_Request* request, i64 result) {
+	if (request->handle >= 0) {
+		close((i32)request->handle);
+		request->handle = -1;
+	}
+	platform_io_complete(request, result);
+}
+
+// Moves queued requests into the ring while there is room, keeping one entry for the wake read
+static void fill_ring(void) {
+	while (uring.in_flight + 1 < PLATFORM_IO_QUEUE_DEPTH) {
+		Io_Request* request = platform_io_take();
+		if (!request) {
+			return;
+		}
+
+		// Opening is cheap next to the read, and io_uring can only chain an open into a read with direct descriptors
+		i32 fd = open(request->path, O_RDONLY | O_CLOEXEC);
+		if (fd < 0) {
+			platform_io_complete(request, -errno);
+			continue;
+		}
+		request->handle = fd;
+		if (request->size == 0) {
+			finish(request, 0);
+			continue;
+		}
+
+		u32 slot = uring.free_slots[--uring.free_count];
+		uring.requests[slot] = request;
+		uring.in_flight++;
+		queue_read(slot);
+	}
+}
+
+static void finish_slot(u32 slot, i64 result) {
+	Io_Request* request = uring.requests[slot];
+	uring.requests[slot] = null;
+	uring.free_slots[uring.free_count++] = slot;
+	uring.in_flight--;
+	finish(request, result);
+}
+
+static void reap_completions(void) {
+	u32 head = *uring.cq_head;
+	u32 tail = atomic_load_u32(uring.cq_tail, MEMORY_ORDER_ACQUIRE);
+	while (head != tail) {
+		struct io_uring_cqe* cqe = &uring.cqes[head & uring.cq_mask];
+		u64 tag = cqe->user_data;
+		i32 result = cqe->res;
+		head++;
+
+		if (tag == IO_WAKE_TAG) {
+			if (atomic_load_u32(&uring.running, MEMORY_ORDER_ACQUIRE)) {
+				queue_wake_read();
+			}
+			continue;
+		}
+
+		u32 slot = (u32)(tag - 1);
+		Io_Request* request = uring.requests[slot];
+		if (result < 0) {
+			finish_slot(slot, result);
+		} else {
+			request->completed += (u64)result;
+			if (result > 0 && request->completed < request->size) {
+				queue_read(slot);
+			} else {
+				finish_slot(slot, (i64)request->completed);
+			}
+		}
+	}
+	atomic_store_u32(uring.cq_head, head, MEMORY_ORDER_RELEASE);
+}
+
+// Unmapping and closing the ring cancels whatever the kernel still holds of it
+static void release_ring(void) {
+	if (uring.sqes && uring.sqes != MAP_FAILED) {
+		munmap(uring.sqes, uring.sqes_size);
+	}
+	if (uring.cq_ring && uring.cq_ring != MAP_FAILED && uring.cq_ring != uring.sq_ring) {
+		munmap(uring.cq_ring, uring.cq_ring_size);
+	}
+	if (uring.sq_ring && uring.sq_ring != MAP_FAILED) {
+		munmap(uring.sq_ring, uring.sq_ring_size);
+	}
+	if (uring.fd >= 0) {
+		close(uring.fd);
+	}
+	uring.sqes = null;
+	uring.cq_ring = null;
+	uring.sq_ring = null;
+	uring.fd = -1;
+}
+
+// The ring is gone, so no read left in it will ever be reaped
+static void fail_in_flight(i64 error) {
+	for (u32 slot = 0; slot < PLATFORM_IO_QUEUE_DEPTH; slot++) {
+		if (uring.requests[slot]) {
+			finish_slot(slot, error);
+		}
+	}
+}
+
+static i32 uring_thread_main(void* data) {
+	queue_wake_read();
+	for (;;) {
+		b8 running = atomic_load_u32(&uring.running, MEMORY_ORDER_ACQUIRE) != 0;
+		if (!running && uring.in_flight == 0) {
+			break;
+		}
+		if (running) {
+			fill_ring();
+		}
+
+		// Submits everything queued and sleeps until at least one completion
+		i32 result = uring_enter(uring.to_submit, 1, IORING_ENTER_GETEVENTS);
+		if (result < 0) {
+			i32 error = errno;
+			if (error != EINTR && error != EAGAIN && error != EBUSY) {
+				log_error("io_uring_enter failed, falling back to blocking reads: %s", strerror(error));
+				release_ring();
+				fail_in_flight(-error);
+				break;
+			}
+		} else {
+			uring.to_submit -= (u32)result;
+		}
+		reap_completions();
+	}
+
+	// Whatever is still queued is read the slow way so every request completes. If the ring broke while running, later
+	// requests are read the same way as the wake eventfd announces them.
+	for (;;) {
+		b8 running = atomic_load_u32(&uring.running, MEMORY_ORDER_ACQUIRE) != 0;
+		Io_Request* request;
+		while ((request = platform_io_take())) {
+			platform_io_complete(request, platform_io_read_blocking(request->path, request->buffer, request->offset, request->size));
+		}
+		if (!running) {
+			break;
+		}
+		u64 value;
+		if (read(uring.wake_fd, &value, sizeof(value)) < 0 && errno != EINTR) {
+			log_error("Failed to wait for I/O requests: %s", strerror(errno));
+			break;
+		}
+	}
+	return 0;
+}
+
+//
+// Lifecycle
+//
+
+b8 platform_io_native_start(void) {
+	struct io_uring_params params;
+	memory_zero(&params, sizeof(params));
+	uring.fd = uring_setup(PLATFORM_IO_QUEUE_DEPTH, &params);
+	if (uring.fd < 0) {
+		log_info("io_uring is unavailable: %s", strerror(errno));
+		return false;
+	}
+	if (!supports_read()) {
+		log_info("io_uring is unavailable: the kernel has no plain reads");
+		platform_io_native_shutdown();
+		return false;
+	}
+
+	uring.sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(u32);
+	uring.cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	b8 single_mapping = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (single_mapping && uring.cq_ring_size > uring.sq_ring_size) {
+		uring.sq_ring_size = uring.cq_ring_size;
+	}
+
+	uring.sq_ring = mmap(null, uring.sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring.fd, IORING_OFF_SQ_RING);
+	uring.cq_ring = single_mapping ? uring.sq_ring :
+		mmap(null, uring.cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring.fd, IORING_OFF_CQ_RING);
+	uring.sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+	uring.sqes = mmap(null, uring.sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring.fd, IORING_OFF_SQES);
+	if (uring.sq_ring == MAP_FAILED || uring.cq_ring == MAP_FAILED || uring.sqes == MAP_FAILED) {
+		log_error("Failed to map the io_uring rings: %s", strerror(errno));
+		platform_io_native_shutdown();
+		return false;
+	}
+
+	uring.sq_head = (u32*)(uring.sq_ring + params.sq_off.head);
+	uring.sq_tail = (u32*)(uring.sq_ring + params.sq_off.tail);
+	uring.sq_mask = *(u32*)(uring.sq_ring + params.sq_off.ring_mask);
+	uring.sq_array = (u32*)(uring.sq_ring + params.sq_off.array);
+	uring.cq_head = (u32*)(uring.cq_ring + params.cq_off.head);
+	uring.cq_tail = (u32*)(uring.cq_ring + params.cq_off.tail);
+	uring.cq_mask = *(u32*)(uring.cq_ring + params.cq_off.ring_mask);
+	uring.cqes = (struct io_uring_cqe*)(uring.cq_ring + params.cq_off.cqes);
+
+	for (u32 i = 0; i < PLATFORM_IO_QUEUE_DEPTH; i++) {
+		uring.free_slots[i] = PLATFORM_IO_QUEUE_DEPTH - 1 - i;
+	}
+	uring.free_count = PLATFORM_IO_QUEUE_DEPTH;
+
+	uring.wake_fd = eventfd(0, EFD_CLOEXEC);
+	if (uring.wake_fd < 0) {
+		log_error("Failed to create the io_uring wake eventfd: %s", strerror(errno));
+		platform_io_native_shutdown();
+		return false;
+	}
+
+	atomic_store_u32(&uring.running, 1, MEMORY_ORDER_RELEASE);
+	if (!thread_create(&uring.thread, "haunt-io", 0, uring_thread_main, null)) {
+		atomic_store_u32(&uring.running, 0, MEMORY_ORDER_RELEASE);
+		platform_io_native_shutdown();
+		return false;
+	}
+	return true;
+}
+
+void platform_io_native_shutdown(void) {
+	if (atomic_load_u32(&uring.running, MEMORY_ORDER_ACQUIRE)) {
+		atomic_store_u32(&uring.running, 0, MEMORY_ORDER_RELEASE);
+		platform_io_native_wake();
+		thread_join(&uring.thread);
+	}
+
+	if (uring.wake_fd > 0) {
+		close(uring.wake_fd);
+	}
+	release_ring();
+	memory_zero(&uring, sizeof(uring));
+	uring.fd = -1;
+}
+
+void platform_io_native_wake(void) {
+	u64 value = 1;
+	ssize_t result = write(uring.wake_fd, &value, sizeof(value));
+	(void)result;
+}
+
+#endif // PLATFORM_LINUX
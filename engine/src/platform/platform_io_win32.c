@@ -0,0 +1,58 @@
+#include "platform/platform_io.h"
+
+#include "core/context.h"
+
+#ifdef PLATFORM_WINDOWS
+
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+
+//
+// Blocking reads
+//
+
+i64 platform_io_read_blocking(const char* path, void* buffer, u64 offset, u64 size) {
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, null, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, null);
+	if (file == INVALID_HANDLE_VALUE) {
+		return -(i64)GetLastError();
+	}
+
+	u64 completed = 0;
+	while (completed < size) {
+		// ReadFile takes a 32 bit size, and the offset through the OVERLAPPED even for synchronous handles
+		u64 remaining = size - completed;
+		DWORD chunk = remaining > 0x40000000ull ? 0x40000000u : (DWORD)remaining;
+		OVERLAPPED overlapped = {0};
+		overlapped.Offset = (DWORD)(offset + completed);
+		overlapped.OffsetHigh = (DWORD)((offset + completed) >> 32);
+		DWORD read = 0;
+		if (!ReadFile(file, (u8*)buffer + completed, chunk, &read, &overlapped)) {
+			DWORD error = GetLastError();
+			CloseHandle(file);
+			return error == ERROR_HANDLE_EOF ? (i64)completed : -(i64)error;
+		}
+		if (read == 0) {
+			break;
+		}
+		completed += read;
+	}
+	CloseHandle(file);
+	return (i64)completed;
+}
+
+//
+// Native backend
+//
+
+// Windows always uses the thread pool for now
+b8 platform_io_native_start(void) {
+	return false;
+}
+
+void platform_io_native_shutdown(void) {
+}
+
+void platform_io_native_wake(void) {
+}
+
+#endif // PLATFORM_WINDOWS
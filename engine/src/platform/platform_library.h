@@ -0,0 +1,19 @@
+#pragma once
+
+#include "core/export.h"
+#include "core/types.h"
+
+/**
+ * Shared libraries loaded at runtime, through dlopen on Linux and LoadLibrary on Windows.
+ */
+
+typedef struct Library {
+	void* handle;
+} Library;
+
+export b8 platform_library_load(const char* path, Library* out_library);
+
+export void platform_library_unload(Library* library);
+
+// Null if the library doesn't export the symbol
+export void* platform_library_symbol(Library* library, const char* name);
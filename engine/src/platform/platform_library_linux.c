@@ -0,0 +1,31 @@
+#include "platform/platform_library.h"
+
+#include "core/context.h"
+#include "core/log.h"
+
+#ifdef PLATFORM_LINUX
+
+#include <dlfcn.h>
+
+b8 platform_library_load(const char* path, Library* out_library) {
+	// Local so a reloaded copy never resolves against the copy it replaces
+	out_library->handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+	if (!out_library->handle) {
+		log_error("Failed to load %s: %s", path, dlerror());
+		return false;
+	}
+	return true;
+}
+
+void platform_library_unload(Library* library) {
+	if (library->handle) {
+		dlclose(library->handle);
+	}
+	library->handle = null;
+}
+
+void* platform_library_symbol(Library* library, const char* name) {
+	return library->handle ? dlsym(library->handle, name) : null;
+}
+
+#endif // PLATFORM_LINUX
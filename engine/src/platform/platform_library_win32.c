@@ -0,0 +1,31 @@
+#include "platform/platform_library.h"
+
+#include "core/context.h"
+#include "core/log.h"
+
+#ifdef PLATFORM_WINDOWS
+
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+
+b8 platform_library_load(const char* path, Library* out_library) {
+	out_library->handle = LoadLibraryA(path);
+	if (!out_library->handle) {
+		log_error("Failed to load %s: %lu", path, GetLastError());
+		return false;
+	}
+	return true;
+}
+
+void platform_library_unload(Library* library) {
+	if (library->handle) {
+		FreeLibrary((HMODULE)library->handle);
+	}
+	library->handle = null;
+}
+
+void* platform_library_symbol(Library* library, const char* name) {
+	return library->handle ? (void*)GetProcAddress((HMODULE)library->handle, name) : null;
+}
+
+#endif // PLATFORM_WINDOWS
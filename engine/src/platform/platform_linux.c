@@ -1,4 +1,6 @@
 #include "platform/platform.h"
+#include "platform/platform_headless.h"
+#include "platform/platform_offscreen.h"
 
 #include "core/context.h"
 #include "core/log.h"
@@ -13,29 +15,122 @@
 
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
+#include <X11/Xatom.h>
 #include <X11/keysym.h>
 #include <X11/XKBlib.h>
-#include <sys/time.h>
+#include <X11/extensions/XInput2.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <errno.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <unistd.h>
 #include <GL/glx.h>
 
+#if PLATFORM_XCB_ENABLED
+#	include <X11/Xlib-xcb.h>
+#	include <xcb/xcb.h>
+#endif
+
+typedef enum X11_Atom {
+	X11_ATOM_WM_PROTOCOLS,
+	X11_ATOM_WM_DELETE_WINDOW,
+	X11_ATOM_NET_WM_STATE,
+	X11_ATOM_NET_WM_STATE_HIDDEN,
+	X11_ATOM_COUNT,
+} X11_Atom;
+
+static const char* atom_names[X11_ATOM_COUNT] = {
+	"WM_PROTOCOLS",         // X11_ATOM_WM_PROTOCOLS
+	"WM_DELETE_WINDOW",     // X11_ATOM_WM_DELETE_WINDOW
+	"_NET_WM_STATE",        // X11_ATOM_NET_WM_STATE
+	"_NET_WM_STATE_HIDDEN", // X11_ATOM_NET_WM_STATE_HIDDEN
+};
+
 typedef struct Clock {
 	f64 frequency;
-	struct timeval start;
+	u64 start;
 } Clock;
 
+// Must be a power of two
+#define INPUT_QUEUE_CAPACITY 4096
+
+// Single producer, single consumer ring of input events from the input thread to the main thread
+typedef struct Input_Queue {
+	Input_Event events[INPUT_QUEUE_CAPACITY];
+	// Written by the input thread
+	_Alignas(64) atomic_uint head;
+	atomic_uint dropped;
+	// Latest pointer state, published for platform_latch_input
+	atomic_bool has_position;
+	atomic_ullong latest_position;
+	atomic_llong raw_total_x;
+	atomic_llong raw_total_y;
+	// Written by the main thread
+	_Alignas(64) atomic_uint tail;
+} Input_Queue;
+
+// Input reading state, owned by whichever thread reads input events
+typedef struct X11_Input {
+	Display* display;
+#if PLATFORM_XCB_ENABLED
+	xcb_connection_t* connection;
+#endif
+	// Offset from X server time to platform_get_time_ns
+	i64 server_time_offset;
+	Time last_server_time;
+	b8 server_time_synced;
+	// XInput2 raw motion, accumulated across a read and delivered once
+	b8 raw_motion_enabled;
+	b8 focused;
+	i32 xi_opcode;
+	f64 raw_x;
+	f64 raw_y;
+	Time raw_time;
+	b8 raw_pending;
+	// Null when events go straight to the input system
+	Input_Queue* queue;
+} X11_Input;
+
+typedef struct Input_Thread {
+	pthread_t thread;
+	b8 running;
+	int wake_fd;
+	atomic_bool quit;
+	Input_Queue* queue;
+	// Raw motion delivered to the input system so far, to find what arrived after the pump
+	i64 consumed_raw_x;
+	i64 consumed_raw_y;
+} Input_Thread;
+
 typedef struct Platform_Internal {
 	Display* display;
+#if PLATFORM_XCB_ENABLED
+	// The same connection as the display. XCB owns its event queue, Xlib still sends requests and runs GLX.
+	xcb_connection_t* connection;
+	xcb_intern_atom_cookie_t atom_cookies[X11_ATOM_COUNT];
+#endif
 	Window window;
 	XVisualInfo* visual_info;
 	Colormap color_map;
 	XSetWindowAttributes window_attributes;
-	Atom wm_delete_window;
+	Atom atoms[X11_ATOM_COUNT];
+	// Window state from the main connection's events, whichever thread reads input
+	b8 focused;
+	b8 mapped;
+	// Fully covered by other windows
+	b8 obscured;
+	// Minimized by a window manager that keeps minimized windows mapped
+	b8 hidden;
 	Clock clock;
 	GLXContext gl_context;
+	X11_Input input;
+	b8 input_thread_enabled;
+	Input_Thread input_thread;
 } Platform_Internal;
 
 static const char* console_colors[PLATFORM_CONSOLE_COLOR_COUNT] = {
@@ -47,14 +142,98 @@ static const char* console_colors[PLATFORM_CONSOLE_COLOR_COUNT] = {
 	"\033[93m",    // PLATFORM_CONSOLE_COLOR_YELLOW
 };
 
+#define INPUT_EVENT_MASK \
+	(KeyPressMask | KeyReleaseMask | ButtonPressMask | ButtonReleaseMask | PointerMotionMask | FocusChangeMask)
+
+static b8 input_thread_start(Platform_Internal* internal, Window root);
+static void input_thread_stop(Platform_Internal* internal);
+
+// Raw motion comes from XInput2 2.0 or later. Without it the engine only gets the core, accelerated pointer position.
+static b8 enable_raw_motion(X11_Input* input, Window root) {
+	int event;
+	int error;
+	if (!XQueryExtension(input->display, "XInputExtension", &input->xi_opcode, &event, &error)) {
+		log_warn("XInput extension not available, raw mouse motion disabled");
+		return false;
+	}
+
+	int major = 2;
+	int minor = 0;
+	if (XIQueryVersion(input->display, &major, &minor) != Success) {
+		log_warn("XInput2 not available, raw mouse motion disabled");
+		return false;
+	}
+
+	// Raw events are only delivered to the root window
+	unsigned char mask_bits[XIMaskLen(XI_RawMotion)] = {0};
+	XIEventMask mask;
+	mask.deviceid = XIAllMasterDevices;
+	mask.mask_len = sizeof(mask_bits);
+	mask.mask = mask_bits;
+	XISetMask(mask_bits, XI_RawMotion);
+	if (XISelectEvents(input->display, root, &mask, 1) != Success) {
+		log_warn("Failed to select XInput2 raw motion events");
+		return false;
+	}
+
+	log_info("XInput2 %d.%d raw mouse motion enabled", major, minor);
+	return true;
+}
+
 static Platform_Internal* create_internal(void) {
 	Platform_Internal* internal = memory_alloc(sizeof(Platform_Internal), MEMORY_TAG_PLATFORM);
 	memory_zero(internal, sizeof(Platform_Internal));
 	return internal;
 }
 
+#if PLATFORM_XCB_ENABLED
+// Hands the display's event queue to XCB. Has to happen before anything reads events from it.
+static xcb_connection_t* take_event_queue(Display* display) {
+	XSetEventQueueOwner(display, XCBOwnsEventQueue);
+	return XGetXCBConnection(display);
+}
+#endif
+
+// With XCB the intern requests go out now and finish_interning_atoms collects the replies, so the round trip overlaps
+// the rest of startup. Xlib interns them all in one round trip when finishing.
+static void begin_interning_atoms(Platform_Internal* internal) {
+#if PLATFORM_XCB_ENABLED
+	for (u32 i = 0; i < X11_ATOM_COUNT; i++) {
+		internal->atom_cookies[i] = xcb_intern_atom(internal->connection, 0, (u16)strlen(atom_names[i]), atom_names[i]);
+	}
+	xcb_flush(internal->connection);
+#endif
+}
+
+static b8 finish_interning_atoms(Platform_Internal* internal) {
+#if PLATFORM_XCB_ENABLED
+	// Every reply is collected, even after a failure, so none are left on the connection
+	b8 success = true;
+	for (u32 i = 0; i < X11_ATOM_COUNT; i++) {
+		xcb_intern_atom_reply_t* reply = xcb_intern_atom_reply(internal->connection, internal->atom_cookies[i], null);
+		if (!reply) {
+			success = false;
+			continue;
+		}
+		internal->atoms[i] = reply->atom;
+		free(reply);
+	}
+	return success;
+#else
+	return XInternAtoms(internal->display, (char**)atom_names, X11_ATOM_COUNT, False, internal->atoms) != 0;
+#endif
+}
+
 b8 platform_start(Platform* platform, const char* app_name, i32 x, i32 y, i32 width, i32 height) {
+	if (platform->backend == PLATFORM_BACKEND_HEADLESS) {
+		return platform_headless_start(platform, app_name);
+	}
+	if (platform->backend == PLATFORM_BACKEND_OFFSCREEN) {
+		return platform_offscreen_start(platform, app_name, width, height);
+	}
+
 	log_info("Platform start...");
+	platform_calibrate_cycles();
 	platform->internal = create_internal();
 	Platform_Internal* internal = (Platform_Internal*)platform->internal;
 
@@ -67,6 +246,12 @@ b8 platform_start(Platform* platform, const char* app_name, i32 x, i32 y, i32 wi
 	}
 	log_info("X display opened successfully");
 
+#if PLATFORM_XCB_ENABLED
+	internal->connection = take_event_queue(internal->display);
+	log_info("Reading X events through XCB");
+#endif
+	begin_interning_atoms(internal);
+
 	// Get default screen
 	int screen = DefaultScreen(internal->display);
 	Window root = RootWindow(internal->display, screen);
@@ -98,12 +283,15 @@ b8 platform_start(Platform* platform, const char* app_name, i32 x, i32 y, i32 wi
 		AllocNone
 	);
 
-	// Set window attributes
+	// Set window attributes. With an input thread, input is selected on the thread's own connection instead, since
+	// only one client may select button presses on a window.
+	internal->input_thread_enabled = PLATFORM_INPUT_THREAD_ENABLED;
 	internal->window_attributes.colormap = internal->color_map;
-	internal->window_attributes.event_mask = 
-		ExposureMask | KeyPressMask | KeyReleaseMask |
-		ButtonPressMask | ButtonReleaseMask |
-		PointerMotionMask | StructureNotifyMask;
+	internal->window_attributes.event_mask =
+		ExposureMask | StructureNotifyMask | FocusChangeMask | VisibilityChangeMask | PropertyChangeMask;
+	if (!internal->input_thread_enabled) {
+		internal->window_attributes.event_mask |= INPUT_EVENT_MASK;
+	}
 
 	// Create window
 	internal->window = XCreateWindow(
@@ -127,13 +315,49 @@ b8 platform_start(Platform* platform, const char* app_name, i32 x, i32 y, i32 wi
 	// Set window title
 	XStoreName(internal->display, internal->window, app_name);
 
+	// Focus events only report changes, so start from the current focus. PointerRoot hands the keyboard to whatever
+	// window the pointer is in, which is treated as focused until an event says otherwise. The input side keeps its own
+	// copy to gate raw motion, so it is seeded before the input thread can read it. The window isn't mapped yet, so any
+	// focus it gets later still arrives as an event on both connections.
+	Window focus;
+	int revert;
+	XGetInputFocus(internal->display, &focus, &revert);
+	internal->focused = focus == internal->window || focus == PointerRoot;
+	internal->input.focused = internal->focused;
+
+	if (internal->input_thread_enabled) {
+		if (!input_thread_start(internal, root)) {
+			log_fatal("Failed to start input thread");
+			return false;
+		}
+	} else {
+		internal->input.display = internal->display;
+#if PLATFORM_XCB_ENABLED
+		internal->input.connection = internal->connection;
+#endif
+		internal->input.raw_motion_enabled = enable_raw_motion(&internal->input, root);
+	}
+
 	// Handle window close
-	internal->wm_delete_window = XInternAtom(internal->display, "WM_DELETE_WINDOW", False);
-	XSetWMProtocols(internal->display, internal->window, &internal->wm_delete_window, 1);
+	if (!finish_interning_atoms(internal)) {
+		log_fatal("Failed to intern X atoms");
+		return false;
+	}
+	XChangeProperty(
+		internal->display,
+		internal->window,
+		internal->atoms[X11_ATOM_WM_PROTOCOLS],
+		XA_ATOM,
+		32,
+		PropModeReplace,
+		(unsigned char*)&internal->atoms[X11_ATOM_WM_DELETE_WINDOW],
+		1
+	);
 
 	// Show window
 	XMapWindow(internal->display, internal->window);
 	XFlush(internal->display);
+	internal->mapped = true;
 
 	// After window creation, create OpenGL context
 	log_info("Creating OpenGL context...");
@@ -160,8 +384,21 @@ b8 platform_start(Platform* platform, const char* app_name, i32 x, i32 y, i32 wi
 }
 
 void platform_shutdown(Platform* platform) {
+	if (platform->backend == PLATFORM_BACKEND_HEADLESS) {
+		platform_headless_shutdown(platform);
+		return;
+	}
+	if (platform->backend == PLATFORM_BACKEND_OFFSCREEN) {
+		platform_offscreen_shutdown(platform);
+		return;
+	}
+
 	Platform_Internal* internal = (Platform_Internal*)platform->internal;
 
+	if (internal->input_thread_enabled) {
+		input_thread_stop(internal);
+	}
+
 	if (internal->display) {
 		if (internal->gl_context) {
 			glXMakeCurrent(internal->display, None, NULL);
@@ -257,85 +494,686 @@ static Mouse_Button x11_button_to_mouse_button(unsigned int button) {
 	}
 }
 
+// X server timestamps are milliseconds on the server's clock. Keep the smallest offset seen to the monotonic clock, which
+// is the one least inflated by delivery delay, and resync whenever the 32 bit server time wraps.
+static u64 x11_time_to_ns(X11_Input* input, Time time) {
+	u64 now = platform_get_time_ns();
+	i64 server_ns = (i64)time * 1000000;
+	i64 offset = (i64)now - server_ns;
+	if (!input->server_time_synced || time < input->last_server_time || offset < input->server_time_offset) {
+		input->server_time_offset = offset;
+		input->server_time_synced = true;
+	}
+	input->last_server_time = time;
+	return (u64)(server_ns + input->server_time_offset);
+}
+
+static void deliver_input(const Input_Event* event) {
+	switch (event->type) {
+		case INPUT_EVENT_TYPE_KEY:
+			input_process_key((Key)event->code, event->pressed, event->time);
+			break;
+		case INPUT_EVENT_TYPE_MOUSE_BUTTON:
+			input_process_mouse_button((Mouse_Button)event->code, event->pressed, event->time);
+			break;
+		case INPUT_EVENT_TYPE_MOUSE_WHEEL:
+			input_process_mouse_wheel(event->y, event->time);
+			break;
+		case INPUT_EVENT_TYPE_MOUSE_MOVE:
+			input_process_mouse_position(event->x, event->y, event->time);
+			break;
+		case INPUT_EVENT_TYPE_MOUSE_DELTA:
+			input_process_mouse_delta(event->x, event->y, event->time);
+			break;
+	}
+}
+
+static void emit_input(X11_Input* input, Input_Event_Type type, i32 code, i32 x, i32 y, b8 pressed, u64 time) {
+	Input_Event event = {time, type, code, x, y, pressed};
+	Input_Queue* queue = input->queue;
+	if (!queue) {
+		deliver_input(&event);
+		return;
+	}
+
+	// The position is absolute, so the latest one is right even when its event doesn't fit in the queue
+	if (type == INPUT_EVENT_TYPE_MOUSE_MOVE) {
+		atomic_store_explicit(&queue->latest_position, ((u64)(u32)x << 32) | (u32)y, memory_order_relaxed);
+		atomic_store_explicit(&queue->has_position, true, memory_order_release);
+	}
+
+	u32 head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+	u32 tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+	if (head - tail >= INPUT_QUEUE_CAPACITY) {
+		atomic_fetch_add_explicit(&queue->dropped, 1, memory_order_relaxed);
+		return;
+	}
+
+	// Raw totals only count motion the main thread will drain, or the latched remainder would never be consumed
+	if (type == INPUT_EVENT_TYPE_MOUSE_DELTA) {
+		atomic_fetch_add_explicit(&queue->raw_total_x, x, memory_order_relaxed);
+		atomic_fetch_add_explicit(&queue->raw_total_y, y, memory_order_relaxed);
+	}
+
+	queue->events[head & (INPUT_QUEUE_CAPACITY - 1)] = event;
+	atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+}
+
+// Sums raw motion into the read's accumulator. High rate mice send many raw events per frame, so the input system only
+// sees the total once the queue is drained.
+static void add_raw_motion(X11_Input* input, f64 x, f64 y, Time time) {
+	if (!input->focused) {
+		return;
+	}
+	input->raw_x += x;
+	input->raw_y += y;
+	input->raw_time = time;
+	input->raw_pending = true;
+}
+
+static void accumulate_raw_motion(X11_Input* input, XGenericEventCookie* cookie) {
+	if (!XGetEventData(input->display, cookie)) {
+		return;
+	}
+
+	// raw_values holds only the valuators set in the mask, in order
+	XIRawEvent* raw = (XIRawEvent*)cookie->data;
+	const double* value = raw->raw_values;
+	f64 x = 0.0;
+	f64 y = 0.0;
+	if (raw->valuators.mask_len > 0) {
+		if (XIMaskIsSet(raw->valuators.mask, 0)) {
+			x = *value++;
+		}
+		if (XIMaskIsSet(raw->valuators.mask, 1)) {
+			y = *value++;
+		}
+	}
+	add_raw_motion(input, x, y, raw->time);
+
+	XFreeEventData(input->display, cookie);
+}
+
+static void flush_raw_motion(X11_Input* input) {
+	if (!input->raw_pending) {
+		return;
+	}
+
+	// Deliver whole units and carry the fraction into the next read so slow motion is not lost
+	i32 x = (i32)input->raw_x;
+	i32 y = (i32)input->raw_y;
+	input->raw_x -= x;
+	input->raw_y -= y;
+	input->raw_pending = false;
+	if (x | y) {
+		emit_input(input, INPUT_EVENT_TYPE_MOUSE_DELTA, 0, x, y, false, x11_time_to_ns(input, input->raw_time));
+	}
+}
+
+static void set_focused(X11_Input* input, b8 focused) {
+	input->focused = focused;
+	if (!focused) {
+		input->raw_x = 0;
+		input->raw_y = 0;
+		input->raw_pending = false;
+	}
+}
+
+static void process_key(X11_Input* input, KeySym keysym, b8 pressed, Time time) {
+	// Only handle valid keys
+	Key key = x11_keycode_to_key(keysym);
+	if (key != KEY_COUNT) {
+		emit_input(input, INPUT_EVENT_TYPE_KEY, key, 0, 0, pressed, x11_time_to_ns(input, time));
+	}
+}
+
+static void process_button(X11_Input* input, u32 x11_button, b8 pressed, Time server_time) {
+	u64 time = x11_time_to_ns(input, server_time);
+
+	// Handle mouse wheel, which X11 reports as a press and release of buttons 4 and 5
+	if (x11_button == Button4 || x11_button == Button5) {
+		if (pressed) {
+			emit_input(input, INPUT_EVENT_TYPE_MOUSE_WHEEL, 0, 0, x11_button == Button4 ? 1 : -1, false, time);
+		}
+		return;
+	}
+
+	// Handle mouse buttons
+	Mouse_Button button = x11_button_to_mouse_button(x11_button);
+	if (button != MOUSE_BUTTON_COUNT) {
+		emit_input(input, INPUT_EVENT_TYPE_MOUSE_BUTTON, button, 0, 0, pressed, time);
+	}
+}
+
+// Translates input events, returns false for anything that is not input
+static b8 process_input_event(X11_Input* input, XEvent* event) {
+	switch (event->type) {
+		case GenericEvent: {
+			if (input->raw_motion_enabled
+					&& event->xcookie.extension == input->xi_opcode
+					&& event->xcookie.evtype == XI_RawMotion) {
+				accumulate_raw_motion(input, &event->xcookie);
+				return true;
+			}
+		} return false;
+
+		case FocusIn:
+		case FocusOut:
+			// Focus moving to or from a child window leaves the window itself focused
+			if (event->xfocus.detail != NotifyInferior) {
+				set_focused(input, event->type == FocusIn);
+			}
+			return true;
+
+		case KeyPress:
+		case KeyRelease:
+			process_key(input, XLookupKeysym(&event->xkey, 0), event->type == KeyPress, event->xkey.time);
+			return true;
+
+		case ButtonPress:
+		case ButtonRelease:
+			process_button(input, event->xbutton.button, event->type == ButtonPress, event->xbutton.time);
+			return true;
+
+		case MotionNotify: {
+			// Handle mouse movement
+			u64 time = x11_time_to_ns(input, event->xmotion.time);
+			emit_input(input, INPUT_EVENT_TYPE_MOUSE_MOVE, 0, event->xmotion.x, event->xmotion.y, false, time);
+		} return true;
+	}
+
+	return false;
+}
+
+#if PLATFORM_XCB_ENABLED
+
+// An XInput2 raw event as XCB hands it over, which is the wire format with the full sequence number inserted after the
+// first 32 bytes. The valuator mask follows, then the processed value of each set valuator, then each one's raw value.
+typedef struct Xcb_Raw_Event {
+	u8 response_type;
+	u8 extension;
+	u16 sequence;
+	u32 length;
+	u16 event_type;
+	u16 device_id;
+	u32 time;
+	u32 detail;
+	u16 source_id;
+	u16 valuators_len;
+	u32 flags;
+	u32 pad;
+	u32 full_sequence;
+} Xcb_Raw_Event;
+
+static_assert(sizeof(Xcb_Raw_Event) == sizeof(xcb_ge_generic_event_t), "Expected the raw event header to match XCB's");
+
+// 32.32 fixed point
+typedef struct Xcb_Fixed {
+	i32 integral;
+	u32 fraction;
+} Xcb_Fixed;
+
+static f64 fixed_to_f64(Xcb_Fixed value) {
+	return (f64)value.integral + (f64)value.fraction / 4294967296.0;
+}
+
+static void accumulate_xcb_raw_motion(X11_Input* input, const xcb_generic_event_t* event) {
+	const Xcb_Raw_Event* raw = (const Xcb_Raw_Event*)event;
+	const u8* mask = (const u8*)(raw + 1);
+	u32 mask_size = (u32)raw->valuators_len * 4;
+	u32 set_count = 0;
+	for (u32 i = 0; i < mask_size; i++) {
+		set_count += (u32)__builtin_popcount(mask[i]);
+	}
+	if ((u64)mask_size + (u64)set_count * 2 * sizeof(Xcb_Fixed) > (u64)raw->length * 4) {
+		return;
+	}
+
+	// The raw values come after all the processed ones. Valuators 0 and 1 are x and y, so they come first when set.
+	const Xcb_Fixed* value = (const Xcb_Fixed*)(mask + mask_size) + set_count;
+	f64 x = 0.0;
+	f64 y = 0.0;
+	if (mask_size > 0) {
+		if (mask[0] & 1) {
+			x = fixed_to_f64(*value++);
+		}
+		if (mask[0] & 2) {
+			y = fixed_to_f64(*value++);
+		}
+	}
+	add_raw_motion(input, x, y, raw->time);
+}
+
+// Translates input events, returns false for anything that is not input
+static b8 process_xcb_input_event(X11_Input* input, const xcb_generic_event_t* event) {
+	switch (event->response_type & ~0x80) {
+		case XCB_GE_GENERIC: {
+			const xcb_ge_generic_event_t* generic = (const xcb_ge_generic_event_t*)event;
+			if (input->raw_motion_enabled
+					&& generic->extension == input->xi_opcode
+					&& generic->event_type == XI_RawMotion) {
+				accumulate_xcb_raw_motion(input, event);
+				return true;
+			}
+		} return false;
+
+		case XCB_FOCUS_IN:
+		case XCB_FOCUS_OUT:
+			// Focus moving to or from a child window leaves the window itself focused
+			if (((const xcb_focus_in_event_t*)event)->detail != NotifyInferior) {
+				set_focused(input, (event->response_type & ~0x80) == XCB_FOCUS_IN);
+			}
+			return true;
+
+		case XCB_KEY_PRESS:
+		case XCB_KEY_RELEASE: {
+			const xcb_key_press_event_t* key = (const xcb_key_press_event_t*)event;
+			KeySym keysym = XkbKeycodeToKeysym(input->display, key->detail, 0, 0);
+			process_key(input, keysym, (key->response_type & ~0x80) == XCB_KEY_PRESS, key->time);
+		} return true;
+
+		case XCB_BUTTON_PRESS:
+		case XCB_BUTTON_RELEASE: {
+			const xcb_button_press_event_t* button = (const xcb_button_press_event_t*)event;
+			process_button(input, button->detail, (button->response_type & ~0x80) == XCB_BUTTON_PRESS, button->time);
+		} return true;
+
+		case XCB_MOTION_NOTIFY: {
+			// Handle mouse movement
+			const xcb_motion_notify_event_t* motion = (const xcb_motion_notify_event_t*)event;
+			u64 time = x11_time_to_ns(input, motion->time);
+			emit_input(input, INPUT_EVENT_TYPE_MOUSE_MOVE, 0, motion->event_x, motion->event_y, false, time);
+		} return true;
+	}
+
+	return false;
+}
+
+#endif // PLATFORM_XCB_ENABLED
+
+// Reads every input event that has arrived without blocking. Xlib's XPending flushes and may read the socket for every
+// event. xcb_poll_for_event reads the socket at most once and the rest of the batch comes out of what that read
+// buffered.
+static void read_input_events(X11_Input* input) {
+#if PLATFORM_XCB_ENABLED
+	xcb_generic_event_t* event = xcb_poll_for_event(input->connection);
+	while (event) {
+		process_xcb_input_event(input, event);
+		free(event);
+		event = xcb_poll_for_queued_event(input->connection);
+	}
+#else
+	XEvent event;
+	while (XPending(input->display)) {
+		XNextEvent(input->display, &event);
+		process_input_event(input, &event);
+	}
+#endif
+	flush_raw_motion(input);
+}
+
+static void* input_thread_main(void* arg) {
+	Platform_Internal* internal = (Platform_Internal*)arg;
+	Input_Thread* thread = &internal->input_thread;
+	X11_Input* input = &internal->input;
+
+	struct pollfd fds[2] = {
+		{ ConnectionNumber(input->display), POLLIN, 0 },
+		{ thread->wake_fd, POLLIN, 0 },
+	};
+
+	while (!atomic_load_explicit(&thread->quit, memory_order_acquire)) {
+		read_input_events(input);
+
+		// Block until the server sends more events, stamping them as soon as they arrive rather than once per frame
+		poll(fds, 2, -1);
+	}
+
+	return null;
+}
+
+// Frees what input_thread_start set up, once the thread is gone or was never started
+static void release_input_thread(Platform_Internal* internal) {
+	Input_Thread* thread = &internal->input_thread;
+
+	if (thread->wake_fd >= 0) {
+		close(thread->wake_fd);
+		thread->wake_fd = -1;
+	}
+
+	if (internal->input.display) {
+		XCloseDisplay(internal->input.display);
+		internal->input.display = null;
+	}
+
+	if (thread->queue) {
+		memory_free(thread->queue, sizeof(Input_Queue), MEMORY_TAG_PLATFORM);
+		thread->queue = null;
+		internal->input.queue = null;
+	}
+}
+
+// The input thread reads from its own X connection, so neither thread needs Xlib's locking.
+static b8 input_thread_start(Platform_Internal* internal, Window root) {
+	Input_Thread* thread = &internal->input_thread;
+	X11_Input* input = &internal->input;
+	thread->wake_fd = -1;
+	thread->running = false;
+
+	input->display = XOpenDisplay(NULL);
+	if (!input->display) {
+		log_error("Failed to open X display for input thread");
+		return false;
+	}
+#if PLATFORM_XCB_ENABLED
+	input->connection = take_event_queue(input->display);
+#endif
+
+	XSelectInput(input->display, internal->window, INPUT_EVENT_MASK);
+	input->raw_motion_enabled = enable_raw_motion(input, root);
+	XFlush(input->display);
+
+	thread->queue = memory_alloc(sizeof(Input_Queue), MEMORY_TAG_PLATFORM);
+	input->queue = thread->queue;
+
+	thread->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (thread->wake_fd < 0) {
+		log_error("Failed to create input thread wake event");
+		release_input_thread(internal);
+		return false;
+	}
+
+	atomic_store(&thread->quit, false);
+	if (pthread_create(&thread->thread, null, input_thread_main, internal) != 0) {
+		log_error("Failed to create input thread");
+		release_input_thread(internal);
+		return false;
+	}
+	thread->running = true;
+
+	log_info("Input thread started");
+	return true;
+}
+
+static void input_thread_stop(Platform_Internal* internal) {
+	Input_Thread* thread = &internal->input_thread;
+
+	if (thread->running) {
+		atomic_store_explicit(&thread->quit, true, memory_order_release);
+		u64 wake = 1;
+		if (write(thread->wake_fd, &wake, sizeof(wake)) != sizeof(wake)) {
+			log_warn("Failed to wake input thread");
+		}
+		pthread_join(thread->thread, null);
+		thread->running = false;
+	}
+
+	release_input_thread(internal);
+}
+
+// Hands everything the input thread has read so far to the input system, in order
+static void drain_input_queue(Platform_Internal* internal) {
+	Input_Thread* thread = &internal->input_thread;
+	Input_Queue* queue = thread->queue;
+
+	u32 tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+	u32 head = atomic_load_explicit(&queue->head, memory_order_acquire);
+
+	// The thread flushes raw motion on every wake, so fold it back into one delta per frame
+	i32 raw_x = 0;
+	i32 raw_y = 0;
+	u64 raw_time = 0;
+	for (; tail != head; tail++) {
+		const Input_Event* event = &queue->events[tail & (INPUT_QUEUE_CAPACITY - 1)];
+		if (event->type == INPUT_EVENT_TYPE_MOUSE_DELTA) {
+			raw_x += event->x;
+			raw_y += event->y;
+			raw_time = event->time;
+			continue;
+		}
+		deliver_input(event);
+	}
+	atomic_store_explicit(&queue->tail, tail, memory_order_release);
+
+	if (raw_time) {
+		input_process_mouse_delta(raw_x, raw_y, raw_time);
+		thread->consumed_raw_x += raw_x;
+		thread->consumed_raw_y += raw_y;
+	}
+
+	u32 dropped = atomic_exchange_explicit(&queue->dropped, 0, memory_order_relaxed);
+	if (dropped > 0) {
+		log_warn("Input queue full, dropped %u input events", dropped);
+	}
+}
+
+// Asks the server whether the window manager has marked the window hidden. Only runs when the state property changes.
+static b8 read_hidden(Platform_Internal* internal) {
+	Atom type;
+	int format;
+	unsigned long count;
+	unsigned long remaining;
+	unsigned char* data = null;
+	int result = XGetWindowProperty(
+		internal->display,
+		internal->window,
+		internal->atoms[X11_ATOM_NET_WM_STATE],
+		0, 64, False, XA_ATOM,
+		&type, &format, &count, &remaining, &data);
+	if (result != Success || !data) {
+		return false;
+	}
+
+	b8 hidden = false;
+	const Atom* states = (const Atom*)data;
+	for (unsigned long i = 0; i < count; i++) {
+		hidden |= states[i] == internal->atoms[X11_ATOM_NET_WM_STATE_HIDDEN];
+	}
+	XFree(data);
+	return hidden;
+}
+
+// Tracks the window's state from the main connection's events. Focus moving between the window and its children
+// leaves the focus as it was. Pointer details do count, since with PointerRoot focus they are the only events the
+// window gets as the keyboard follows the pointer in and out.
+static void update_window_state(Platform_Internal* internal, u32 type, u32 detail, u32 visibility, Atom property) {
+	switch (type) {
+		case FocusIn:
+		case FocusOut:
+			if (detail != NotifyInferior) {
+				internal->focused = type == FocusIn;
+			}
+			break;
+
+		case MapNotify:
+			internal->mapped = true;
+			break;
+
+		case UnmapNotify:
+			internal->mapped = false;
+			break;
+
+		case VisibilityNotify:
+			internal->obscured = visibility == VisibilityFullyObscured;
+			break;
+
+		case PropertyNotify:
+			if (property == internal->atoms[X11_ATOM_NET_WM_STATE]) {
+				internal->hidden = read_hidden(internal);
+			}
+			break;
+	}
+}
+
+#if PLATFORM_XCB_ENABLED
+// XCB's event codes and fields match the core protocol's, which Xlib's are named after
+static void update_xcb_window_state(Platform_Internal* internal, const xcb_generic_event_t* event) {
+	u32 type = event->response_type & ~0x80;
+	switch (type) {
+		case XCB_FOCUS_IN:
+		case XCB_FOCUS_OUT:
+			update_window_state(internal, type, ((const xcb_focus_in_event_t*)event)->detail, 0, None);
+			break;
+
+		case XCB_VISIBILITY_NOTIFY:
+			update_window_state(internal, type, 0, ((const xcb_visibility_notify_event_t*)event)->state, None);
+			break;
+
+		case XCB_PROPERTY_NOTIFY:
+			update_window_state(internal, type, 0, 0, ((const xcb_property_notify_event_t*)event)->atom);
+			break;
+
+		default:
+			update_window_state(internal, type, 0, 0, None);
+			break;
+	}
+}
+#endif
+
 b8 platform_pump_messages(Platform* platform) {
+	if (platform->backend != PLATFORM_BACKEND_NATIVE) {
+		return platform_headless_pump_messages(platform);
+	}
+
 	Platform_Internal* internal = (Platform_Internal*)platform->internal;
 
+	if (internal->input_thread_enabled) {
+		drain_input_queue(internal);
+	}
+
+	b8 running = true;
+
+#if PLATFORM_XCB_ENABLED
+	// Xlib requests like GLX's are only written out on a flush, which XPending used to do
+	xcb_flush(internal->connection);
+
+	xcb_generic_event_t* event = xcb_poll_for_event(internal->connection);
+	while (event) {
+		update_xcb_window_state(internal, event);
+		if (internal->input_thread_enabled || !process_xcb_input_event(&internal->input, event)) {
+			switch (event->response_type & ~0x80) {
+				case 0: {
+					const xcb_generic_error_t* error = (const xcb_generic_error_t*)event;
+					log_warn("X error %u from request %u", error->error_code, error->major_code);
+				} break;
+
+				case XCB_CLIENT_MESSAGE: {
+					const xcb_client_message_event_t* message = (const xcb_client_message_event_t*)event;
+					if (message->data.data32[0] == internal->atoms[X11_ATOM_WM_DELETE_WINDOW]) {
+						running = false;
+					}
+				} break;
+			}
+		}
+		free(event);
+		event = xcb_poll_for_queued_event(internal->connection);
+	}
+#else
 	XEvent event;
 	while (XPending(internal->display)) {
 		XNextEvent(internal->display, &event);
 
-		switch (event.type) {
-			case KeyPress:
-			case KeyRelease: {
-				// Get the key symbol
-				KeySym keysym = XLookupKeysym(&event.xkey, 0);
-				Key key = x11_keycode_to_key(keysym);
-				
-				// Only handle valid keys
-				if (key != KEY_COUNT) {
-					// Create event context
-					Event_Context context = {0};
-					context.vals[0] = key;
-					
-					// Fire the appropriate event
-					if (event.type == KeyPress) {
-						event_fire(EVENT_TYPE_KEY_PRESS, context, null);
-					} else {
-						event_fire(EVENT_TYPE_KEY_RELEASE, context, null);
-					}
-				}
-			} break;
-
-			case ButtonPress:
-			case ButtonRelease: {
-				// Handle mouse wheel
-				if (event.xbutton.button == Button4) {  // Mouse wheel up
-					Event_Context context = {0};
-					context.vals[0] = 1;  // Positive for scroll up
-					event_fire(EVENT_TYPE_MOUSE_WHEEL, context, null);
-					break;
-				}
-				if (event.xbutton.button == Button5) {  // Mouse wheel down
-					Event_Context context = {0};
-					context.vals[0] = -1;  // Negative for scroll down
-					event_fire(EVENT_TYPE_MOUSE_WHEEL, context, null);
-					break;
-				}
-
-				// Handle mouse buttons
-				Mouse_Button button = x11_button_to_mouse_button(event.xbutton.button);
-				if (button != MOUSE_BUTTON_COUNT) {
-					Event_Context context = {0};
-					context.vals[0] = button;
-					
-					if (event.type == ButtonPress) {
-						event_fire(EVENT_TYPE_MOUSE_BUTTON_PRESS, context, null);
-					} else {
-						event_fire(EVENT_TYPE_MOUSE_BUTTON_RELEASE, context, null);
-					}
-				}
-			} break;
+		update_window_state(
+			internal,
+			event.type,
+			event.type == FocusIn || event.type == FocusOut ? (u32)event.xfocus.detail : 0,
+			event.type == VisibilityNotify ? (u32)event.xvisibility.state : 0,
+			event.type == PropertyNotify ? event.xproperty.atom : None);
 
-			case MotionNotify: {
-				// Handle mouse movement
-				Event_Context context = {0};
-				context.vals[0] = event.xmotion.x;
-				context.vals[1] = event.xmotion.y;
-				event_fire(EVENT_TYPE_MOUSE_MOVE, context, null);
-			} break;
+		if (!internal->input_thread_enabled && process_input_event(&internal->input, &event)) {
+			continue;
+		}
 
+		switch (event.type) {
 			case ClientMessage:
-				if ((Atom)event.xclient.data.l[0] == internal->wm_delete_window) {
-					return false;
+				if ((Atom)event.xclient.data.l[0] == internal->atoms[X11_ATOM_WM_DELETE_WINDOW]) {
+					running = false;
 				}
 				break;
 		}
 	}
+#endif
 
-	return true;
+	if (!internal->input_thread_enabled) {
+		flush_raw_motion(&internal->input);
+	}
+
+	return running;
+}
+
+Platform_Window_State platform_get_window_state(Platform* platform) {
+	if (platform->backend != PLATFORM_BACKEND_NATIVE) {
+		return (Platform_Window_State){ true, true, false };
+	}
+
+	Platform_Internal* internal = (Platform_Internal*)platform->internal;
+	Platform_Window_State state;
+	state.focused = internal->focused;
+	state.minimized = !internal->mapped || internal->hidden;
+	state.visible = !state.minimized && !internal->obscured;
+	return state;
+}
+
+b8 platform_wait_for_events(Platform* platform, u64 timeout_ms) {
+	if (platform->backend != PLATFORM_BACKEND_NATIVE) {
+		platform_sleep(timeout_ms);
+		return false;
+	}
+
+	Platform_Internal* internal = (Platform_Internal*)platform->internal;
+
+	// Pending requests have to go out before blocking. Events Xlib has already read ahead would not wake the poll.
+#if PLATFORM_XCB_ENABLED
+	xcb_flush(internal->connection);
+#else
+	if (XPending(internal->display)) {
+		return true;
+	}
+#endif
+
+	struct pollfd fd = { ConnectionNumber(internal->display), POLLIN, 0 };
+	int timeout = timeout_ms > INT32_MAX ? INT32_MAX : (int)timeout_ms;
+	int result;
+	do {
+		result = poll(&fd, 1, timeout);
+	} while (result < 0 && errno == EINTR);
+	return result > 0;
+}
+
+void platform_latch_input(Platform* platform) {
+	if (platform->backend != PLATFORM_BACKEND_NATIVE) {
+		return;
+	}
+
+	Platform_Internal* internal = (Platform_Internal*)platform->internal;
+	if (!internal->input_thread_enabled) {
+		return;
+	}
+
+	// Only pointer state is latched. Keys and buttons stay queued for the next pump so they are seen in order.
+	Input_Thread* thread = &internal->input_thread;
+	Input_Queue* queue = thread->queue;
+	if (!atomic_load_explicit(&queue->has_position, memory_order_acquire)) {
+		return;
+	}
+	u64 position = atomic_load_explicit(&queue->latest_position, memory_order_relaxed);
+	i64 raw_total_x = atomic_load_explicit(&queue->raw_total_x, memory_order_relaxed);
+	i64 raw_total_y = atomic_load_explicit(&queue->raw_total_y, memory_order_relaxed);
+	input_process_latch(
+		(i32)(position >> 32),
+		(i32)(u32)position,
+		(i32)(raw_total_x - thread->consumed_raw_x),
+		(i32)(raw_total_y - thread->consumed_raw_y));
 }
 
 b8 platform_swap_buffers(Platform* platform) {
+	if (platform->backend == PLATFORM_BACKEND_HEADLESS) {
+		return true;
+	}
+	if (platform->backend == PLATFORM_BACKEND_OFFSCREEN) {
+		return platform_offscreen_swap_buffers(platform);
+	}
+
 	Platform_Internal* internal = (Platform_Internal*)platform->internal;
 	glXSwapBuffers(internal->display, internal->window);
 	return true;
@@ -372,13 +1210,35 @@ void platform_console_write_error(const char* message, Platform_Console_Color co
 }
 
 f64 platform_get_time(Platform* platform) {
-	struct timeval now;
-	gettimeofday(&now, NULL);
-	return (f64)now.tv_sec + (f64)now.tv_usec / 1000000.0;
+	return (f64)platform_get_time_ns() / 1000000000.0;
+}
+
+u64 platform_get_time_ns(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (u64)now.tv_sec * 1000000000ull + (u64)now.tv_nsec;
 }
 
 void platform_sleep(u64 ms) {
-	sleep(ms * 1000);
+	struct timespec duration = { (time_t)(ms / 1000), (long)(ms % 1000) * 1000000 };
+	while (nanosleep(&duration, &duration) == -1 && errno == EINTR) {
+		// Interrupted by a signal, sleep for the rest
+	}
+}
+
+void platform_sleep_until_ns(u64 deadline_ns, u64 spin_ns) {
+	u64 now = platform_get_time_ns();
+	if (deadline_ns > now + spin_ns) {
+		u64 wake = deadline_ns - spin_ns;
+		struct timespec wake_time = { (time_t)(wake / 1000000000ull), (long)(wake % 1000000000ull) };
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake_time, null) == EINTR) {
+			// Interrupted by a signal, the absolute deadline is unchanged
+		}
+	}
+
+	while (platform_get_time_ns() < deadline_ns) {
+		// Spin
+	}
 }
  
 b8 platform_is_debugging(void) {
@@ -386,4 +1246,9 @@ b8 platform_is_debugging(void) {
 	return false;
 }
 
+u32 platform_get_processor_count(void) {
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (u32)count : 1;
+}
+
 #endif // PLATFORM_LINUX
@@ -0,0 +1,224 @@
+#include "platform/platform_offscreen.h"
+#include "platform/platform_headless.h"
+
+#include "core/context.h"
+#include "core/log.h"
+#include "core/memory.h"
+
+#ifdef PLATFORM_LINUX
+
+#include "graphics/renderer_opengl.h"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <string.h>
+
+typedef struct Offscreen_Internal {
+	EGLDisplay display;
+	EGLContext context;
+	// Only created when the driver lacks surfaceless contexts
+	EGLSurface pbuffer;
+	GLuint framebuffer;
+	GLuint color_buffer;
+	GLuint depth_buffer;
+	i32 width;
+	i32 height;
+} Offscreen_Internal;
+
+static b8 has_extension(const char* extensions, const char* name) {
+	if (!extensions) {
+		return false;
+	}
+
+	u64 length = strlen(name);
+	const char* found = extensions;
+	while ((found = strstr(found, name))) {
+		if ((found == extensions || found[-1] == ' ') && (found[length] == ' ' || found[length] == '\0')) {
+			return true;
+		}
+		found += length;
+	}
+	return false;
+}
+
+// Prefers Mesa's surfaceless platform, which never touches a display server
+static EGLDisplay get_display(void) {
+	const char* client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+	if (has_extension(client_extensions, "EGL_MESA_platform_surfaceless")) {
+		PFNEGLGETPLATFORMDISPLAYEXTPROC eglGetPlatformDisplayEXT =
+			(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+		if (eglGetPlatformDisplayEXT) {
+			EGLDisplay display = eglGetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, null);
+			if (display != EGL_NO_DISPLAY) {
+				log_info("Using the EGL surfaceless platform");
+				return display;
+			}
+		}
+	}
+	return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+static b8 create_framebuffer(Offscreen_Internal* internal) {
+	glGenFramebuffers(1, &internal->framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, internal->framebuffer);
+
+	glGenRenderbuffers(1, &internal->color_buffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, internal->color_buffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, RENDER_SRGB_ENABLED ? GL_SRGB8_ALPHA8 : GL_RGBA8, internal->width, internal->height);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, internal->color_buffer);
+
+	glGenRenderbuffers(1, &internal->depth_buffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, internal->depth_buffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, internal->width, internal->height);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, internal->depth_buffer);
+
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	if (status != GL_FRAMEBUFFER_COMPLETE) {
+		log_fatal("Offscreen framebuffer is incomplete: 0x%x", status);
+		return false;
+	}
+
+	glViewport(0, 0, internal->width, internal->height);
+	return true;
+}
+
+b8 platform_offscreen_start(Platform* platform, const char* app_name, i32 width, i32 height) {
+	if (!platform_headless_start(platform, app_name)) {
+		return false;
+	}
+
+	log_info("Platform start (offscreen %dx%d)", width, height);
+	Offscreen_Internal* internal = memory_alloc(sizeof(Offscreen_Internal), MEMORY_TAG_PLATFORM);
+	memory_zero(internal, sizeof(Offscreen_Internal));
+	internal->width = width;
+	internal->height = height;
+	platform->internal = internal;
+
+	internal->display = get_display();
+	EGLint major, minor;
+	if (internal->display == EGL_NO_DISPLAY || !eglInitialize(internal->display, &major, &minor)) {
+		log_fatal("Failed to initialize EGL");
+		platform_offscreen_shutdown(platform);
+		return false;
+	}
+	log_info("EGL %d.%d, %s", major, minor, eglQueryString(internal->display, EGL_VENDOR));
+
+	if (!eglBindAPI(EGL_OPENGL_API)) {
+		log_fatal("EGL does not support desktop OpenGL");
+		platform_offscreen_shutdown(platform);
+		return false;
+	}
+
+	// Everything is drawn into the framebuffer object, so the default surface only has to exist where it is required
+	const char* extensions = eglQueryString(internal->display, EGL_EXTENSIONS);
+	b8 needs_pbuffer = !has_extension(extensions, "EGL_KHR_surfaceless_context");
+	const EGLint config_attributes[] = {
+		EGL_SURFACE_TYPE, needs_pbuffer ? EGL_PBUFFER_BIT : 0,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8,
+		EGL_GREEN_SIZE, 8,
+		EGL_BLUE_SIZE, 8,
+		EGL_ALPHA_SIZE, 8,
+		EGL_NONE,
+	};
+	// The surfaceless platform may expose no configs at all, which is fine when contexts do not need one. A pbuffer
+	// always does.
+	EGLConfig config = EGL_NO_CONFIG_KHR;
+	EGLint config_count = 0;
+	eglChooseConfig(internal->display, config_attributes, &config, 1, &config_count);
+	if (config_count == 0) {
+		if (needs_pbuffer) {
+			log_fatal("No EGL config with pbuffer support for offscreen OpenGL rendering");
+			platform_offscreen_shutdown(platform);
+			return false;
+		}
+		if (!has_extension(extensions, "EGL_KHR_no_config_context")) {
+			log_fatal("No EGL config for offscreen OpenGL rendering");
+			platform_offscreen_shutdown(platform);
+			return false;
+		}
+		config = EGL_NO_CONFIG_KHR;
+	}
+
+	// Older Mesa releases of llvmpipe stop at 4.5, which the renderer also runs on
+	static const EGLint minor_versions[] = { 6, 5 };
+	for (u32 i = 0; i < sizeof(minor_versions) / sizeof(minor_versions[0]) && internal->context == EGL_NO_CONTEXT; i++) {
+		const EGLint context_attributes[] = {
+			EGL_CONTEXT_MAJOR_VERSION, 4,
+			EGL_CONTEXT_MINOR_VERSION, minor_versions[i],
+			EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+			EGL_NONE,
+		};
+		internal->context = eglCreateContext(internal->display, config, EGL_NO_CONTEXT, context_attributes);
+	}
+	if (internal->context == EGL_NO_CONTEXT) {
+		log_fatal("Failed to create an OpenGL 4.5 or 4.6 core context: 0x%x", eglGetError());
+		platform_offscreen_shutdown(platform);
+		return false;
+	}
+
+	EGLSurface surface = EGL_NO_SURFACE;
+	if (needs_pbuffer) {
+		const EGLint pbuffer_attributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+		internal->pbuffer = eglCreatePbufferSurface(internal->display, config, pbuffer_attributes);
+		if (internal->pbuffer == EGL_NO_SURFACE) {
+			log_fatal("Failed to create pbuffer surface: 0x%x", eglGetError());
+			platform_offscreen_shutdown(platform);
+			return false;
+		}
+		surface = internal->pbuffer;
+	}
+
+	if (!eglMakeCurrent(internal->display, surface, surface, internal->context)) {
+		log_fatal("Failed to make OpenGL context current: 0x%x", eglGetError());
+		platform_offscreen_shutdown(platform);
+		return false;
+	}
+
+	if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+		log_fatal("Failed to initialize GLAD");
+		platform_offscreen_shutdown(platform);
+		return false;
+	}
+	log_info("OpenGL %s, %s", glGetString(GL_VERSION), glGetString(GL_RENDERER));
+
+	if (!create_framebuffer(internal)) {
+		platform_offscreen_shutdown(platform);
+		return false;
+	}
+	return true;
+}
+
+void platform_offscreen_shutdown(Platform* platform) {
+	Offscreen_Internal* internal = (Offscreen_Internal*)platform->internal;
+
+	if (internal) {
+		if (internal->context != EGL_NO_CONTEXT) {
+			if (internal->framebuffer) {
+				glDeleteFramebuffers(1, &internal->framebuffer);
+				glDeleteRenderbuffers(1, &internal->color_buffer);
+				glDeleteRenderbuffers(1, &internal->depth_buffer);
+			}
+			eglMakeCurrent(internal->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+			eglDestroyContext(internal->display, internal->context);
+		}
+		if (internal->pbuffer != EGL_NO_SURFACE) {
+			eglDestroySurface(internal->display, internal->pbuffer);
+		}
+		if (internal->display != EGL_NO_DISPLAY) {
+			eglTerminate(internal->display);
+		}
+		memory_free(internal, sizeof(Offscreen_Internal), MEMORY_TAG_PLATFORM);
+		platform->internal = null;
+	}
+
+	platform_headless_shutdown(platform);
+}
+
+b8 platform_offscreen_swap_buffers(Platform* platform) {
+	// Nothing is presented, but the frame's commands still have to reach the driver
+	glFlush();
+	return true;
+}
+
+#endif // PLATFORM_LINUX
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "platform/platform.h"
+
+/**
+ * The offscreen backend (Linux only). Creates an OpenGL 4.6 core context through EGL with no window, surfaceless
+ * where the driver supports it and on a 1x1 pbuffer otherwise, and binds a framebuffer object of the requested size
+ * as the render target. Works on Mesa llvmpipe, so it needs neither a GPU nor a display.
+ */
+
+b8 platform_offscreen_start(Platform* platform, const char* app_name, i32 width, i32 height);
+
+void platform_offscreen_shutdown(Platform* platform);
+
+b8 platform_offscreen_swap_buffers(Platform* platform);
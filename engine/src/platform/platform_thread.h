@@ -0,0 +1,110 @@
+#pragma once
+
+#include "core/export.h"
+#include "core/types.h"
+
+/**
+ * Threads and synchronization primitives.
+ *
+ * Mutexes, condition variables and semaphores are plain structs that are ready to use when zero initialized, and
+ * need no destroy call. On Linux they are built on futexes. On Windows mutexes and condition variables are SRW locks
+ * and CONDITION_VARIABLEs, and semaphores wait on WaitOnAddress. None of them are recursive, and the uncontended paths
+ * never enter the kernel.
+ */
+
+// For variables private to the engine or the app. Thread local variables cannot be shared across the DLL boundary.
+#define thread_local _Thread_local
+
+// Linux truncates thread names to 15 characters
+#define THREAD_NAME_MAX 16
+
+typedef i32 (*Thread_Function)(void* data);
+
+// Must stay at the same address until the thread is joined
+typedef struct Thread {
+	u64 handle;
+	Thread_Function function;
+	void* data;
+	char name[THREAD_NAME_MAX];
+} Thread;
+
+// Zero initialized is unlocked
+typedef union Mutex {
+	u32 futex;
+	void* srw_lock;
+} Mutex;
+
+typedef union Condvar {
+	u32 sequence;
+	void* condition_variable;
+} Condvar;
+
+typedef struct Semaphore {
+	u32 count;
+	u32 waiters;
+} Semaphore;
+
+typedef u32 Tls_Key;
+
+//
+// Threads
+//
+
+// A stack size of zero uses the OS default
+export b8 thread_create(Thread* out_thread, const char* name, u64 stack_size, Thread_Function function, void* data);
+
+// Waits for the thread to finish and returns its result
+export i32 thread_join(Thread* thread);
+
+// OS identifier of the calling thread
+export u64 thread_get_current_id(void);
+
+// Gives up the rest of the calling thread's time slice
+export void thread_yield(void);
+
+//
+// Mutex
+//
+
+export void mutex_lock(Mutex* mutex);
+
+export b8 mutex_try_lock(Mutex* mutex);
+
+export void mutex_unlock(Mutex* mutex);
+
+//
+// Condition variable
+//
+
+// Unlocks the mutex while waiting and locks it again before returning. May wake spuriously.
+export void condvar_wait(Condvar* condvar, Mutex* mutex);
+
+// Returns false if the timeout passed before a wake
+export b8 condvar_wait_timeout(Condvar* condvar, Mutex* mutex, u64 timeout_ns);
+
+export void condvar_signal(Condvar* condvar);
+
+export void condvar_broadcast(Condvar* condvar);
+
+//
+// Semaphore
+//
+
+export void semaphore_wait(Semaphore* semaphore);
+
+export b8 semaphore_try_wait(Semaphore* semaphore);
+
+export void semaphore_post(Semaphore* semaphore, u32 count);
+
+//
+// Thread local storage
+//
+
+// Slots start out null on every thread
+export b8 tls_create(Tls_Key* out_key);
+
+export void tls_destroy(Tls_Key key);
+
+export void* tls_get(Tls_Key key);
+
+export void tls_set(Tls_Key key, void* value);
@@ -0,0 +1,229 @@
+#include "platform/platform_thread.h"
+
+#include "core/atomic.h"
+#include "core/context.h"
+#include "core/log.h"
+
+#ifdef PLATFORM_LINUX
+
+#include <errno.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+// Mutex states
+#define MUTEX_UNLOCKED  0
+#define MUTEX_LOCKED    1
+// Locked with threads possibly asleep on it, so unlock has to wake one
+#define MUTEX_CONTENDED 2
+
+// Attempts to take a contended mutex by spinning before sleeping, which wins for short critical sections
+#define MUTEX_SPIN_COUNT 100
+
+static_assert(sizeof(pthread_t) <= sizeof(u64), "Expected pthread_t to fit in Thread.handle");
+
+//
+// Futex
+//
+
+// Sleeps while *address == expected. Returns false on timeout.
+static b8 futex_wait(u32* address, u32 expected, const struct timespec* timeout) {
+	long result = syscall(SYS_futex, address, FUTEX_WAIT_PRIVATE, expected, timeout, null, 0);
+	return !(result == -1 && errno == ETIMEDOUT);
+}
+
+static void futex_wake(u32* address, i32 count) {
+	syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE, count, null, null, 0);
+}
+
+//
+// Threads
+//
+
+static void* thread_main(void* arg) {
+	Thread* thread = (Thread*)arg;
+	if (thread->name[0]) {
+		pthread_setname_np(pthread_self(), thread->name);
+	}
+	return (void*)(i64)thread->function(thread->data);
+}
+
+b8 thread_create(Thread* out_thread, const char* name, u64 stack_size, Thread_Function function, void* data) {
+	out_thread->function = function;
+	out_thread->data = data;
+	out_thread->name[0] = '\0';
+	if (name) {
+		strncpy(out_thread->name, name, THREAD_NAME_MAX - 1);
+		out_thread->name[THREAD_NAME_MAX - 1] = '\0';
+	}
+
+	pthread_attr_t attributes;
+	pthread_attr_init(&attributes);
+	if (stack_size && pthread_attr_setstacksize(&attributes, stack_size) != 0) {
+		log_warn("Invalid stack size %llu for thread %s, using the default", stack_size, out_thread->name);
+	}
+
+	pthread_t handle;
+	i32 result = pthread_create(&handle, &attributes, thread_main, out_thread);
+	pthread_attr_destroy(&attributes);
+	if (result != 0) {
+		log_error("Failed to create thread %s: %s", out_thread->name, strerror(result));
+		return false;
+	}
+
+	out_thread->handle = (u64)handle;
+	return true;
+}
+
+i32 thread_join(Thread* thread) {
+	void* result = null;
+	pthread_join((pthread_t)thread->handle, &result);
+	thread->handle = 0;
+	return (i32)(i64)result;
+}
+
+u64 thread_get_current_id(void) {
+	return (u64)syscall(SYS_gettid);
+}
+
+void thread_yield(void) {
+	sched_yield();
+}
+
+//
+// Mutex
+//
+
+void mutex_lock(Mutex* mutex) {
+	u32 state = MUTEX_UNLOCKED;
+	if (atomic_compare_exchange_u32(&mutex->futex, &state, MUTEX_LOCKED, MEMORY_ORDER_ACQUIRE, MEMORY_ORDER_RELAXED)) {
+		return;
+	}
+
+	for (u32 i = 0; i < MUTEX_SPIN_COUNT; i++) {
+		cpu_pause();
+		state = MUTEX_UNLOCKED;
+		if (atomic_load_u32(&mutex->futex, MEMORY_ORDER_RELAXED) == MUTEX_UNLOCKED &&
+			atomic_compare_exchange_u32(&mutex->futex, &state, MUTEX_LOCKED, MEMORY_ORDER_ACQUIRE, MEMORY_ORDER_RELAXED)) {
+			return;
+		}
+	}
+
+	// Mark the mutex contended before sleeping so the holder knows to wake us
+	while (atomic_exchange_u32(&mutex->futex, MUTEX_CONTENDED, MEMORY_ORDER_ACQUIRE) != MUTEX_UNLOCKED) {
+		futex_wait(&mutex->futex, MUTEX_CONTENDED, null);
+	}
+}
+
+b8 mutex_try_lock(Mutex* mutex) {
+	u32 state = MUTEX_UNLOCKED;
+	return atomic_compare_exchange_u32(&mutex->futex, &state, MUTEX_LOCKED, MEMORY_ORDER_ACQUIRE, MEMORY_ORDER_RELAXED);
+}
+
+void mutex_unlock(Mutex* mutex) {
+	if (atomic_exchange_u32(&mutex->futex, MUTEX_UNLOCKED, MEMORY_ORDER_RELEASE) == MUTEX_CONTENDED) {
+		futex_wake(&mutex->futex, 1);
+	}
+}
+
+//
+// Condition variable
+//
+
+// Waiters sleep on a sequence number that every signal bumps, so a signal between unlocking and sleeping is not lost
+static b8 condvar_wait_internal(Condvar* condvar, Mutex* mutex, const struct timespec* timeout) {
+	u32 sequence = atomic_load_u32(&condvar->sequence, MEMORY_ORDER_RELAXED);
+	mutex_unlock(mutex);
+	b8 woken = futex_wait(&condvar->sequence, sequence, timeout);
+
+	// Other waiters may have been woken with us, so take the mutex as contended to keep the wake chain going
+	while (atomic_exchange_u32(&mutex->futex, MUTEX_CONTENDED, MEMORY_ORDER_ACQUIRE) != MUTEX_UNLOCKED) {
+		futex_wait(&mutex->futex, MUTEX_CONTENDED, null);
+	}
+	return woken;
+}
+
+void condvar_wait(Condvar* condvar, Mutex* mutex) {
+	condvar_wait_internal(condvar, mutex, null);
+}
+
+b8 condvar_wait_timeout(Condvar* condvar, Mutex* mutex, u64 timeout_ns) {
+	struct timespec timeout = { (time_t)(timeout_ns / 1000000000ull), (long)(timeout_ns % 1000000000ull) };
+	return condvar_wait_internal(condvar, mutex, &timeout);
+}
+
+void condvar_signal(Condvar* condvar) {
+	atomic_fetch_add_u32(&condvar->sequence, 1, MEMORY_ORDER_RELEASE);
+	futex_wake(&condvar->sequence, 1);
+}
+
+void condvar_broadcast(Condvar* condvar) {
+	atomic_fetch_add_u32(&condvar->sequence, 1, MEMORY_ORDER_RELEASE);
+	futex_wake(&condvar->sequence, INT_MAX);
+}
+
+//
+// Semaphore
+//
+
+b8 semaphore_try_wait(Semaphore* semaphore) {
+	u32 count = atomic_load_u32(&semaphore->count, MEMORY_ORDER_RELAXED);
+	while (count > 0) {
+		if (atomic_compare_exchange_u32(&semaphore->count, &count, count - 1, MEMORY_ORDER_ACQUIRE, MEMORY_ORDER_RELAXED)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void semaphore_wait(Semaphore* semaphore) {
+	while (!semaphore_try_wait(semaphore)) {
+		// The waiter count and the count are ordered against semaphore_post, so either it sees us waiting or we see its
+		// count and the futex wait returns immediately
+		atomic_fetch_add_u32(&semaphore->waiters, 1, MEMORY_ORDER_SEQ_CST);
+		futex_wait(&semaphore->count, 0, null);
+		atomic_fetch_sub_u32(&semaphore->waiters, 1, MEMORY_ORDER_RELAXED);
+	}
+}
+
+void semaphore_post(Semaphore* semaphore, u32 count) {
+	atomic_fetch_add_u32(&semaphore->count, count, MEMORY_ORDER_SEQ_CST);
+	if (atomic_load_u32(&semaphore->waiters, MEMORY_ORDER_SEQ_CST) > 0) {
+		futex_wake(&semaphore->count, count > INT_MAX ? INT_MAX : (i32)count);
+	}
+}
+
+//
+// Thread local storage
+//
+
+static_assert(sizeof(pthread_key_t) <= sizeof(Tls_Key), "Expected pthread_key_t to fit in Tls_Key");
+
+b8 tls_create(Tls_Key* out_key) {
+	pthread_key_t key;
+	if (pthread_key_create(&key, null) != 0) {
+		log_error("Failed to create thread local storage key");
+		return false;
+	}
+	*out_key = (Tls_Key)key;
+	return true;
+}
+
+void tls_destroy(Tls_Key key) {
+	pthread_key_delete((pthread_key_t)key);
+}
+
+void* tls_get(Tls_Key key) {
+	return pthread_getspecific((pthread_key_t)key);
+}
+
+void tls_set(Tls_Key key, void* value) {
+	pthread_setspecific((pthread_key_t)key, value);
+}
+
+#endif // PLATFORM_LINUX
@@ -0,0 +1,172 @@
+#include "platform/platform_thread.h"
+
+#include "core/atomic.h"
+#include "core/context.h"
+#include "core/log.h"
+
+#ifdef PLATFORM_WINDOWS
+
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <string.h>
+
+static_assert(sizeof(SRWLOCK) == sizeof(Mutex), "Expected SRWLOCK to fit in Mutex");
+static_assert(sizeof(CONDITION_VARIABLE) == sizeof(Condvar), "Expected CONDITION_VARIABLE to fit in Condvar");
+
+// SetThreadDescription is only available from Windows 10 1607
+typedef HRESULT (WINAPI *PFN_SET_THREAD_DESCRIPTION)(HANDLE thread, PCWSTR description);
+
+//
+// Threads
+//
+
+static DWORD WINAPI thread_main(LPVOID arg) {
+	Thread* thread = (Thread*)arg;
+	if (thread->name[0]) {
+		PFN_SET_THREAD_DESCRIPTION set_thread_description =
+			(PFN_SET_THREAD_DESCRIPTION)GetProcAddress(GetModuleHandleA("kernel32.dll"), "SetThreadDescription");
+		if (set_thread_description) {
+			WCHAR name[THREAD_NAME_MAX];
+			MultiByteToWideChar(CP_UTF8, 0, thread->name, -1, name, THREAD_NAME_MAX);
+			set_thread_description(GetCurrentThread(), name);
+		}
+	}
+	return (DWORD)thread->function(thread->data);
+}
+
+b8 thread_create(Thread* out_thread, const char* name, u64 stack_size, Thread_Function function, void* data) {
+	out_thread->function = function;
+	out_thread->data = data;
+	out_thread->name[0] = '\0';
+	if (name) {
+		strncpy(out_thread->name, name, THREAD_NAME_MAX - 1);
+		out_thread->name[THREAD_NAME_MAX - 1] = '\0';
+	}
+
+	HANDLE handle = CreateThread(null, (SIZE_T)stack_size, thread_main, out_thread, STACK_SIZE_PARAM_IS_A_RESERVATION, null);
+	if (!handle) {
+		log_error("Failed to create thread %s: %lu", out_thread->name, GetLastError());
+		return false;
+	}
+
+	out_thread->handle = (u64)handle;
+	return true;
+}
+
+i32 thread_join(Thread* thread) {
+	HANDLE handle = (HANDLE)thread->handle;
+	WaitForSingleObject(handle, INFINITE);
+	DWORD result = 0;
+	GetExitCodeThread(handle, &result);
+	CloseHandle(handle);
+	thread->handle = 0;
+	return (i32)result;
+}
+
+u64 thread_get_current_id(void) {
+	return (u64)GetCurrentThreadId();
+}
+
+void thread_yield(void) {
+	SwitchToThread();
+}
+
+//
+// Mutex
+//
+
+void mutex_lock(Mutex* mutex) {
+	AcquireSRWLockExclusive((PSRWLOCK)mutex);
+}
+
+b8 mutex_try_lock(Mutex* mutex) {
+	return TryAcquireSRWLockExclusive((PSRWLOCK)mutex) != 0;
+}
+
+void mutex_unlock(Mutex* mutex) {
+	ReleaseSRWLockExclusive((PSRWLOCK)mutex);
+}
+
+//
+// Condition variable
+//
+
+void condvar_wait(Condvar* condvar, Mutex* mutex) {
+	SleepConditionVariableSRW((PCONDITION_VARIABLE)condvar, (PSRWLOCK)mutex, INFINITE, 0);
+}
+
+b8 condvar_wait_timeout(Condvar* condvar, Mutex* mutex, u64 timeout_ns) {
+	// Round up so short timeouts still sleep
+	DWORD timeout_ms = (DWORD)((timeout_ns + 999999) / 1000000);
+	return SleepConditionVariableSRW((PCONDITION_VARIABLE)condvar, (PSRWLOCK)mutex, timeout_ms, 0) != 0;
+}
+
+void condvar_signal(Condvar* condvar) {
+	WakeConditionVariable((PCONDITION_VARIABLE)condvar);
+}
+
+void condvar_broadcast(Condvar* condvar) {
+	WakeAllConditionVariable((PCONDITION_VARIABLE)condvar);
+}
+
+//
+// Semaphore
+//
+
+b8 semaphore_try_wait(Semaphore* semaphore) {
+	u32 count = atomic_load_u32(&semaphore->count, MEMORY_ORDER_RELAXED);
+	while (count > 0) {
+		if (atomic_compare_exchange_u32(&semaphore->count, &count, count - 1, MEMORY_ORDER_ACQUIRE, MEMORY_ORDER_RELAXED)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void semaphore_wait(Semaphore* semaphore) {
+	u32 zero = 0;
+	while (!semaphore_try_wait(semaphore)) {
+		atomic_fetch_add_u32(&semaphore->waiters, 1, MEMORY_ORDER_SEQ_CST);
+		WaitOnAddress(&semaphore->count, &zero, sizeof(u32), INFINITE);
+		atomic_fetch_sub_u32(&semaphore->waiters, 1, MEMORY_ORDER_RELAXED);
+	}
+}
+
+void semaphore_post(Semaphore* semaphore, u32 count) {
+	atomic_fetch_add_u32(&semaphore->count, count, MEMORY_ORDER_SEQ_CST);
+	if (atomic_load_u32(&semaphore->waiters, MEMORY_ORDER_SEQ_CST) > 0) {
+		if (count == 1) {
+			WakeByAddressSingle(&semaphore->count);
+		} else {
+			WakeByAddressAll(&semaphore->count);
+		}
+	}
+}
+
+//
+// Thread local storage
+//
+
+b8 tls_create(Tls_Key* out_key) {
+	DWORD key = TlsAlloc();
+	if (key == TLS_OUT_OF_INDEXES) {
+		log_error("Failed to create thread local storage key");
+		return false;
+	}
+	*out_key = (Tls_Key)key;
+	return true;
+}
+
+void tls_destroy(Tls_Key key) {
+	TlsFree((DWORD)key);
+}
+
+void* tls_get(Tls_Key key) {
+	return TlsGetValue((DWORD)key);
+}
+
+void tls_set(Tls_Key key, void* value) {
+	TlsSetValue((DWORD)key, value);
+}
+
+#endif // PLATFORM_WINDOWS
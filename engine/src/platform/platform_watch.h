@@ -0,0 +1,32 @@
+#pragma once
+
+#include "core/export.h"
+#include "core/types.h"
+
+/**
+ * Directory change notifications.
+ *
+ * Watches directories, not recursively, for files being written, created, renamed or deleted, through inotify on Linux
+ * and ReadDirectoryChangesW on Windows. Changes are collected by polling, which never blocks, so the main loop can
+ * poll once a frame. A single save often arrives as several changes, so callers should debounce.
+ */
+
+#define PLATFORM_WATCH_MAX 64
+
+// Watch id passed when changes were lost because the OS queue overflowed, with a null name. Anything may have changed.
+#define PLATFORM_WATCH_OVERFLOW -1
+
+typedef void (*Platform_Watch_Callback)(i32 watch, const char* name, void* data);
+
+b8 platform_watch_start(void);
+
+void platform_watch_shutdown(void);
+
+// Returns an id for the directory, the same one if it is already watched, or -1 on failure. Every success needs a
+// platform_watch_release, and the directory is watched until the last one.
+i32 platform_watch_directory(const char* directory);
+
+void platform_watch_release(i32 id);
+
+// Calls the callback with the name of each file changed since the last poll
+void platform_watch_poll(Platform_Watch_Callback callback, void* data);
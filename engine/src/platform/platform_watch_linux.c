@@ -0,0 +1,120 @@
+#include "platform/platform_watch.h"
+
+#include "core/context.h"
+#include "core/log.h"
+
+#ifdef PLATFORM_LINUX
+
+#include <errno.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#define WATCH_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE | IN_MODIFY)
+
+// inotify hands back the same descriptor for a directory it already watches, so each one counts its users
+typedef struct Directory_Watch {
+	i32 descriptor;
+	u32 references;
+} Directory_Watch;
+
+typedef struct Watch_System {
+	i32 fd;
+	Directory_Watch watches[PLATFORM_WATCH_MAX];
+	u32 watch_count;
+} Watch_System;
+
+static Watch_System watch = { .fd = -1 };
+
+b8 platform_watch_start(void) {
+	watch.fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (watch.fd < 0) {
+		log_error("Failed to start inotify: %s", strerror(errno));
+		return false;
+	}
+	watch.watch_count = 0;
+	return true;
+}
+
+void platform_watch_shutdown(void) {
+	// Closing the descriptor removes every watch
+	if (watch.fd >= 0) {
+		close(watch.fd);
+	}
+	watch.fd = -1;
+	watch.watch_count = 0;
+}
+
+static Directory_Watch* find_watch(i32 descriptor) {
+	for (u32 i = 0; i < watch.watch_count; i++) {
+		if (watch.watches[i].descriptor == descriptor) {
+			return &watch.watches[i];
+		}
+	}
+	return null;
+}
+
+i32 platform_watch_directory(const char* directory) {
+	if (watch.fd < 0) {
+		return -1;
+	}
+
+	i32 descriptor = inotify_add_watch(watch.fd, directory, WATCH_EVENTS | IN_ONLYDIR);
+	if (descriptor < 0) {
+		log_error("Failed to watch %s: %s", directory, strerror(errno));
+		return -1;
+	}
+
+	Directory_Watch* directory_watch = find_watch(descriptor);
+	if (directory_watch) {
+		directory_watch->references++;
+		return descriptor;
+	}
+	if (watch.watch_count == PLATFORM_WATCH_MAX) {
+		log_error("Can't watch more than %u directories", PLATFORM_WATCH_MAX);
+		inotify_rm_watch(watch.fd, descriptor);
+		return -1;
+	}
+	watch.watches[watch.watch_count++] = (Directory_Watch){ descriptor, 1 };
+	return descriptor;
+}
+
+void platform_watch_release(i32 id) {
+	Directory_Watch* directory_watch = find_watch(id);
+	if (!directory_watch || --directory_watch->references > 0) {
+		return;
+	}
+
+	// The removal queues an IN_IGNORED event without a name, which polling skips
+	inotify_rm_watch(watch.fd, directory_watch->descriptor);
+	*directory_watch = watch.watches[--watch.watch_count];
+}
+
+void platform_watch_poll(Platform_Watch_Callback callback, void* data) {
+	if (watch.fd < 0) {
+		return;
+	}
+
+	// Room for many events, each at least the size of the struct
+	_Alignas(struct inotify_event) char buffer[16 * 1024];
+	for (;;) {
+		ssize_t length = read(watch.fd, buffer, sizeof(buffer));
+		if (length <= 0) {
+			// EAGAIN once drained
+			return;
+		}
+
+		for (char* c = buffer; c < buffer + length;) {
+			struct inotify_event* event = (struct inotify_event*)c;
+			c += sizeof(struct inotify_event) + event->len;
+
+			if (event->mask & IN_Q_OVERFLOW) {
+				callback(PLATFORM_WATCH_OVERFLOW, null, data);
+			} else if (event->len > 0 && !(event->mask & IN_ISDIR)) {
+				callback(event->wd, event->name, data);
+			}
+		}
+	}
+}
+
+#endif // PLATFORM_LINUX
@@ -0,0 +1,160 @@
+#include "platform/platform_watch.h"
+
+#include "core/context.h"
+#include "core/log.h"
+
+#ifdef PLATFORM_WINDOWS
+
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+
+#include <string.h>
+
+#define WATCH_FILTER (FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE)
+#define WATCH_BUFFER_SIZE (16 * 1024)
+#define WATCH_NAME_MAX 512
+
+typedef struct Directory_Watch {
+	char path[MAX_PATH];
+	u32 references;
+	HANDLE directory;
+	OVERLAPPED overlapped;
+	// ReadDirectoryChangesW needs DWORD alignment
+	DWORD buffer[WATCH_BUFFER_SIZE / sizeof(DWORD)];
+} Directory_Watch;
+
+// Ids are slots, which stay put while other directories stop being watched
+typedef struct Watch_System {
+	Directory_Watch* watches[PLATFORM_WATCH_MAX];
+} Watch_System;
+
+static Watch_System watch = {0};
+
+static b8 issue_read(Directory_Watch* directory_watch) {
+	memset(&directory_watch->overlapped, 0, sizeof(OVERLAPPED));
+	return ReadDirectoryChangesW(
+		directory_watch->directory,
+		directory_watch->buffer,
+		sizeof(directory_watch->buffer),
+		FALSE,
+		WATCH_FILTER,
+		null,
+		&directory_watch->overlapped,
+		null);
+}
+
+static void close_watch(Directory_Watch* directory_watch) {
+	CancelIo(directory_watch->directory);
+	DWORD transferred;
+	GetOverlappedResult(directory_watch->directory, &directory_watch->overlapped, &transferred, TRUE);
+	CloseHandle(directory_watch->directory);
+	VirtualFree(directory_watch, 0, MEM_RELEASE);
+}
+
+b8 platform_watch_start(void) {
+	memset(watch.watches, 0, sizeof(watch.watches));
+	return true;
+}
+
+void platform_watch_shutdown(void) {
+	for (u32 i = 0; i < PLATFORM_WATCH_MAX; i++) {
+		if (watch.watches[i]) {
+			close_watch(watch.watches[i]);
+			watch.watches[i] = null;
+		}
+	}
+}
+
+i32 platform_watch_directory(const char* directory) {
+	i32 slot = -1;
+	for (u32 i = 0; i < PLATFORM_WATCH_MAX; i++) {
+		if (!watch.watches[i]) {
+			slot = slot < 0 ? (i32)i : slot;
+		} else if (_stricmp(watch.watches[i]->path, directory) == 0) {
+			watch.watches[i]->references++;
+			return (i32)i;
+		}
+	}
+	if (slot < 0) {
+		log_error("Can't watch more than %u directories", PLATFORM_WATCH_MAX);
+		return -1;
+	}
+	if (strlen(directory) >= MAX_PATH) {
+		log_error("Can't watch %s, the path is too long", directory);
+		return -1;
+	}
+
+	HANDLE handle = CreateFileA(
+		directory,
+		FILE_LIST_DIRECTORY,
+		FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		null,
+		OPEN_EXISTING,
+		FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+		null);
+	if (handle == INVALID_HANDLE_VALUE) {
+		log_error("Failed to open %s for watching: %lu", directory, GetLastError());
+		return -1;
+	}
+
+	Directory_Watch* directory_watch = VirtualAlloc(null, sizeof(Directory_Watch), MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+	strcpy(directory_watch->path, directory);
+	directory_watch->references = 1;
+	directory_watch->directory = handle;
+	if (!issue_read(directory_watch)) {
+		log_error("Failed to watch %s: %lu", directory, GetLastError());
+		CloseHandle(handle);
+		VirtualFree(directory_watch, 0, MEM_RELEASE);
+		return -1;
+	}
+
+	watch.watches[slot] = directory_watch;
+	return slot;
+}
+
+void platform_watch_release(i32 id) {
+	if (id < 0 || id >= PLATFORM_WATCH_MAX || !watch.watches[id] || --watch.watches[id]->references > 0) {
+		return;
+	}
+	close_watch(watch.watches[id]);
+	watch.watches[id] = null;
+}
+
+void platform_watch_poll(Platform_Watch_Callback callback, void* data) {
+	for (u32 i = 0; i < PLATFORM_WATCH_MAX; i++) {
+		Directory_Watch* directory_watch = watch.watches[i];
+		if (!directory_watch) {
+			continue;
+		}
+		DWORD transferred;
+		if (!GetOverlappedResult(directory_watch->directory, &directory_watch->overlapped, &transferred, FALSE)) {
+			// ERROR_IO_INCOMPLETE while nothing changed
+			continue;
+		}
+
+		// Zero bytes means the changes didn't fit in the buffer
+		if (transferred == 0) {
+			callback(PLATFORM_WATCH_OVERFLOW, null, data);
+		}
+		for (u8* c = (u8*)directory_watch->buffer; transferred > 0;) {
+			FILE_NOTIFY_INFORMATION* info = (FILE_NOTIFY_INFORMATION*)c;
+			char name[WATCH_NAME_MAX];
+			i32 length = WideCharToMultiByte(
+				CP_UTF8, 0, info->FileName, (i32)(info->FileNameLength / sizeof(WCHAR)), name, sizeof(name) - 1, null, null);
+			if (length > 0) {
+				name[length] = 0;
+				callback((i32)i, name, data);
+			}
+			if (info->NextEntryOffset == 0) {
+				break;
+			}
+			c += info->NextEntryOffset;
+		}
+
+		if (!issue_read(directory_watch)) {
+			log_error("Stopped watching %s: %lu", directory_watch->path, GetLastError());
+		}
+	}
+}
+
+#endif // PLATFORM_WINDOWS
@@ -1,4 +1,5 @@
 #include "platform/platform.h"
+#include "platform/platform_headless.h"
 
 #include "core/context.h"
 #include "core/log.h"
@@ -53,6 +54,16 @@ static b8 cstring_equals_blen(const char* a, const char* b, size_t blen);
 
 static LRESULT CALLBACK process_message(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam);
 
+// Raw mouse motion from WM_INPUT, accumulated across a pump and delivered once
+typedef struct Raw_Motion {
+	i32 x;
+	i32 y;
+	u64 time;
+	b8 pending;
+} Raw_Motion;
+
+static Raw_Motion raw_motion = {0};
+
 static Platform_Internal* create_internal(void) {
 	Platform_Internal* internal = memory_alloc(sizeof(Platform_Internal), MEMORY_TAG_PLATFORM);
 	internal->class_name = "haunt_window_class";
@@ -139,9 +150,19 @@ static void show_window(Platform_Internal* internal) {
 static void clock_start(Clock* clock);
 
 b8 platform_start(Platform* platform, const char* app_name, i32 x, i32 y, i32 width, i32 height) {
+	if (platform->backend == PLATFORM_BACKEND_HEADLESS) {
+		return platform_headless_start(platform, app_name);
+	}
+	if (platform->backend == PLATFORM_BACKEND_OFFSCREEN) {
+		log_fatal("Offscreen rendering is not supported on Windows");
+		return false;
+	}
+
 	platform->internal = create_internal();
 	Platform_Internal* internal = (Platform_Internal*)platform->internal;
 
+	platform_calibrate_cycles();
+
 	load_wgl_functions();
 
 	// Register window class and create window
@@ -228,6 +249,17 @@ b8 platform_start(Platform* platform, const char* app_name, i32 x, i32 y, i32 wi
 
 	wglSwapIntervalEXT(RENDER_VSYNC_ENABLED);
 
+	// Raw mouse motion, only delivered while the window is in the foreground
+	{
+		RAWINPUTDEVICE device = {0};
+		device.usUsagePage = 0x01; // HID_USAGE_PAGE_GENERIC
+		device.usUsage = 0x02;     // HID_USAGE_GENERIC_MOUSE
+		device.hwndTarget = internal->hwnd;
+		if (!RegisterRawInputDevices(&device, 1, sizeof(device))) {
+			log_warn("Failed to register raw mouse input, raw mouse motion disabled");
+		}
+	}
+
 	show_window(internal);
 
 	clock_start(&internal->clock);
@@ -236,6 +268,11 @@ b8 platform_start(Platform* platform, const char* app_name, i32 x, i32 y, i32 wi
 }
 
 void platform_shutdown(Platform* platform) {
+	if (platform->backend == PLATFORM_BACKEND_HEADLESS) {
+		platform_headless_shutdown(platform);
+		return;
+	}
+
 	Platform_Internal* internal = (Platform_Internal*)platform->internal;
 
 	if (internal->hwnd) {
@@ -249,19 +286,64 @@ void platform_shutdown(Platform* platform) {
 }
 
 b8 platform_pump_messages(Platform* platform) {
+	if (platform->backend == PLATFORM_BACKEND_HEADLESS) {
+		return platform_headless_pump_messages(platform);
+	}
+
 	MSG msg;
 	while (PeekMessageA(&msg, null, 0, 0, PM_REMOVE)) {
 		TranslateMessage(&msg);
 		DispatchMessageA(&msg);
 	}
+
+	// High rate mice send many WM_INPUT messages per frame, so the input system only sees the total
+	if (raw_motion.pending) {
+		if (raw_motion.x | raw_motion.y) {
+			input_process_mouse_delta(raw_motion.x, raw_motion.y, raw_motion.time);
+		}
+		raw_motion = (Raw_Motion){0};
+	}
+
 	return true;
 }
 
+void platform_latch_input(Platform* platform) {
+	// Messages are pumped on the window's thread, so there is nothing newer to latch
+}
+
 b8 platform_swap_buffers(Platform* platform) {
+	if (platform->backend == PLATFORM_BACKEND_HEADLESS) {
+		return true;
+	}
+
 	Platform_Internal* internal = (Platform_Internal*)platform->internal;
 	return SwapBuffers(internal->device_context);
 }
 
+Platform_Window_State platform_get_window_state(Platform* platform) {
+	if (platform->backend == PLATFORM_BACKEND_HEADLESS) {
+		return (Platform_Window_State){ true, true, false };
+	}
+
+	Platform_Internal* internal = (Platform_Internal*)platform->internal;
+	Platform_Window_State state;
+	state.focused = GetForegroundWindow() == internal->hwnd;
+	state.minimized = IsIconic(internal->hwnd) != 0;
+	state.visible = IsWindowVisible(internal->hwnd) && !state.minimized;
+	return state;
+}
+
+b8 platform_wait_for_events(Platform* platform, u64 timeout_ms) {
+	if (platform->backend == PLATFORM_BACKEND_HEADLESS) {
+		platform_sleep(timeout_ms);
+		return false;
+	}
+
+	// MWMO_INPUTAVAILABLE also wakes for messages that were already queued but not yet pumped
+	DWORD timeout = timeout_ms >= INFINITE ? INFINITE - 1 : (DWORD)timeout_ms;
+	return MsgWaitForMultipleObjectsEx(0, null, timeout, QS_ALLINPUT, MWMO_INPUTAVAILABLE) != WAIT_TIMEOUT;
+}
+
 void* platform_memory_alloc(u64 size, b8 aligned) {
 	return VirtualAlloc(null, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
 }
@@ -309,6 +391,10 @@ static void clock_start(Clock* clock) {
 }
 
 f64 platform_get_time(Platform* platform) {
+	if (platform->backend == PLATFORM_BACKEND_HEADLESS) {
+		return (f64)platform_get_time_ns() / 1000000000.0;
+	}
+
 	Platform_Internal* internal = (Platform_Internal*)platform->internal;
 
 	LARGE_INTEGER current;
@@ -316,10 +402,54 @@ f64 platform_get_time(Platform* platform) {
 	return (f64)current.QuadPart * internal->clock.frequency;
 }
 
+u64 platform_get_time_ns(void) {
+	static LARGE_INTEGER frequency = {0};
+	if (!frequency.QuadPart) {
+		QueryPerformanceFrequency(&frequency);
+	}
+
+	LARGE_INTEGER current;
+	QueryPerformanceCounter(&current);
+	// Split to avoid overflowing the multiply
+	u64 seconds = current.QuadPart / frequency.QuadPart;
+	u64 remainder = current.QuadPart % frequency.QuadPart;
+	return seconds * 1000000000ull + remainder * 1000000000ull / frequency.QuadPart;
+}
+
 void platform_sleep(u64 ms) {
 	Sleep(ms);
 }
 
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#	define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+void platform_sleep_until_ns(u64 deadline_ns, u64 spin_ns) {
+	// Sleep has a 15.6 ms granularity by default, the high resolution timer does not need timeBeginPeriod
+	static HANDLE timer = null;
+	if (!timer) {
+		timer = CreateWaitableTimerExW(null, null, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+	}
+
+	u64 now = platform_get_time_ns();
+	if (deadline_ns > now + spin_ns) {
+		u64 duration = deadline_ns - spin_ns - now;
+		if (timer) {
+			// Negative due times are relative, in 100 ns units
+			LARGE_INTEGER due;
+			due.QuadPart = -(i64)(duration / 100);
+			SetWaitableTimer(timer, &due, 0, null, null, FALSE);
+			WaitForSingleObject(timer, INFINITE);
+		} else {
+			Sleep((DWORD)(duration / 1000000));
+		}
+	}
+
+	while (platform_get_time_ns() < deadline_ns) {
+		YieldProcessor();
+	}
+}
+
 /**
  * Checks if the two cstrings are equal, while sizing by cstring b's length
  */
@@ -417,6 +547,15 @@ static void load_wgl_functions(void) {
 	DestroyWindow(dummy);
 }
 
+// Converts the current message's GetTickCount based time to the platform_get_time_ns time base
+static u64 message_time_ns(void) {
+	u64 now = platform_get_time_ns();
+	// Unsigned subtraction handles the 32 bit tick count wrapping
+	u32 age = (u32)GetTickCount() - (u32)GetMessageTime();
+	u64 age_ns = (u64)age * 1000000ull;
+	return age_ns < now ? now - age_ns : now;
+}
+
 static LRESULT CALLBACK process_message(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam) {
 	switch (msg) {
 		case WM_ERASEBKGND:
@@ -442,19 +581,30 @@ static LRESULT CALLBACK process_message(HWND hwnd, UINT msg, WPARAM wparam, LPAR
 			b8 pressed = msg == WM_KEYDOWN || msg == WM_SYSKEYDOWN;
 			WORD vkcode = LOWORD(wparam);
 			Key key = (Key)vkcode;
-			input_process_key(key, pressed);
+			input_process_key(key, pressed, message_time_ns());
 		} break;
 		case WM_MOUSEMOVE: {
 			i32 x = GET_X_LPARAM(lparam);
 			i32 y = GET_Y_LPARAM(lparam);
-			input_process_mouse_position(x, y);
+			input_process_mouse_position(x, y, message_time_ns());
+		} break;
+		case WM_INPUT: {
+			RAWINPUT raw;
+			UINT size = sizeof(raw);
+			UINT read = GetRawInputData((HRAWINPUT)lparam, RID_INPUT, &raw, &size, sizeof(RAWINPUTHEADER));
+			if (read != (UINT)-1 && raw.header.dwType == RIM_TYPEMOUSE && !(raw.data.mouse.usFlags & MOUSE_MOVE_ABSOLUTE)) {
+				raw_motion.x += raw.data.mouse.lLastX;
+				raw_motion.y += raw.data.mouse.lLastY;
+				raw_motion.time = message_time_ns();
+				raw_motion.pending = true;
+			}
 		} break;
 		case WM_MOUSEWHEEL: {
 			i32 delta = GET_WHEEL_DELTA_WPARAM(wparam);
 			if (delta != 0) {
 				// Flatten delta for OS-independent handling
 				delta = delta > 0 ? 1 : -1;
-				input_process_mouse_wheel(delta);
+				input_process_mouse_wheel(delta, message_time_ns());
 			}
 		} break;
 		case WM_LBUTTONDOWN:
@@ -464,12 +614,13 @@ static LRESULT CALLBACK process_message(HWND hwnd, UINT msg, WPARAM wparam, LPAR
 		case WM_MBUTTONUP:
 		case WM_RBUTTONUP: {
 			b8 pressed = msg == WM_LBUTTONDOWN || msg == WM_MBUTTONDOWN || msg == WM_RBUTTONDOWN;
+			u64 time = message_time_ns();
 			if (msg == WM_LBUTTONDOWN || msg == WM_LBUTTONUP) {
-				input_process_mouse_button(MOUSE_BUTTON_LEFT, pressed);
+				input_process_mouse_button(MOUSE_BUTTON_LEFT, pressed, time);
 			} else if (msg == WM_MBUTTONDOWN || msg == WM_MBUTTONUP) {
-				input_process_mouse_button(MOUSE_BUTTON_MIDDLE, pressed);
+				input_process_mouse_button(MOUSE_BUTTON_MIDDLE, pressed, time);
 			} else if (msg == WM_RBUTTONDOWN || msg == WM_RBUTTONUP) {
-				input_process_mouse_button(MOUSE_BUTTON_RIGHT, pressed);
+				input_process_mouse_button(MOUSE_BUTTON_RIGHT, pressed, time);
 			}
 		} break;
 	}
@@ -481,4 +632,8 @@ b8 platform_is_debugging(void) {
 	return IsDebuggerPresent();
 }
 
+u32 platform_get_processor_count(void) {
+	return GetActiveProcessorCount(ALL_PROCESSOR_GROUPS);
+}
+
 #endif // PLATFORM_WINDOWS
@@ -1,6 +1,6 @@
 #!/bin/bash
 
-# Build the engine and editor
+# Build the engine, editor and benchmarks
 
 echo "Building all..."
 
@@ -16,4 +16,16 @@ if [ $? -ne 0 ]; then
 	exit 1
 fi
 
+# Build the editor app module
+./scripts/linux/build-editor-app.sh
+if [ $? -ne 0 ]; then
+	exit 1
+fi
+
+# Build the benchmarks
+./scripts/linux/build-bench.sh
+if [ $? -ne 0 ]; then
+	exit 1
+fi
+
 echo "Done building all" 
@@ -0,0 +1,23 @@
+#!/bin/bash
+
+# Build the benchmarks
+
+# Build each benchmark source into its own executable
+for source in $(find bench/src -name "bench_*.c"); do
+	name=$(basename $source .c)
+	assembly="haunt-${name//_/-}"
+	cflags="-g -O2 -Wall -Werror -Wno-gnu-folding-constant -Wno-unused-function -std=c17"
+	includes="-Ibench/src -Iengine/src -Iengine/deps -Iengine/deps/glad/include"
+	linker="-Lbin -lhaunt -lX11 -lX11-xcb -lxcb -lm -Wl,-rpath,\$ORIGIN"
+	defines="-D_DEBUG -DDLL_IMPORT -DGLAD_GLAPI_EXPORT -D_GNU_SOURCE"
+
+	echo "Building $assembly..."
+	clang $source $cflags -o bin/$assembly $defines $includes $linker
+
+	if [ $? -ne 0 ]; then
+		echo "Failed to build $assembly"
+		exit 1
+	fi
+
+	echo "Done building $assembly"
+done
@@ -0,0 +1,24 @@
+#!/bin/bash
+
+# Build the editor as an app module, run with: bin/editor --app-module bin/libeditor-app.so
+# Rebuilding it while the editor runs reloads it in place
+
+# Find source files
+sources=$(find editor/src -name "*.c")
+
+# Build the module
+module="libeditor-app"
+cflags="-g -Wall -Werror -Wno-gnu-folding-constant -Wno-unused-function -std=c17 -shared -fPIC"
+includes="-Ieditor/src -Iengine/src"
+linker="-Lbin -lhaunt -lm"
+defines="-D_DEBUG -DDLL_IMPORT -DAPP_MODULE"
+
+echo "Building $module..."
+clang $sources $cflags -o bin/$module.so $defines $includes $linker
+
+if [ $? -ne 0 ]; then
+	echo "Failed to build $module"
+	exit 1
+fi
+
+echo "Done building $module"
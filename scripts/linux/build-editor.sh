@@ -20,4 +20,4 @@ if [ $? -ne 0 ]; then
 	exit 1
 fi
 
-echo "Done building $assembly" 
+echo "Done building $assembly"
@@ -10,8 +10,8 @@ sources="$sources engine/deps/glad/src/glad.c"
 assembly="haunt"
 cflags="-g -shared -fPIC -Wall -Werror -Wno-gnu-folding-constant -Wno-unused-function -std=c17"
 includes="-Iengine/src -Iengine/deps -Iengine/deps/glad/include"
-linker="-lX11 -lGL -lm -lGLX"
-defines="-D_DEBUG -DDLL_EXPORT -DPLATFORM_LINUX"
+linker="-lX11 -lX11-xcb -lxcb -lXi -lGL -lEGL -lm -lGLX -lpthread -ldl"
+defines="-D_DEBUG -DDLL_EXPORT -DGLAD_GLAPI_EXPORT -DGLAD_GLAPI_EXPORT_BUILD -DPLATFORM_LINUX -D_GNU_SOURCE"
 
 echo "Building $assembly..."
 clang $sources $cflags -o bin/lib$assembly.so $defines $includes $linker
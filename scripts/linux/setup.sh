@@ -24,6 +24,27 @@ if ! pkg-config --exists x11; then
 fi
 echo "X11 development files found"
 
+# XInput2 development files
+if ! pkg-config --exists xi; then
+	echo "XInput2 development files not found. Please install them (e.g., libxi-dev on Ubuntu)"
+	exit 1
+fi
+echo "XInput2 development files found"
+
+# X11 XCB development files
+if ! pkg-config --exists x11-xcb; then
+	echo "X11 XCB development files not found. Please install them (e.g., libx11-xcb-dev on Ubuntu)"
+	exit 1
+fi
+echo "X11 XCB development files found"
+
+# EGL development files
+if ! pkg-config --exists egl; then
+	echo "EGL development files not found. Please install them (e.g., libegl-dev on Ubuntu)"
+	exit 1
+fi
+echo "EGL development files found"
+
 # Set up submodules
 echo "Setting up submodules..."
 git submodule update --init --recursive
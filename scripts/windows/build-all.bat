@@ -1,7 +1,7 @@
 @echo off
 
 ::
-:: Build the engine and editor
+:: Build the engine, editor and benchmarks
 ::
 
 setlocal EnableDelayedExpansion
@@ -22,6 +22,18 @@ if %errorlevel% neq 0 (
 	goto exit_error
 )
 
+:: Build the editor app module
+call scripts\windows\build-editor-app.bat
+if %errorlevel% neq 0 (
+	goto exit_error
+)
+
+:: Build the benchmarks
+call scripts\windows\build-bench.bat
+if %errorlevel% neq 0 (
+	goto exit_error
+)
+
 :: Done building
 echo !COMPILE_SUCCESS! Done building all !LOG_END!
 
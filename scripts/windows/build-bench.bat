@@ -0,0 +1,41 @@
+@echo off
+
+::
+:: Build the benchmarks
+::
+
+setlocal EnableDelayedExpansion
+
+call scripts\windows\internal\log.bat
+
+:: Build each benchmark source into its own executable
+pushd bench
+set sources=
+for /r %%f in (bench_*.c) do (
+	set sources=!sources! %%f
+)
+popd
+
+set cflags=-g -O2 -Wall -Werror -Wno-unused-function -std=c17
+set includes=-Ibench/src -Iengine/src -Iengine/deps -Iengine/deps/glad/include
+set linker=-Lbin -lhaunt.lib -luser32
+set defines=-D_DEBUG -DDLL_IMPORT -DGLAD_GLAPI_EXPORT
+for %%f in (%sources%) do (
+	set name=%%~nf
+	set assembly=haunt-!name:_=-!
+	echo !COMPILE_INFO! Building !assembly!... !LOG_END!
+	call clang %%f %cflags% -o bin/!assembly!.exe %defines% %includes% %linker%
+	if !errorlevel! neq 0 (
+		echo !COMPILE_ERROR! Failed to build !assembly! !LOG_END!
+		goto exit_error
+	)
+	echo !COMPILE_SUCCESS! Done building !assembly! !LOG_END!
+)
+
+:exit
+endlocal
+exit /b 0
+
+:exit_error
+endlocal
+exit /b 1
@@ -0,0 +1,43 @@
+@echo off
+
+::
+:: Build the editor as an app module, run with: bin\editor.exe --app-module bin\editor-app.dll
+:: Rebuilding it while the editor runs reloads it in place
+::
+
+setlocal EnableDelayedExpansion
+
+call scripts\windows\internal\log.bat
+
+:: Find all source files
+pushd editor
+set sources=
+for /r %%f in (*.c) do (
+	set sources=!sources! %%f
+)
+popd
+echo !COMPILE_INFO! Files: %sources% !LOG_END!
+
+:: Build the module
+set module=editor-app
+set cflags=-g -Wall -Werror -Wno-unused-function -std=c17 -shared
+set includes=-Ieditor/src -Iengine/src
+set linker=-Lbin -lhaunt.lib
+set defines=-D_DEBUG -DDLL_IMPORT -DAPP_MODULE
+echo !COMPILE_INFO! Building %module%... !LOG_END!
+call clang %sources% %cflags% -o bin/%module%.dll %defines% %includes% %linker%
+if %errorlevel% neq 0 (
+	echo !COMPILE_ERROR! Failed to build %module% !LOG_END!
+	goto exit_error
+)
+
+:: Done building
+echo !COMPILE_SUCCESS! Done building %module% !LOG_END!
+
+:exit
+endlocal
+exit /b 0
+
+:exit_error
+endlocal
+exit /b 1
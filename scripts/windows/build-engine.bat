@@ -21,8 +21,8 @@ echo !COMPILE_INFO! Files: %sources% !LOG_END!
 set assembly=haunt
 set cflags=-g -shared -Wvarargs -Wall -Werror -Wno-unused-function -std=c17
 set includes=-Iengine/src -Iengine/deps -Iengine/deps/glad/include
-set linker=-luser32 -lgdi32 -lopengl32
-set defines=-D_DEBUG -D_CRT_SECURE_NO_WARNINGS -DDLL_EXPORT
+set linker=-luser32 -lgdi32 -lopengl32 -lsynchronization
+set defines=-D_DEBUG -D_CRT_SECURE_NO_WARNINGS -DDLL_EXPORT -DGLAD_GLAPI_EXPORT -DGLAD_GLAPI_EXPORT_BUILD
 echo !COMPILE_INFO! Building %assembly%... !LOG_END!
 call clang %sources% %cflags% -o bin/%assembly%.dll %defines% %includes% %linker%
 if %errorlevel% neq 0 (